@@ -0,0 +1,57 @@
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "Utils/FrustumCulling.h"
+
+namespace {
+    // Boxes spread around the camera so roughly a quarter of them survive, like walking through Bistro
+    vov::AABBSoA MakeBoxes(size_t count) {
+        std::mt19937 random{1337};
+        std::uniform_real_distribution<float> position{-500.f, 500.f};
+        std::uniform_real_distribution<float> extent{0.1f, 5.f};
+
+        vov::AABBSoA boxes{};
+        boxes.Reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            const glm::vec3 center{position(random), position(random) * 0.1f, position(random)};
+            const glm::vec3 halfSize{extent(random), extent(random), extent(random)};
+            boxes.Add({center - halfSize, center + halfSize});
+        }
+        return boxes;
+    }
+
+    vov::Camera::Frustum MakeFrustum() {
+        const glm::mat4 view = glm::lookAt(glm::vec3{0.f, 2.f, 0.f}, glm::vec3{0.f, 2.f, 1.f}, glm::vec3{0.f, 1.f, 0.f});
+        const glm::mat4 proj = glm::perspectiveRH_ZO(glm::radians(90.f), 16.f / 9.f, 0.1f, 1000.f);
+
+        vov::Camera::Frustum frustum{};
+        frustum.update(proj * view);
+        return frustum;
+    }
+
+    template <auto Cull>
+    void BM_FrustumCull(benchmark::State& state) {
+        const auto boxes = MakeBoxes(static_cast<size_t>(state.range(0)));
+        const auto frustum = MakeFrustum();
+
+        std::vector<uint32_t> visible{};
+        visible.reserve(boxes.Size());
+        for (auto _ : state) {
+            visible.clear();
+            Cull(frustum, boxes, 0, boxes.Size(), visible);
+            benchmark::DoNotOptimize(visible.data());
+            benchmark::ClobberMemory();
+        }
+
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+        state.counters["visible"] = static_cast<double>(visible.size());
+    }
+
+    constexpr auto SIMD = static_cast<size_t(*)(const vov::Camera::Frustum&, const vov::AABBSoA&, size_t, size_t, std::vector<uint32_t>&)>(&vov::FrustumCullIndices);
+}
+
+BENCHMARK(BM_FrustumCull<SIMD>)->Name("FrustumCullIndices")->Arg(10'000)->Arg(100'000)->Arg(1'000'000);
+BENCHMARK(BM_FrustumCull<&vov::FrustumCullIndicesScalar>)->Name("FrustumCullIndicesScalar")->Arg(10'000)->Arg(100'000)->Arg(1'000'000);
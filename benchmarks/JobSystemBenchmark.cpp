@@ -0,0 +1,54 @@
+#include <benchmark/benchmark.h>
+
+#include "Core/JobSystem.h"
+
+namespace {
+    // Same measurements as JobSystem::Benchmark, per empty job
+
+    void BM_JobSchedule(benchmark::State& state) {
+        auto& jobSystem = vov::JobSystem::GetInstance();
+        const auto jobCount = static_cast<uint32_t>(state.range(0));
+
+        vov::JobCounter counter{};
+        for (auto _ : state) {
+            for (uint32_t i = 0; i < jobCount; ++i) {
+                jobSystem.Schedule("Benchmark", [] {}, &counter);
+            }
+
+            // Only the pushes are timed, the queues have to be empty again for the next round
+            state.PauseTiming();
+            jobSystem.Wait(counter);
+            state.ResumeTiming();
+        }
+        state.SetItemsProcessed(state.iterations() * jobCount);
+    }
+
+    void BM_JobRoundTrip(benchmark::State& state) {
+        auto& jobSystem = vov::JobSystem::GetInstance();
+        const auto jobCount = static_cast<uint32_t>(state.range(0));
+
+        vov::JobCounter counter{};
+        for (auto _ : state) {
+            for (uint32_t i = 0; i < jobCount; ++i) {
+                jobSystem.Schedule("Benchmark", [] {}, &counter);
+            }
+            jobSystem.Wait(counter);
+        }
+        state.SetItemsProcessed(state.iterations() * jobCount);
+    }
+
+    void BM_ParallelForBatch(benchmark::State& state) {
+        auto& jobSystem = vov::JobSystem::GetInstance();
+        // As wide as a ParallelFor gets
+        const uint32_t batches = jobSystem.GetWorkerCount() * 4;
+
+        for (auto _ : state) {
+            jobSystem.ParallelFor("Benchmark", batches, 1, [] (size_t, size_t) {});
+        }
+        state.SetItemsProcessed(state.iterations() * batches);
+    }
+}
+
+BENCHMARK(BM_JobSchedule)->Arg(1'000)->Arg(100'000)->UseRealTime();
+BENCHMARK(BM_JobRoundTrip)->Arg(1'000)->Arg(100'000)->UseRealTime();
+BENCHMARK(BM_ParallelForBatch)->UseRealTime();
@@ -0,0 +1,20 @@
+include(FetchContent)
+
+macro(LinkBenchmark TARGET ACCESS)
+    set(BENCHMARK_ENABLE_TESTING OFF CACHE BOOL "" FORCE)
+    set(BENCHMARK_ENABLE_INSTALL OFF CACHE BOOL "" FORCE)
+
+    FetchContent_Declare(
+            benchmark
+            GIT_REPOSITORY https://github.com/google/benchmark
+            GIT_TAG v1.9.1
+    )
+
+    FetchContent_GetProperties(benchmark)
+
+    if (NOT benchmark_POPULATED)
+        FetchContent_MakeAvailable(benchmark)
+    endif()
+
+    target_link_libraries(${TARGET} ${ACCESS} benchmark::benchmark benchmark::benchmark_main)
+endmacro()
@@ -13,6 +13,7 @@ struct CameraSettings {
 layout(std140, set = 0, binding = 0) uniform globalUBO
 {
     CameraSettings camSettings;
+    uint hasLines;
 } ubo;
 
 layout(set = 0, binding = 1) uniform sampler2D image;
@@ -63,12 +64,14 @@ void main()
     hdrColor *= exposure;
     hdrColor = Uncharted2ToneMapping(hdrColor);
 
-    vec4 lineSample = texture(line, fragTexCoord);
-
     outColor = vec4(hdrColor, 1.0);
 
-    //TODO: use mix
-    if(lineSample.rgb != vec3(0,0,0)){
-        outColor = lineSample;
+    if (ubo.hasLines != 0) {
+        vec4 lineSample = texture(line, fragTexCoord);
+
+        //TODO: use mix
+        if(lineSample.rgb != vec3(0,0,0)){
+            outColor = lineSample;
+        }
     }
 }
\ No newline at end of file
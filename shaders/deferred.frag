@@ -1,7 +1,9 @@
 #version 450
 #extension GL_GOOGLE_include_directive : enable
+#extension GL_EXT_nonuniform_qualifier : enable
 
 #include "lighting.glsl"
+#include "GBuffer.glsl"
 
 layout(set = 0, binding = 0) uniform MatrixUBO
 {
@@ -9,39 +11,50 @@ layout(set = 0, binding = 0) uniform MatrixUBO
     mat4 proj;
 } ubo;
 
-layout(push_constant) uniform constants
+// Mesh::MaterialFlags, every material variant gets its own pipeline, see GeometryPass.
+// The pipeline only compiles in what it may sample, the material decides if it actually does
+layout(constant_id = 0) const bool HAS_ALBEDO = true;
+layout(constant_id = 1) const bool HAS_NORMAL = false;
+layout(constant_id = 2) const bool HAS_SPECULAR = false;
+layout(constant_id = 3) const bool HAS_BUMP = false;
+
+const uint MATERIAL_HAS_ALBEDO = 1u << 0;
+const uint MATERIAL_HAS_NORMAL = 1u << 1;
+const uint MATERIAL_HAS_SPECULAR = 1u << 2;
+const uint MATERIAL_HAS_BUMP = 1u << 3;
+
+// MaterialTable::GpuMaterial
+struct Material {
+    uint albedoTexture;
+    uint normalTexture;
+    uint specularTexture;
+    uint bumpTexture;
+    uint flags;
+    uint pad0;
+    uint pad1;
+    uint pad2;
+};
+
+layout(std430, set = 1, binding = 0) readonly buffer Materials
 {
-    mat4 model;
-    int objectId;
+    Material materials[];
+};
+layout(set = 1, binding = 1) uniform sampler2D textures[];
 
-} modelData;
-
-
-layout(std140, set = 1, binding = 0) uniform bindingInfo{
-    bool hasAlbedo;
-    bool hasNormal;
-    bool hasSpecular;
-    bool hasBump;
-} textureBindingInfo;
-
-layout(set = 1, binding = 1) uniform sampler2D albedoSampler;
-layout(set = 1, binding = 2) uniform sampler2D normalSampler;
-layout(set = 1, binding = 3) uniform sampler2D metallicRoughnessSampler;
-layout(set = 1, binding = 4) uniform sampler2D bumpSampler;
-
-layout(location = 0) in vec3 inWorldPos;
 layout(location = 1) in vec3 inColor;
 layout(location = 2) in vec2 inTexCoord;
 layout(location = 3) in vec3 inNormal;
 layout(location = 4) in vec3 inTangent;
 layout(location = 5) in vec3 inBitTangent;
+layout(location = 6) flat in int inObjectId;
+layout(location = 7) flat in uint inMaterialIndex;
 
 
 layout(location = 0) out vec4 outAlbedo;
-layout(location = 1) out vec4 outNormal;
-layout(location = 2) out vec4 outWorldPos;
-layout(location = 3) out vec4 outMetallicRoughness;
-layout(location = 4) out vec4 outSelection;
+layout(location = 1) out vec2 outNormal;
+layout(location = 2) out vec2 outMetallicRoughness;
+// Mesh::GetSceneIndex + 1, only stored while selection is enabled, see GeometryPass::SetSelectionEnabled
+layout(location = 3) out uint outSelection;
 
 const bool USE_BUMP_MAP = false;
 
@@ -58,21 +71,12 @@ vec3 boolsToColor(bool hasNormal, bool hasSpecular, bool hasBump) {
     return vec3(r, g, b);
 }
 
-vec3 hashToColor(float n) {
-    // Large prime-based hashing for each channel
-    float r = fract(sin(n * 12.9898) * 43758.5453);
-    float g = fract(sin(n * 78.233) * 12345.6789);
-    float b = fract(sin(n * 37.719) * 98765.4321);
-
-    // Optionally boost contrast for visibility
-    return vec3(r, g, b);
-}
-
 void main(){
+    Material material = materials[inMaterialIndex];
 
-    if(textureBindingInfo.hasAlbedo) {
-//        outAlbedo.rgb = pow(texture(albedoSampler, inTexCoord).rgb, vec3(2.2)); // Assume sRGB
-        outAlbedo.rgb = texture(albedoSampler, inTexCoord).rgb; // Assume sRGB
+    if(HAS_ALBEDO && (material.flags & MATERIAL_HAS_ALBEDO) != 0) {
+//        outAlbedo.rgb = pow(texture(textures[nonuniformEXT(material.albedoTexture)], inTexCoord).rgb, vec3(2.2)); // Assume sRGB
+        outAlbedo.rgb = texture(textures[nonuniformEXT(material.albedoTexture)], inTexCoord).rgb; // Assume sRGB
 
         if(outAlbedo.a < 0.1) {
             discard;
@@ -86,51 +90,48 @@ void main(){
     vec3 tangent = normalize(inTangent);
     vec3 bitTangent = normalize(inBitTangent);
 
-    if (USE_BUMP_MAP && textureBindingInfo.hasBump) {
+    if (USE_BUMP_MAP && HAS_BUMP && (material.flags & MATERIAL_HAS_BUMP) != 0) {
         // Bump mapping code
         mat3 tbn = mat3(tangent, bitTangent, normal);
         vec2 texCoord = clamp(inTexCoord, vec2(0.001), vec2(0.999));
-        float height = texture(bumpSampler, texCoord).r;
+        uint bump = material.bumpTexture;
+        float height = texture(textures[nonuniformEXT(bump)], texCoord).r;
 
-        vec2 texelSize = vec2(1.0) / textureSize(bumpSampler, 0);
-        float h1 = texture(bumpSampler, texCoord + vec2(texelSize.x, 0.0)).r;
-        float h2 = texture(bumpSampler, texCoord - vec2(texelSize.x, 0.0)).r;
-        float h3 = texture(bumpSampler, texCoord + vec2(0.0, texelSize.y)).r;
-        float h4 = texture(bumpSampler, texCoord - vec2(0.0, texelSize.y)).r;
+        vec2 texelSize = vec2(1.0) / textureSize(textures[nonuniformEXT(bump)], 0);
+        float h1 = texture(textures[nonuniformEXT(bump)], texCoord + vec2(texelSize.x, 0.0)).r;
+        float h2 = texture(textures[nonuniformEXT(bump)], texCoord - vec2(texelSize.x, 0.0)).r;
+        float h3 = texture(textures[nonuniformEXT(bump)], texCoord + vec2(0.0, texelSize.y)).r;
+        float h4 = texture(textures[nonuniformEXT(bump)], texCoord - vec2(0.0, texelSize.y)).r;
 
         float deltaX = (h1 - h2) * 0.5;
         float deltaY = (h3 - h4) * 0.5;
 
         vec3 bumpNormal = normalize(tbn * vec3(-deltaX, -deltaY, 1.0));
         normal = bumpNormal;
-    } else if (!USE_BUMP_MAP && textureBindingInfo.hasNormal) {
+    } else if (!USE_BUMP_MAP && HAS_NORMAL && (material.flags & MATERIAL_HAS_NORMAL) != 0) {
         // Normal mapping code
         vec3 testBitangent = cross(normal, tangent);
         mat3 tbn = mat3(tangent, testBitangent, normal);
-        vec3 sampledNormal = texture(normalSampler, inTexCoord).rgb;
+        vec3 sampledNormal = texture(textures[nonuniformEXT(material.normalTexture)], inTexCoord).rgb;
         sampledNormal = sampledNormal * 2.0 - 1.0;
         normal = normalize(tbn * sampledNormal);
     }
 
-    outNormal = vec4(clamp(normal * 0.5 + 0.5, vec3(0.0), vec3(1.0)), 1.0);
+    outNormal = EncodeNormal(normal);
 
-    outMetallicRoughness = vec4(0.0, 0.5, 1.0, 1.0);
-    if(textureBindingInfo.hasSpecular) {
-        vec3 mr = texture(metallicRoughnessSampler, inTexCoord).rgb;
-        outMetallicRoughness.b = mr.b;  // Metallic in blue channel (common)
+    // Metallic in r, roughness in g
+    outMetallicRoughness = vec2(1.0, 0.5);
+    if(HAS_SPECULAR && (material.flags & MATERIAL_HAS_SPECULAR) != 0) {
+        vec3 mr = texture(textures[nonuniformEXT(material.specularTexture)], inTexCoord).rgb;
+        outMetallicRoughness.r = mr.b;  // Metallic in blue channel (common)
         outMetallicRoughness.g = mr.g;  // Roughness in green channel
     }
 
-//    if(textureBindingInfo.hasAO) {
+//    if(HAS_AO) {
 //        outMetallicRoughnessAO.b = texture(aoSampler, inTexCoord).r;
 //    }
 
-    outWorldPos.rgb = inWorldPos.xyz;
-
-    outSelection.rgb = hashToColor(float(modelData.objectId));
-//    outSelection.r = float(modelData.objectId & 0xFF) / 255.0f;
-//    outSelection.g = float((modelData.objectId >> 8) & 0xFF) / 255.0f;
-//    outSelection.b = float((modelData.objectId >> 16) & 0xFF) / 255.0f;
+    outSelection = uint(inObjectId) + 1u;
 
-//    outNormal = vec4(boolsToColor(textureBindingInfo.hasNormal, textureBindingInfo.hasSpecular, textureBindingInfo.hasBump), 1.0f);
+//    outNormal = vec4(boolsToColor(HAS_NORMAL, HAS_SPECULAR, HAS_BUMP), 1.0f);
 }
\ No newline at end of file
@@ -6,10 +6,17 @@ layout(set = 0, binding = 0) uniform MatrixUBO
     mat4 proj;
 } ubo;
 
-layout(push_constant) uniform constants
+// MaterialTable index per mesh, indexed by firstInstance like the transforms
+layout(std430, set = 0, binding = 1) readonly buffer MaterialIndices
 {
-    mat4 model;
-} modelData;
+    uint materialIndices[];
+};
+
+// Indexed by firstInstance, see TransformBuffer
+layout(std430, set = 2, binding = 0) readonly buffer TransformBuffer
+{
+    mat4 worldMatrices[];
+};
 
 layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inColor;
@@ -18,20 +25,23 @@ layout(location = 3) in vec3 normal;
 layout(location = 4) in vec3 tangent;
 layout(location = 5) in vec3 bitTangent;
 
-layout(location = 0) out vec3 outPosition;
 layout(location = 1) out vec3 outColor;
 layout(location = 2) out vec2 outTexcoord;
 layout(location = 3) out vec3 outNormal;
 layout(location = 4) out vec3 outTangent;
 layout(location = 5) out vec3 outBitTangent;
+layout(location = 6) flat out int outObjectId;
+layout(location = 7) flat out uint outMaterialIndex;
 
 void main()
 {
-    gl_Position = ubo.proj * ubo.view * modelData.model * vec4(inPosition, 1.0);
+    mat4 model = worldMatrices[gl_InstanceIndex];
+    gl_Position = ubo.proj * ubo.view * model * vec4(inPosition, 1.0);
     outColor = inColor;
-    outNormal = normalize(mat3(modelData.model) * normal);
-    outTangent = normalize(mat3(modelData.model) * tangent);
-    outBitTangent = normalize(mat3(modelData.model) * bitTangent);
+    outNormal = normalize(mat3(model) * normal);
+    outTangent = normalize(mat3(model) * tangent);
+    outBitTangent = normalize(mat3(model) * bitTangent);
     outTexcoord = texCoord;
-    outPosition = (modelData.model * vec4(inPosition, 1.0)).rgb;
+    outObjectId = gl_InstanceIndex;
+    outMaterialIndex = materialIndices[gl_InstanceIndex];
 }
\ No newline at end of file
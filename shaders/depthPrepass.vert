@@ -6,11 +6,11 @@ layout(set = 0, binding = 0) uniform MatrixUBO
     mat4 proj;
 } ubo;
 
-layout(push_constant) uniform constants
+// Indexed by firstInstance, see TransformBuffer
+layout(std430, set = 1, binding = 0) readonly buffer TransformBuffer
 {
-    mat4 model;
-} modelData;
-
+    mat4 worldMatrices[];
+};
 
 layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inColor;
@@ -21,5 +21,6 @@ layout(location = 5) in vec3 bitTangent;
 
 void main()
 {
-    gl_Position = ubo.proj * ubo.view * modelData.model * vec4(inPosition, 1.0);
+    mat4 model = worldMatrices[gl_InstanceIndex];
+    gl_Position = ubo.proj * ubo.view * model * vec4(inPosition, 1.0);
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #version 450
 #extension GL_GOOGLE_include_directive : enable
 #include "lighting.glsl"
+#include "GBuffer.glsl"
 #include "DebugModes.glsl"
 
 struct DirectionalLightInfo {
@@ -29,6 +30,7 @@ layout(std140, set = 0, binding = 0) uniform globalUBO
 {
     mat4 projectionMatrix;
     mat4 viewMatrix;
+    mat4 inverseViewProjection;
     CameraSettings camSettings;
     DirectionalLightInfo light;
     ivec4 pointLightCount;
@@ -41,7 +43,6 @@ layout(std140, set = 0, binding = 0) uniform globalUBO
 layout(set = 1, binding = 0) uniform sampler2D albedoMap;
 layout(set = 1, binding = 1) uniform sampler2D normalMap;
 layout(set = 1, binding = 2) uniform sampler2D metallicRoughnessMap;
-layout(set = 1, binding = 3) uniform sampler2D worldPosMap;
 layout(set = 1, binding = 4) uniform sampler2D selectionMap;
 
 layout(set = 1, binding = 5) uniform sampler2D depthMap;
@@ -59,11 +60,22 @@ layout(set = 3, binding = 0) readonly buffer PointLights {
     PointLight pointLights[];
 };
 
+// Off for normal rendering, the debug views and their branches get compiled out. See LightingPass::Record
+layout(constant_id = 0) const bool DEBUG_VIEWS = true;
+
 layout(location = 0) in vec2 inTexcoord;
 
 layout(location = 0) out vec4 outColor;
 
-float calculateShadow(vec3 worldPos)
+// No position in the G-buffer, it comes back out of the depth buffer
+vec3 ReconstructWorldPosition(vec2 uv, float depth) {
+    vec2 ndc = uv * 2.0 - 1.0;
+    ndc.y *= -1.0;
+    vec4 worldPos = ubo.inverseViewProjection * vec4(ndc, depth, 1.0);
+    return worldPos.xyz / worldPos.w;
+}
+
+float calculateShadow(vec3 worldPos, vec3 N)
 {
     vec4 lightSpacePosition = ubo.light.shadowViewProj * vec4(worldPos, 1.0);
     lightSpacePosition.xyz /= lightSpacePosition.w;
@@ -77,7 +89,6 @@ float calculateShadow(vec3 worldPos)
     vec3 shadowMapUV = vec3(lightSpacePosition.xy * 0.5 + 0.5, lightSpacePosition.z);
     shadowMapUV.y = 1.0 - shadowMapUV.y;// Flip Y for Vulkan
 
-    vec3 N = normalize(texture(normalMap, inTexcoord).rgb * 2.0 - 1.0);
     vec3 L = normalize(-ubo.light.direction);
     float bias = max(0.005 * (1.0 - dot(N, L)), 0.001);
 
@@ -148,8 +159,9 @@ vec3 calculatePointLightContribution(PointLight light, vec3 worldPos, vec3 N, ve
 
 void main()
 {
+    int debugMode = DEBUG_VIEWS ? ubo.debugMode : DEBUG_MODE_NONE;
 
-    if (ubo.debugMode == DEBUG_MODE_FULLSCREEN_SHADOWS) {
+    if (debugMode == DEBUG_MODE_FULLSCREEN_SHADOWS) {
         float depthValue = texture(shadowMap, inTexcoord).r;
         outColor = vec4(vec3(depthValue), 1.0);// Show as grayscale
         return;
@@ -157,15 +169,14 @@ void main()
 
     //hdri
     vec3 albedo = texture(albedoMap, inTexcoord).rgb;
-    vec3 normal = normalize(texture(normalMap, inTexcoord).rgb * 2.0 - 1.0);
-    vec3 worldPos = texture(worldPosMap, inTexcoord).rgb;
-    vec2 metallicRoughness = texture(metallicRoughnessMap, inTexcoord).bg;
+    vec3 normal = DecodeNormal(texture(normalMap, inTexcoord).rg);
+    vec2 metallicRoughness = texture(metallicRoughnessMap, inTexcoord).rg;
     float metallic = metallicRoughness.x;
     float roughness = metallicRoughness.y;
     float ao = 1.0;
     float depth = texture(depthMap, inTexcoord).r;
 
-    if (depth >= 1.f && ubo.debugMode != DEBUG_MODE_VISUALISE_DEFERRED_LAYERS){
+    if (depth >= 1.f && debugMode != DEBUG_MODE_VISUALISE_DEFERRED_LAYERS){
         vec2 fragCoord = vec2(gl_FragCoord.x, gl_FragCoord.y);
         const vec3 sampleDirection = GetWorldPositionFromDepth(depth, fragCoord, ubo.viewportSize, inverse(ubo.projectionMatrix), inverse(ubo.viewMatrix));
         vec3 normalizedSampleDirection = normalize(sampleDirection);
@@ -175,6 +186,7 @@ void main()
         return;
     }
 
+    vec3 worldPos = ReconstructWorldPosition(inTexcoord, depth);
     vec3 camPos = ubo.camSettings.cameraPos.xyz;
     vec3 N = normal;
     vec3 V = normalize(camPos - worldPos);
@@ -206,7 +218,7 @@ void main()
     float NdotL = max(dot(N, L), 0.0);
     Lo += (kD * albedo / PI + specular) * radiance * NdotL;
 
-    float shadow = calculateShadow(worldPos);
+    float shadow = calculateShadow(worldPos, N);
     Lo *= 1 - shadow;
 
     // Point lights contribution
@@ -226,7 +238,7 @@ void main()
     outColor.a = 1.0;
 
 
-    switch (ubo.debugMode) {
+    switch (debugMode) {
         case DEBUG_MODE_ALBEDO:
         outColor.rgb = albedo;
         break;
@@ -264,7 +276,7 @@ void main()
         break;
     }
 
-    if (ubo.debugMode == DEBUG_MODE_VISUALISE_DEFERRED_LAYERS) {
+    if (debugMode == DEBUG_MODE_VISUALISE_DEFERRED_LAYERS) {
         vec2 fragCoord = gl_FragCoord.xy;
         vec2 viewport = ubo.viewportSize;
 
@@ -279,9 +291,9 @@ void main()
 
         // Sample all required textures at debugUV
         vec3 albedo_q = texture(albedoMap, debugUV).rgb;
-        vec3 normal_q = normalize(texture(normalMap, debugUV).rgb * 2.0 - 1.0);
-        vec3 worldPos_q = texture(worldPosMap, debugUV).rgb;
-        vec2 metallicRoughness_q = texture(metallicRoughnessMap, debugUV).bg;
+        vec3 normal_q = DecodeNormal(texture(normalMap, debugUV).rg);
+        vec3 worldPos_q = ReconstructWorldPosition(debugUV, texture(depthMap, debugUV).r);
+        vec2 metallicRoughness_q = texture(metallicRoughnessMap, debugUV).rg;
         float metallic_q = metallicRoughness_q.x;
         float roughness_q = metallicRoughness_q.y;
 
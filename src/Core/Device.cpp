@@ -1,6 +1,8 @@
 #include "Device.h"
 
 #include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
 #include <set>
 #include <stdexcept>
@@ -11,6 +13,7 @@
 #include "vk_mem_alloc.h"
 // #include <vma/vk_mem_alloc.h>
 
+#include "Resources/MaterialTable.h"
 #include "Utils/DebugLabel.h"
 #include "Utils/ResourceManager.h"
 
@@ -66,14 +69,19 @@ namespace vov {
         PickPhysicalDevice();
         CreateLogicalDevice();
         CreateCommandPool();
+        CreatePipelineCache();
         allocVmaAllocator();
     }
 
     Device::~Device() {
         //TODO: ask if this can be made better
+        MaterialTable::GetInstance().Clear();
         ResourceManager::GetInstance().Clear();
 
 
+        SavePipelineCache();
+        vkDestroyPipelineCache(m_device, m_pipelineCache, nullptr);
+
         vmaDestroyAllocator(m_allocator); //Thanks thalia <3
         vkDestroyCommandPool(m_device, m_commandPool, nullptr);
         vkDestroyDevice(m_device, nullptr);
@@ -86,12 +94,80 @@ namespace vov {
         vkDestroyInstance(m_instance, nullptr);
     }
 
+    void Device::CreatePipelineCache() {
+        std::vector<char> data{};
+        if (std::ifstream file{PIPELINE_CACHE_PATH, std::ios::binary | std::ios::ate}; file.is_open()) {
+            data.resize(static_cast<size_t>(file.tellg()));
+            file.seekg(0);
+            file.read(data.data(), static_cast<std::streamsize>(data.size()));
+            if (!file || !IsPipelineCacheCompatible(data)) {
+                std::cout << "Pipeline cache at " << PIPELINE_CACHE_PATH << " doesn't match this device, starting cold" << std::endl;
+                data.clear();
+            }
+        }
+
+        VkPipelineCacheCreateInfo cacheInfo{};
+        cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+        cacheInfo.initialDataSize = data.size();
+        cacheInfo.pInitialData = data.empty() ? nullptr : data.data();
+
+        if (vkCreatePipelineCache(m_device, &cacheInfo, nullptr, &m_pipelineCache) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create pipeline cache!");
+        }
+        m_pipelineCacheWarm = !data.empty();
+        std::cout << "Pipeline cache: " << (data.empty() ? "cold" : std::to_string(data.size()) + " bytes loaded") << std::endl;
+    }
+
+    void Device::SavePipelineCache() const {
+        size_t size{0};
+        if (vkGetPipelineCacheData(m_device, m_pipelineCache, &size, nullptr) != VK_SUCCESS || size == 0) {
+            return;
+        }
+        std::vector<char> data(size);
+        if (vkGetPipelineCacheData(m_device, m_pipelineCache, &size, data.data()) != VK_SUCCESS) {
+            return;
+        }
+
+        // Written next to it and swapped in, a crash halfway never leaves a broken cache behind
+        const std::filesystem::path path{PIPELINE_CACHE_PATH};
+        const std::filesystem::path tempPath{path.string() + ".tmp"};
+        std::error_code error{};
+        std::filesystem::create_directories(path.parent_path(), error);
+        {
+            std::ofstream file{tempPath, std::ios::binary | std::ios::trunc};
+            file.write(data.data(), static_cast<std::streamsize>(size));
+            if (!file) {
+                std::cerr << "Failed to write pipeline cache to " << tempPath.string() << std::endl;
+                return;
+            }
+        }
+        std::filesystem::rename(tempPath, path, error);
+        if (error) {
+            std::cerr << "Failed to save pipeline cache: " << error.message() << std::endl;
+        }
+    }
+
+    bool Device::IsPipelineCacheCompatible(const std::vector<char>& data) const {
+        VkPipelineCacheHeaderVersionOne header{};
+        if (data.size() < sizeof(header)) {
+            return false;
+        }
+        std::memcpy(&header, data.data(), sizeof(header));
+
+        return header.headerSize >= sizeof(header) &&
+               header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+               header.vendorID == properties.vendorID &&
+               header.deviceID == properties.deviceID &&
+               std::memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+    }
+
     //TODO: ask if this could be improved to not pass pointers but something else
-    void Device::copyBuffer(const Buffer* srcBuffer, const Buffer* destBuffer, uint32_t size) {
+    void Device::copyBuffer(const Buffer* srcBuffer, const Buffer* destBuffer, uint32_t size, VkDeviceSize destOffset) {
         const VkCommandBuffer commandBuffer = beginSingleTimeCommands();
 
         VkBufferCopy copyRegion{};
         copyRegion.size = size;
+        copyRegion.dstOffset = destOffset;
         vkCmdCopyBuffer(commandBuffer, srcBuffer->getBuffer(), destBuffer->getBuffer(), 1, &copyRegion);
 
         endSingleTimeCommands(commandBuffer);
@@ -389,9 +465,22 @@ namespace vov {
             queueCreateInfos.push_back(queueCreateInfo);
         }
 
+        // GPU driven rendering wants draw counts from a buffer, only turned on when it is there
+        VkPhysicalDeviceVulkan12Features supported12{};
+        supported12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+        VkPhysicalDeviceFeatures2 supportedFeatures{};
+        supportedFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        supportedFeatures.pNext = &supported12;
+        vkGetPhysicalDeviceFeatures2(m_physicalDevice, &supportedFeatures);
+
+        m_supportsDrawIndirectCount = supportedFeatures.features.multiDrawIndirect &&
+                                      supported12.drawIndirectCount;
+
         VkPhysicalDeviceFeatures deviceFeatures = {};
         deviceFeatures.samplerAnisotropy = VK_TRUE;
         deviceFeatures.fillModeNonSolid = VK_TRUE;
+        deviceFeatures.multiDrawIndirect = m_supportsDrawIndirectCount;
+        deviceFeatures.drawIndirectFirstInstance = VK_TRUE; // Indirect draws carry the TransformBuffer index
 
         VkDeviceCreateInfo createInfo = {};
         createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
@@ -403,12 +492,31 @@ namespace vov {
         createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
         createInfo.ppEnabledExtensionNames = deviceExtensions.data();
 
+        // The render graph records its barriers with vkCmdPipelineBarrier2
+        VkPhysicalDeviceSynchronization2Features synchronization2Features {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES,
+            .synchronization2 = VK_TRUE,
+        };
+
         VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamicRenderingFeatures {
             .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR,
+            .pNext = &synchronization2Features,
             .dynamicRendering = VK_TRUE,
         };
 
-        createInfo.pNext = &dynamicRenderingFeatures;
+        VkPhysicalDeviceVulkan12Features features12{};
+        features12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+        features12.pNext = &dynamicRenderingFeatures;
+        features12.drawIndirectCount = m_supportsDrawIndirectCount;
+        // Bindless material textures, see MaterialTable. Required, IsDeviceGood checks for them
+        features12.descriptorIndexing = VK_TRUE;
+        features12.runtimeDescriptorArray = VK_TRUE;
+        features12.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+        features12.descriptorBindingPartiallyBound = VK_TRUE;
+        features12.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+        features12.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+
+        createInfo.pNext = &features12;
 
         if (enableValidationLayers) {
             createInfo.enabledLayerCount = static_cast<uint32_t>(validationLayers.size());
@@ -473,6 +581,17 @@ namespace vov {
         VkPhysicalDeviceFeatures supportedFeatures;
         vkGetPhysicalDeviceFeatures(device, &supportedFeatures);
 
+        VkPhysicalDeviceVulkan12Features supported12{};
+        supported12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+        VkPhysicalDeviceFeatures2 supportedFeatures2{};
+        supportedFeatures2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        supportedFeatures2.pNext = &supported12;
+        vkGetPhysicalDeviceFeatures2(device, &supportedFeatures2);
+
+        const bool supportsBindless = supported12.descriptorIndexing && supported12.runtimeDescriptorArray &&
+                                      supported12.shaderSampledImageArrayNonUniformIndexing && supported12.descriptorBindingPartiallyBound &&
+                                      supported12.descriptorBindingSampledImageUpdateAfterBind && supported12.descriptorBindingUpdateUnusedWhilePending;
+
 
         VkPhysicalDeviceProperties properties;
         vkGetPhysicalDeviceProperties(device, &properties);
@@ -480,7 +599,7 @@ namespace vov {
         bool isDiscreteGPU = properties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU;
 
         return indices.isComplete() && extensionsSupported && swapChainAdequate &&
-               supportedFeatures.samplerAnisotropy;
+               supportedFeatures.samplerAnisotropy && supportedFeatures.drawIndirectFirstInstance && supportsBindless;
     }
 
     bool Device::CheckValidationLayerSupport() const {
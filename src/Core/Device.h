@@ -39,7 +39,7 @@ namespace vov {
 
         explicit Device(Window& window);
         ~Device();
-        void copyBuffer(const Buffer* srcBuffer, const Buffer* destBuffer, uint32_t size);
+        void copyBuffer(const Buffer* srcBuffer, const Buffer* destBuffer, uint32_t size, VkDeviceSize destOffset = 0);
 
 
         Device(const Device& other) = delete;
@@ -56,8 +56,14 @@ namespace vov {
         [[nodiscard]] SwapChainSupportDetails getSwapChainSupport() const { return querySwapChainSupport(m_physicalDevice); }
         [[nodiscard]] VmaAllocator allocator() const { return m_allocator; }
         [[nodiscard]] VkInstance getInstance() const { return m_instance; }
+        // Shared by every pipeline, kept on disk between runs
+        [[nodiscard]] VkPipelineCache GetPipelineCache() const { return m_pipelineCache; }
+        // Seeded from disk this run, false on the first run or after a driver change
+        [[nodiscard]] bool IsPipelineCacheWarm() const { return m_pipelineCacheWarm; }
 
         [[nodiscard]] VkPhysicalDeviceProperties getProperties() const { return properties; }
+        // multiDrawIndirect and drawIndirectCount, everything the GPU driven path needs
+        [[nodiscard]] bool SupportsDrawIndirectCount() const { return m_supportsDrawIndirectCount; }
         QueueFamilyIndices FindPhysicalQueueFamilies() { return FindQueueFamilies(m_physicalDevice); }
 
         void CreateBuffer(
@@ -97,6 +103,10 @@ namespace vov {
         void PickPhysicalDevice();
         void CreateLogicalDevice();
         void CreateCommandPool();
+        void CreatePipelineCache();
+        void SavePipelineCache() const;
+        // Data written by another driver or GPU is ignored, the cache just starts empty
+        [[nodiscard]] bool IsPipelineCacheCompatible(const std::vector<char>& data) const;
 
         void allocVmaAllocator();
 
@@ -121,6 +131,11 @@ namespace vov {
         VkQueue m_presentQueue{};
 
         VmaAllocator m_allocator{};
+        VkPipelineCache m_pipelineCache{VK_NULL_HANDLE};
+        bool m_pipelineCacheWarm{false};
+        static constexpr const char* PIPELINE_CACHE_PATH{"cache/pipeline_cache.bin"};
+
+        bool m_supportsDrawIndirectCount{false};
 
         const std::vector<const char*> validationLayers = {"VK_LAYER_KHRONOS_validation"};
         const std::vector<const char*> deviceExtensions = {VK_KHR_SWAPCHAIN_EXTENSION_NAME, VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME};
@@ -0,0 +1,120 @@
+#include "FramePacer.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace {
+    double ToMilliseconds(std::chrono::steady_clock::duration duration) {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+}
+
+void vov::FramePacer::BeginFrame() {
+    const Clock::time_point previousStart = m_frameStart;
+
+    if (m_mode == Mode::TARGET_RATE && m_targetRate > 0.0) {
+        const Clock::duration interval = GetInterval();
+        if (m_nextStart == Clock::time_point{}) {
+            m_nextStart = Clock::now();
+        }
+
+        Clock::time_point target = m_nextStart;
+        if (m_lowLatency) {
+            // The frame has to be done by the end of its interval, everything before that it would only spend waiting
+            // on the GPU with input that keeps getting older
+            const Percentiles latencies = m_latencies.Get();
+            if (latencies.max > 0.0) {
+                const auto cost = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(latencies.p95)) + LATENCY_SAFETY;
+                if (cost < interval) {
+                    target += interval - cost;
+                }
+            }
+        }
+        WaitUntil(target);
+
+        // On a fixed grid, a frame that started a little late doesn't push back all the ones after it.
+        // More than a whole frame behind starts the grid over instead of rushing frames out to catch up
+        const Clock::time_point start = Clock::now();
+        m_nextStart += interval;
+        if (m_nextStart <= start) {
+            m_nextStart = start + interval;
+        }
+    } else {
+        m_nextStart = {};
+    }
+
+    m_frameStart = Clock::now();
+    if (previousStart != Clock::time_point{}) {
+        m_frameTimes.Add(ToMilliseconds(m_frameStart - previousStart));
+    }
+}
+
+void vov::FramePacer::FrameCompleted() {
+    if (m_frameStart != Clock::time_point{}) {
+        m_latencies.Add(ToMilliseconds(Clock::now() - m_frameStart));
+    }
+}
+
+void vov::FramePacer::RecordGpuTime(double milliseconds) {
+    if (milliseconds > 0.0) {
+        m_gpuTimes.Add(milliseconds);
+    }
+}
+
+void vov::FramePacer::SetMode(Mode mode) {
+    if (mode != m_mode) {
+        m_nextStart = {};
+    }
+    m_mode = mode;
+}
+
+void vov::FramePacer::SetLowLatency(bool lowLatency) {
+    if (lowLatency != m_lowLatency) {
+        // Only measured while it is on, what is left from last time is stale
+        m_latencies.Clear();
+    }
+    m_lowLatency = lowLatency;
+}
+
+double vov::FramePacer::GetSpinMargin() const {
+    return ToMilliseconds(m_spinMargin);
+}
+
+void vov::FramePacer::WaitUntil(Clock::time_point target) {
+    const Clock::time_point sleepUntil = target - m_spinMargin;
+    if (Clock::now() < sleepUntil) {
+        std::this_thread::sleep_until(sleepUntil);
+
+        // Jumps up to a bad oversleep right away and only creeps back down, a late frame costs more than a bit of spinning
+        const Clock::duration overshoot = Clock::now() - sleepUntil;
+        m_spinMargin = std::clamp(std::max(overshoot + overshoot / 4, m_spinMargin - std::chrono::microseconds(10)), MIN_SPIN_MARGIN, MAX_SPIN_MARGIN);
+    }
+
+    while (Clock::now() < target) {
+        std::this_thread::yield();
+    }
+}
+
+std::chrono::steady_clock::duration vov::FramePacer::GetInterval() const {
+    return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / m_targetRate));
+}
+
+void vov::FramePacer::History::Add(double sample) {
+    m_samples[m_next] = sample;
+    m_next = (m_next + 1) % HISTORY_SIZE;
+    m_count = std::min(m_count + 1, HISTORY_SIZE);
+}
+
+vov::FramePacer::Percentiles vov::FramePacer::History::Get() const {
+    if (m_count == 0) {
+        return {};
+    }
+
+    std::array<double, HISTORY_SIZE> sorted = m_samples;
+    std::sort(sorted.begin(), sorted.begin() + static_cast<std::ptrdiff_t>(m_count));
+
+    const auto at = [&] (double percentile) {
+        return sorted[static_cast<size_t>(percentile * static_cast<double>(m_count - 1) + 0.5)];
+    };
+    return {at(0.5), at(0.95), at(0.99), sorted[m_count - 1]};
+}
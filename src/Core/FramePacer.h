@@ -0,0 +1,98 @@
+#ifndef FRAMEPACER_H
+#define FRAMEPACER_H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+
+namespace vov {
+    // Decides when a frame may start. Waits are scheduled on an even grid of deadlines, slept through up to a margin
+    // and spun for the rest, so a frame doesn't start late by however much the OS oversleeps.
+    // In low latency mode the previous frame has to be done on the GPU first and the wait moves in front of the
+    // input, the frame starts as late as it can while its work, as long as it has been taking, still makes the deadline.
+    class FramePacer final {
+    public:
+        enum class Mode {
+            UNCAPPED,
+            TARGET_RATE,    // paced to GetTargetRate
+            PRESENT         // FIFO presentation paces the frames, nothing waits here
+        };
+
+        // In milliseconds, over the last HISTORY_SIZE samples
+        struct Percentiles {
+            double p50{0};
+            double p95{0};
+            double p99{0};
+            double max{0};
+        };
+
+        static constexpr size_t HISTORY_SIZE{240};
+
+        FramePacer() = default;
+        ~FramePacer() = default;
+
+        FramePacer(const FramePacer& other) = delete;
+        FramePacer(FramePacer&& other) noexcept = delete;
+        FramePacer& operator=(const FramePacer& other) = delete;
+        FramePacer& operator=(FramePacer&& other) noexcept = delete;
+
+        // Top of the frame, before the input is read
+        void BeginFrame();
+        // Low latency only, right after waiting for the GPU to finish the last frame.
+        // From BeginFrame to here is everything the frame cost, the next start is planned with it
+        void FrameCompleted();
+        // Of the last frame the GPU finished, from its timestamps
+        void RecordGpuTime(double milliseconds);
+
+        [[nodiscard]] Mode GetMode() const { return m_mode; }
+        void SetMode(Mode mode);
+        [[nodiscard]] double GetTargetRate() const { return m_targetRate; }
+        void SetTargetRate(double rate) { m_targetRate = rate; }
+        [[nodiscard]] bool IsLowLatency() const { return m_lowLatency; }
+        void SetLowLatency(bool lowLatency);
+
+        [[nodiscard]] Percentiles GetFrameTimes() const { return m_frameTimes.Get(); }
+        [[nodiscard]] Percentiles GetGpuTimes() const { return m_gpuTimes.Get(); }
+        // Input to GPU completion, only measured in low latency mode
+        [[nodiscard]] Percentiles GetLatencies() const { return m_latencies.Get(); }
+        // How long before a deadline sleeping stops and spinning starts, grows with the oversleeps seen
+        [[nodiscard]] double GetSpinMargin() const;
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        class History {
+        public:
+            void Add(double sample);
+            void Clear() { m_count = 0; m_next = 0; }
+            [[nodiscard]] Percentiles Get() const;
+
+        private:
+            std::array<double, HISTORY_SIZE> m_samples{};
+            size_t m_count{0};
+            size_t m_next{0};
+        };
+
+        static constexpr Clock::duration MIN_SPIN_MARGIN{std::chrono::microseconds(200)};
+        static constexpr Clock::duration MAX_SPIN_MARGIN{std::chrono::milliseconds(2)};
+        // Added on top of the measured frame cost in low latency mode, a frame that runs a bit long still makes it
+        static constexpr Clock::duration LATENCY_SAFETY{std::chrono::microseconds(500)};
+
+        void WaitUntil(Clock::time_point target);
+        [[nodiscard]] Clock::duration GetInterval() const;
+
+        Mode m_mode{Mode::TARGET_RATE};
+        double m_targetRate{60.0};
+        bool m_lowLatency{false};
+
+        Clock::time_point m_nextStart{};
+        Clock::time_point m_frameStart{};
+        Clock::duration m_spinMargin{std::chrono::milliseconds(1)};
+
+        History m_frameTimes{};
+        History m_gpuTimes{};
+        History m_latencies{};
+    };
+}
+
+#endif //FRAMEPACER_H
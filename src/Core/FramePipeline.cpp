@@ -0,0 +1,95 @@
+#include "FramePipeline.h"
+
+#include <utility>
+
+namespace {
+    double ToMilliseconds(std::chrono::steady_clock::duration duration) {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+}
+
+vov::FramePipeline::FramePipeline(RenderFunction render): m_render{std::move(render)} {
+    m_thread = std::thread(&FramePipeline::RenderLoop, this);
+}
+
+vov::FramePipeline::~FramePipeline() {
+    {
+        std::lock_guard lock(m_mutex);
+        m_stopping = true;
+    }
+    m_condition.notify_all();
+    m_thread.join();
+}
+
+void vov::FramePipeline::WaitIdle() {
+    if (m_submitTime == Clock::time_point{}) {
+        return;
+    }
+
+    const Clock::time_point start = Clock::now();
+    m_timings.simulate = ToMilliseconds(start - m_submitTime);
+    m_submitTime = {};
+
+    std::exception_ptr error{};
+    {
+        std::unique_lock lock(m_mutex);
+        m_condition.wait(lock, [this] { return !m_pending; });
+        error = std::exchange(m_error, nullptr);
+    }
+    m_timings.wait = ToMilliseconds(Clock::now() - start);
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+void vov::FramePipeline::Submit() {
+    m_readIndex = m_writeIndex;
+    m_writeIndex = 1 - m_writeIndex;
+
+    if (!m_enabled) {
+        Render(m_snapshots[m_readIndex]);
+        m_submitTime = Clock::now();
+        return;
+    }
+
+    m_submitTime = Clock::now();
+    {
+        std::lock_guard lock(m_mutex);
+        m_pending = true;
+    }
+    m_condition.notify_all();
+}
+
+void vov::FramePipeline::RenderLoop() {
+    while (true) {
+        {
+            std::unique_lock lock(m_mutex);
+            m_condition.wait(lock, [this] { return m_pending || m_stopping; });
+            if (!m_pending) {
+                return;
+            }
+        }
+
+        // Handed to WaitIdle, an exception leaving this thread would take the whole process down without a message
+        std::exception_ptr error{};
+        try {
+            Render(m_snapshots[m_readIndex]);
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        {
+            std::lock_guard lock(m_mutex);
+            m_error = std::move(error);
+            m_pending = false;
+        }
+        m_condition.notify_all();
+    }
+}
+
+void vov::FramePipeline::Render(RenderSnapshot& snapshot) {
+    const Clock::time_point start = Clock::now();
+    m_render(snapshot);
+    m_timings.render = ToMilliseconds(Clock::now() - start);
+}
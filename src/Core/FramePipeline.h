@@ -0,0 +1,78 @@
+#ifndef FRAMEPIPELINE_H
+#define FRAMEPIPELINE_H
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "Utils/RenderSnapshot.h"
+
+namespace vov {
+    // Renders on its own thread one frame behind the simulation. The simulation captures frame N+1 into the back
+    // snapshot while the render thread records and submits frame N from the front one, Submit swaps them.
+    class FramePipeline final {
+    public:
+        using RenderFunction = std::function<void(RenderSnapshot& snapshot)>;
+
+        // Of the last frame, in milliseconds
+        struct Timings {
+            double simulate{0};     // Submit to the next WaitIdle, the simulation thread's own work
+            double wait{0};         // blocked in WaitIdle on the render thread
+            double render{0};       // recording and submitting, on whichever thread rendered
+        };
+
+        explicit FramePipeline(RenderFunction render);
+        ~FramePipeline();
+
+        FramePipeline(const FramePipeline& other) = delete;
+        FramePipeline(FramePipeline&& other) noexcept = delete;
+        FramePipeline& operator=(const FramePipeline& other) = delete;
+        FramePipeline& operator=(FramePipeline&& other) noexcept = delete;
+
+        // The back snapshot, only the simulation thread touches it until Submit
+        [[nodiscard]] RenderSnapshot& GetSnapshot() { return m_snapshots[m_writeIndex]; }
+
+        // Blocks until the render thread is done with the last submitted frame and rethrows what it threw.
+        // Until the next Submit nothing renders, passes, the queue and ImGui are the simulation's to change.
+        // Returns right away when nothing was submitted since the last call
+        void WaitIdle();
+        // Has to follow a WaitIdle, renders the back snapshot on the render thread or right here when disabled
+        void Submit();
+
+        // Only while idle, the next Submit picks it up
+        [[nodiscard]] bool IsEnabled() const { return m_enabled; }
+        void SetEnabled(bool enabled) { m_enabled = enabled; }
+        // Only while idle
+        [[nodiscard]] const Timings& GetTimings() const { return m_timings; }
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        void RenderLoop();
+        void Render(RenderSnapshot& snapshot);
+
+        RenderFunction m_render;
+
+        std::array<RenderSnapshot, 2> m_snapshots{};
+        uint32_t m_writeIndex{0};
+        uint32_t m_readIndex{0};
+
+        std::mutex m_mutex{};
+        std::condition_variable m_condition{};
+        bool m_pending{false};
+        bool m_stopping{false};
+        std::exception_ptr m_error{};
+
+        bool m_enabled{true};
+        Timings m_timings{};
+        Clock::time_point m_submitTime{};
+
+        std::thread m_thread{};
+    };
+}
+
+#endif //FRAMEPIPELINE_H
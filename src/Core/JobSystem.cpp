@@ -0,0 +1,285 @@
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+namespace {
+    // 0 for threads the job system didn't start
+    thread_local uint32_t t_worker = 0;
+
+    int64_t NowNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+}
+
+vov::JobSystem::JobSystem() {
+    // One core stays with the thread that waits, it runs jobs too
+    const uint32_t hardwareThreads = std::max(std::thread::hardware_concurrency(), 2u);
+    const uint32_t workerCount = std::min(hardwareThreads - 1, MAX_WORKERS);
+
+    for (uint32_t i = 0; i <= workerCount; ++i) {
+        m_queues.push_back(std::make_unique<WorkerQueue>());
+    }
+    for (uint32_t worker = 1; worker <= workerCount; ++worker) {
+        m_threads.emplace_back(&JobSystem::WorkerLoop, this, worker);
+    }
+}
+
+vov::JobSystem::~JobSystem() {
+    {
+        std::lock_guard lock(m_sleepMutex);
+        m_stopping = true;
+    }
+    m_sleepCondition.notify_all();
+
+    for (std::thread& thread : m_threads) {
+        thread.join();
+    }
+}
+
+void vov::JobSystem::Schedule(const char* name, std::function<void()> task, JobCounter* counter, JobCounter* dependency) {
+    if (counter != nullptr) {
+        counter->m_pending.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    Job job{name, std::move(task), counter};
+    if (dependency != nullptr) {
+        // Finish drains the continuations under the same lock, so the job is either parked here or pushed now
+        std::lock_guard lock(dependency->m_mutex);
+        if (!dependency->IsDone()) {
+            dependency->m_continuations.push_back(std::move(job));
+            return;
+        }
+    }
+
+    Push(std::move(job));
+}
+
+void vov::JobSystem::Wait(JobCounter& counter) {
+    const uint32_t worker = GetCurrentWorker();
+    while (!counter.IsDone()) {
+        Job job{};
+        if (TryPop(worker, job)) {
+            Execute(job, worker);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+    // The last Finish may still hold the lock, after this nothing touches the counter and the caller can drop it
+    std::exception_ptr error{};
+    {
+        std::lock_guard lock(counter.m_mutex);
+        std::swap(error, counter.m_error);
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+void vov::JobSystem::ParallelFor(const char* name, size_t count, size_t minBatch, const std::function<void(size_t begin, size_t end)>& body) {
+    if (count == 0) {
+        return;
+    }
+
+    // A few batches per thread so stealing can even out uneven work
+    const size_t maxBatches = static_cast<size_t>(GetWorkerCount()) * 4;
+    const size_t batches = std::clamp<size_t>(count / std::max<size_t>(minBatch, 1), 1, maxBatches);
+    if (batches == 1) {
+        body(0, count);
+        return;
+    }
+
+    JobCounter counter{};
+    for (size_t batch = 1; batch < batches; ++batch) {
+        Schedule(name, [&body, batch, batches, count] {
+            body(count * batch / batches, count * (batch + 1) / batches);
+        }, &counter);
+    }
+
+    // The other batches still reference body and counter, so even a throw here has to wait for them
+    try {
+        Run(name, GetCurrentWorker(), [&body, batches, count] {
+            body(0, count / batches);
+        });
+    } catch (...) {
+        SetError(counter, std::current_exception());
+    }
+    Wait(counter);
+}
+
+uint32_t vov::JobSystem::GetCurrentWorker() {
+    return t_worker;
+}
+
+void vov::JobSystem::SetTraceHook(TraceHook hook) {
+    m_tracing = static_cast<bool>(hook);
+    m_traceHook = std::move(hook);
+}
+
+vov::JobSystem::BenchmarkResult vov::JobSystem::Benchmark(uint32_t jobCount) {
+    BenchmarkResult result{};
+    result.jobs = std::max(jobCount, 1u);
+    const auto perJob = [&result] (int64_t ns) { return static_cast<double>(ns) / static_cast<double>(result.jobs); };
+
+    JobCounter counter{};
+    const int64_t start = NowNs();
+    for (uint32_t i = 0; i < result.jobs; ++i) {
+        Schedule("Benchmark", [] {}, &counter);
+    }
+    const int64_t scheduled = NowNs();
+    Wait(counter);
+    const int64_t joined = NowNs();
+
+    result.scheduleNs = perJob(scheduled - start);
+    result.roundTripNs = perJob(joined - start);
+
+    // Same number of batches as jobs above, in ParallelFors as wide as they get
+    const uint32_t batches = GetWorkerCount() * 4;
+    const uint32_t parallelFors = std::max(result.jobs / batches, 1u);
+    const int64_t parallelForStart = NowNs();
+    for (uint32_t i = 0; i < parallelFors; ++i) {
+        ParallelFor("Benchmark", batches, 1, [] (size_t, size_t) {});
+    }
+    result.parallelForNs = static_cast<double>(NowNs() - parallelForStart) / static_cast<double>(parallelFors * batches);
+
+    return result;
+}
+
+void vov::JobSystem::WorkerLoop(uint32_t worker) {
+    t_worker = worker;
+
+    uint32_t spins = 0;
+    while (true) {
+        Job job{};
+        if (TryPop(worker, job)) {
+            Execute(job, worker);
+            spins = 0;
+            continue;
+        }
+
+        if (spins < SPIN_COUNT) {
+            ++spins;
+            std::this_thread::yield();
+            continue;
+        }
+
+        std::unique_lock lock(m_sleepMutex);
+        ++m_sleeping;
+        m_sleepCondition.wait(lock, [this] { return m_queuedJobs > 0 || m_stopping; });
+        --m_sleeping;
+        if (m_stopping && m_queuedJobs == 0) {
+            return;
+        }
+        spins = 0;
+    }
+}
+
+void vov::JobSystem::Push(Job&& job) {
+    // Counted before it is visible so TryPop can't take it below zero, a worker seeing it early just tries again
+    ++m_queuedJobs;
+
+    WorkerQueue& queue = *m_queues[GetCurrentWorker()];
+    {
+        std::lock_guard lock(queue.mutex);
+        queue.jobs.push_back(std::move(job));
+    }
+
+    // Both sides are seq_cst, a worker going to sleep either sees the job or is counted here
+    if (m_sleeping > 0) {
+        { std::lock_guard lock(m_sleepMutex); }
+        m_sleepCondition.notify_one();
+    }
+}
+
+bool vov::JobSystem::TryPop(uint32_t worker, Job& job) {
+    if (m_queuedJobs == 0) {
+        return false;
+    }
+
+    // Own jobs newest first, they are the most likely to still be in cache
+    {
+        WorkerQueue& queue = *m_queues[worker];
+        std::lock_guard lock(queue.mutex);
+        if (!queue.jobs.empty()) {
+            job = std::move(queue.jobs.back());
+            queue.jobs.pop_back();
+            --m_queuedJobs;
+            return true;
+        }
+    }
+
+    // Steal oldest first, those tend to be the biggest chunks left
+    const auto queueCount = static_cast<uint32_t>(m_queues.size());
+    for (uint32_t i = 1; i < queueCount; ++i) {
+        WorkerQueue& victim = *m_queues[(worker + i) % queueCount];
+        std::lock_guard lock(victim.mutex);
+        if (!victim.jobs.empty()) {
+            job = std::move(victim.jobs.front());
+            victim.jobs.pop_front();
+            --m_queuedJobs;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void vov::JobSystem::Execute(Job& job, uint32_t worker) {
+    // A throw would take the worker down and leave the counter pending forever, Wait gets it instead
+    try {
+        Run(job.name, worker, job.task);
+    } catch (...) {
+        if (job.counter != nullptr) {
+            SetError(*job.counter, std::current_exception());
+        } else {
+            try {
+                throw;
+            } catch (const std::exception& exception) {
+                std::cerr << "Job " << job.name << " threw: " << exception.what() << std::endl;
+            } catch (...) {
+                std::cerr << "Job " << job.name << " threw" << std::endl;
+            }
+        }
+    }
+
+    if (job.counter != nullptr) {
+        Finish(*job.counter);
+    }
+}
+
+void vov::JobSystem::Run(const char* name, uint32_t worker, const std::function<void()>& task) {
+    if (!m_tracing) {
+        task();
+        return;
+    }
+
+    TraceEvent event{name, worker, NowNs(), 0};
+    task();
+    event.endNs = NowNs();
+    m_traceHook(event);
+}
+
+void vov::JobSystem::Finish(JobCounter& counter) {
+    std::vector<Job> continuations{};
+    {
+        std::lock_guard lock(counter.m_mutex);
+        if (counter.m_pending.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+            return;
+        }
+        continuations.swap(counter.m_continuations);
+    }
+
+    // Past the lock the counter may already be gone, only the moved out jobs are touched
+    for (Job& continuation : continuations) {
+        Push(std::move(continuation));
+    }
+}
+
+void vov::JobSystem::SetError(JobCounter& counter, std::exception_ptr error) {
+    std::lock_guard lock(counter.m_mutex);
+    if (!counter.m_error) {
+        counter.m_error = std::move(error);
+    }
+}
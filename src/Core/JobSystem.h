@@ -0,0 +1,136 @@
+#ifndef JOBSYSTEM_H
+#define JOBSYSTEM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Utils/Singleton.h"
+
+namespace vov {
+    class JobCounter;
+
+    struct Job {
+        const char* name{"Job"};
+        std::function<void()> task{};
+        JobCounter* counter{nullptr};
+    };
+
+    // Counts the unfinished jobs it was handed to, JobSystem::Wait on it to join them.
+    // Can be reused once it is done, it has to outlive every job and continuation that uses it.
+    // A job that throws still counts as done, Wait rethrows the first exception.
+    class JobCounter final {
+    public:
+        JobCounter() = default;
+        ~JobCounter() = default;
+
+        JobCounter(const JobCounter& other) = delete;
+        JobCounter(JobCounter&& other) noexcept = delete;
+        JobCounter& operator=(const JobCounter& other) = delete;
+        JobCounter& operator=(JobCounter&& other) noexcept = delete;
+
+        [[nodiscard]] bool IsDone() const { return m_pending.load(std::memory_order_acquire) == 0; }
+
+    private:
+        friend class JobSystem;
+
+        std::atomic<uint32_t> m_pending{0};
+        // Guards the continuations, the error and the last decrement, see JobSystem::Finish
+        std::mutex m_mutex{};
+        std::vector<Job> m_continuations{};
+        std::exception_ptr m_error{};
+    };
+
+    // Work stealing scheduler, every worker pops the newest job of its own deque and steals the oldest of the others.
+    // Threads that aren't workers push to a shared deque and help out while they Wait, so waiting never blocks a core.
+    class JobSystem final : public Singleton<JobSystem> {
+    public:
+        struct TraceEvent {
+            const char* name{""};
+            uint32_t worker{0};
+            int64_t beginNs{0};
+            int64_t endNs{0};
+        };
+        // Called on the worker right after every job, keep it cheap
+        using TraceHook = std::function<void(const TraceEvent& event)>;
+
+        // Per job costs of Benchmark, all jobs are empty
+        struct BenchmarkResult {
+            uint32_t jobs{0};
+            double scheduleNs{0};       // pushing a job
+            double roundTripNs{0};      // pushing, running and joining a job
+            double parallelForNs{0};    // one batch of a ParallelFor, joining included
+        };
+
+        JobSystem(const JobSystem& other) = delete;
+        JobSystem(JobSystem&& other) = delete;
+        JobSystem& operator=(const JobSystem& other) = delete;
+        JobSystem& operator=(JobSystem&& other) = delete;
+
+        // counter goes up now and down when the job is done. With a dependency the job is held back until that is done.
+        void Schedule(const char* name, std::function<void()> task, JobCounter* counter = nullptr, JobCounter* dependency = nullptr);
+        // Runs other jobs on the calling thread until counter is done, so waiting from inside a job can't deadlock.
+        // Rethrows the first exception one of its jobs threw, continuations waiting on it still run
+        void Wait(JobCounter& counter);
+        // Splits [0, count) in batches of at least minBatch, the calling thread runs the first one and returns when all are done.
+        // Rethrows the first exception a batch threw once every batch is done
+        void ParallelFor(const char* name, size_t count, size_t minBatch, const std::function<void(size_t begin, size_t end)>& body);
+
+        // Threads that run jobs, the workers plus the one waiting
+        [[nodiscard]] uint32_t GetWorkerCount() const { return static_cast<uint32_t>(m_threads.size()) + 1; }
+        // 1 and up on workers, 0 for every other thread
+        [[nodiscard]] static uint32_t GetCurrentWorker();
+
+        // Not synchronized with running jobs, set it while nothing is scheduled. An empty hook turns tracing off
+        void SetTraceHook(TraceHook hook);
+
+        // The same numbers without the GUI come from benchmarks/JobSystemBenchmark.cpp
+        [[nodiscard]] BenchmarkResult Benchmark(uint32_t jobCount);
+
+    private:
+        friend class Singleton;
+
+        struct WorkerQueue {
+            std::mutex mutex{};
+            std::deque<Job> jobs{};
+        };
+
+        JobSystem();
+        ~JobSystem() override;
+
+        void WorkerLoop(uint32_t worker);
+        void Push(Job&& job);
+        bool TryPop(uint32_t worker, Job& job);
+        void Execute(Job& job, uint32_t worker);
+        // Calls task, wrapped in a trace event when there is a hook
+        void Run(const char* name, uint32_t worker, const std::function<void()>& task);
+        void Finish(JobCounter& counter);
+        static void SetError(JobCounter& counter, std::exception_ptr error);
+
+        static constexpr uint32_t MAX_WORKERS = 31;
+        // Yields before a worker sleeps, jobs tend to come in bursts
+        static constexpr uint32_t SPIN_COUNT = 64;
+
+        // Index 0 is shared by every thread that isn't a worker
+        std::vector<std::unique_ptr<WorkerQueue>> m_queues{};
+        std::vector<std::thread> m_threads{};
+
+        std::atomic<uint32_t> m_queuedJobs{0};
+        std::atomic<uint32_t> m_sleeping{0};
+        std::atomic<bool> m_stopping{false};
+        std::mutex m_sleepMutex{};
+        std::condition_variable m_sleepCondition{};
+
+        TraceHook m_traceHook{};
+        std::atomic<bool> m_tracing{false};
+    };
+}
+
+#endif //JOBSYSTEM_H
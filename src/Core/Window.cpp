@@ -1,5 +1,6 @@
 #include "Window.h"
 
+#include <chrono>
 #include <fstream>
 #include <iostream>
 #include <stdexcept>
@@ -151,6 +152,14 @@ namespace vov {
         return false;
     }
 
+    void Window::WaitEvents() const {
+        if (std::this_thread::get_id() == m_mainThread) {
+            glfwWaitEvents();
+        } else {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+
     void Window::framebufferResizeCallback(GLFWwindow* window, int width, int height) {
         const auto MyWindow = static_cast<Window*>(glfwGetWindowUserPointer(window));
         MyWindow->m_resized = true;
@@ -1,7 +1,9 @@
 #ifndef WINDOW_H
 #define WINDOW_H
+#include <atomic>
 #include <cstdint>
 #include <string>
+#include <thread>
 
 #define GLFW_INCLUDE_VULKAN
 #include <unordered_map>
@@ -24,6 +26,9 @@ namespace vov {
 
         [[nodiscard]] VkExtent2D getExtent() const { return {static_cast<uint32_t>(m_width), static_cast<uint32_t>(m_height)}; }
 
+        // glfwWaitEvents on the thread that made the window, anywhere else it just sleeps while that thread polls
+        void WaitEvents() const;
+
         void LockCursor();
         void UnlockCursor();
         [[nodiscard]] bool isCursorLocked() const { return m_cursorLocked; }
@@ -55,14 +60,16 @@ namespace vov {
 
         void ShowSplash();
 
-        uint32_t m_width;
-        uint32_t m_height;
+        // The render thread reads these while PollInput runs the callbacks
+        std::atomic<uint32_t> m_width;
+        std::atomic<uint32_t> m_height;
 
         glm::vec2 m_lastMousePos{};
         glm::vec2 m_currentMousePos{};
 
-        bool m_resized = false;
+        std::atomic<bool> m_resized = false;
         std::string m_windowName;
+        std::thread::id m_mainThread{std::this_thread::get_id()};
 
         bool m_cursorLocked = false;
         bool m_shouldToggleCursor = false;
@@ -6,7 +6,8 @@
 namespace vov {
     DescriptorSetLayout::Builder& DescriptorSetLayout::Builder::addBinding(uint32_t binding, VkDescriptorType type,
                                                                              VkShaderStageFlags stageFlags,
-                                                                             uint32_t count) {
+                                                                             uint32_t count,
+                                                                             VkDescriptorBindingFlags bindingFlags) {
         assert(!m_bindings.contains(binding) && "Binding already in use");
         VkDescriptorSetLayoutBinding layoutBinding{};
         layoutBinding.binding = binding;
@@ -14,24 +15,46 @@ namespace vov {
         layoutBinding.descriptorCount = count;
         layoutBinding.stageFlags = stageFlags;
         m_bindings[binding] = layoutBinding;
+        if (bindingFlags != 0) {
+            m_bindingFlags[binding] = bindingFlags;
+        }
         return *this;
     }
 
     std::unique_ptr<DescriptorSetLayout> DescriptorSetLayout::Builder::build() {
-        return std::make_unique<DescriptorSetLayout>(m_device, m_bindings);
+        return std::make_unique<DescriptorSetLayout>(m_device, m_bindings, m_bindingFlags);
     }
 
     DescriptorSetLayout::DescriptorSetLayout(Device& deviceRef,
-                                               const std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding>& bindings): m_device{deviceRef}, m_bindings{bindings} {
+                                               const std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding>& bindings,
+                                               const std::unordered_map<uint32_t, VkDescriptorBindingFlags>& bindingFlags): m_device{deviceRef}, m_bindings{bindings} {
         std::vector<VkDescriptorSetLayoutBinding> setLayoutBindings{};
+        // Parallel to setLayoutBindings
+        std::vector<VkDescriptorBindingFlags> setLayoutBindingFlags{};
+        bool updateAfterBind = false;
         for (auto kv: bindings) {
             setLayoutBindings.push_back(kv.second);
+
+            const auto flags = bindingFlags.find(kv.first);
+            setLayoutBindingFlags.push_back(flags != bindingFlags.end() ? flags->second : 0);
+            updateAfterBind |= (setLayoutBindingFlags.back() & VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT) != 0;
         }
 
+        VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo{};
+        bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+        bindingFlagsInfo.bindingCount = static_cast<uint32_t>(setLayoutBindingFlags.size());
+        bindingFlagsInfo.pBindingFlags = setLayoutBindingFlags.data();
+
         VkDescriptorSetLayoutCreateInfo descriptorSetLayoutInfo{};
         descriptorSetLayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
         descriptorSetLayoutInfo.bindingCount = static_cast<uint32_t>(setLayoutBindings.size());
         descriptorSetLayoutInfo.pBindings = setLayoutBindings.data();
+        if (!bindingFlags.empty()) {
+            descriptorSetLayoutInfo.pNext = &bindingFlagsInfo;
+        }
+        if (updateAfterBind) {
+            descriptorSetLayoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+        }
 
         if (vkCreateDescriptorSetLayout(
                 m_device.device(),
@@ -15,7 +15,8 @@ namespace vov {
                 uint32_t binding,
                 VkDescriptorType type,
                 VkShaderStageFlags stageFlags,
-                uint32_t count = 1
+                uint32_t count = 1,
+                VkDescriptorBindingFlags bindingFlags = 0
             );
 
             std::unique_ptr<DescriptorSetLayout> build();
@@ -23,9 +24,12 @@ namespace vov {
         private:
             Device& m_device;
             std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> m_bindings{};
+            std::unordered_map<uint32_t, VkDescriptorBindingFlags> m_bindingFlags{};
         };
 
-        DescriptorSetLayout(Device& deviceRef, const std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding>& bindings);
+        // A binding with UPDATE_AFTER_BIND makes the whole layout one for an UPDATE_AFTER_BIND pool
+        DescriptorSetLayout(Device& deviceRef, const std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding>& bindings,
+                            const std::unordered_map<uint32_t, VkDescriptorBindingFlags>& bindingFlags = {});
         ~DescriptorSetLayout();
         DescriptorSetLayout(const DescriptorSetLayout &) = delete;
         DescriptorSetLayout &operator=(const DescriptorSetLayout &) = delete;
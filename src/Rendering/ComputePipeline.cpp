@@ -0,0 +1,107 @@
+#include "ComputePipeline.h"
+
+#include <cassert>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <Utils/Chalk.h>
+
+#include "Pipeline.h"
+#include "PipelineBatch.h"
+#include "ShaderReloader.h"
+#include "Utils/DebugLabel.h"
+
+namespace vov {
+    ComputePipeline::ComputePipeline(Device& device, const std::string& compPath, VkPipelineLayout pipelineLayout, const std::string& name):
+        m_device(device), m_compPath{compPath}, m_pipelineLayout{pipelineLayout}, m_name{name} {
+        assert(pipelineLayout != VK_NULL_HANDLE && "no pipelineLayout provided");
+
+        PipelineBatch::GetInstance().Submit("Compute pipeline", [this] {
+            m_handles = Create(Pipeline::readFile(m_compPath));
+        });
+
+        ShaderReloader::Reloadable reloadable{};
+        reloadable.spirvFiles = {std::filesystem::path(m_compPath).filename().string()};
+        reloadable.prepare = [this] { return PrepareReload(); };
+        reloadable.apply = [this] { ApplyReload(); };
+        ShaderReloader::GetInstance().Register(this, std::move(reloadable));
+    }
+
+    ComputePipeline::Handles ComputePipeline::Create(const std::vector<char>& compCode) const {
+        std::cout << "Comp file: " << Chalk::Magenta << std::filesystem::path(m_compPath).filename().string() << Chalk::Reset << std::endl;
+
+        Handles handles{};
+        handles.hash = ShaderReloader::Hash(compCode);
+
+        VkShaderModuleCreateInfo moduleInfo{};
+        moduleInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+        moduleInfo.codeSize = compCode.size();
+        moduleInfo.pCode = reinterpret_cast<const uint32_t*>(compCode.data());
+
+        if (vkCreateShaderModule(m_device.device(), &moduleInfo, nullptr, &handles.module) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create shader module!");
+        }
+
+        VkPipelineShaderStageCreateInfo stageInfo{};
+        stageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        stageInfo.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+        stageInfo.module = handles.module;
+        stageInfo.pName = "main";
+
+        VkComputePipelineCreateInfo pipelineInfo{};
+        pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipelineInfo.stage = stageInfo;
+        pipelineInfo.layout = m_pipelineLayout;
+        pipelineInfo.basePipelineIndex = -1;
+        pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+
+        if (vkCreateComputePipelines(m_device.device(), m_device.GetPipelineCache(), 1, &pipelineInfo, nullptr, &handles.pipeline) != VK_SUCCESS) {
+            Destroy(handles);
+            throw std::runtime_error("Can't make compute pipeline!");
+        }
+
+        if (!m_name.empty()) {
+            DebugLabel::SetObjectName(reinterpret_cast<uint64_t>(handles.pipeline), VK_OBJECT_TYPE_PIPELINE, m_name);
+        }
+        return handles;
+    }
+
+    void ComputePipeline::Destroy(const Handles& handles) const {
+        vkDestroyShaderModule(m_device.device(), handles.module, nullptr);
+        vkDestroyPipeline(m_device.device(), handles.pipeline, nullptr);
+    }
+
+    bool ComputePipeline::PrepareReload() {
+        const std::vector<char> compCode = Pipeline::readFile(m_compPath);
+        const Handles& latest = m_pending.pipeline != VK_NULL_HANDLE ? m_pending : m_handles;
+        if (ShaderReloader::Hash(compCode) == latest.hash) {
+            return false;
+        }
+
+        try {
+            Handles handles = Create(compCode);
+            Destroy(m_pending);
+            m_pending = handles;
+            return true;
+        } catch (const std::exception& exception) {
+            std::cerr << "Failed to reload " << m_name << ": " << exception.what() << std::endl;
+            return false;
+        }
+    }
+
+    void ComputePipeline::ApplyReload() {
+        Destroy(m_handles);
+        m_handles = m_pending;
+        m_pending = {};
+    }
+
+    ComputePipeline::~ComputePipeline() {
+        ShaderReloader::GetInstance().Unregister(this);
+        Destroy(m_pending);
+        Destroy(m_handles);
+    }
+
+    void ComputePipeline::bind(VkCommandBuffer buffer) const {
+        vkCmdBindPipeline(buffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_handles.pipeline);
+    }
+}
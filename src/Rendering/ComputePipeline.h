@@ -0,0 +1,51 @@
+#ifndef COMPUTEPIPELINE_H
+#define COMPUTEPIPELINE_H
+
+#include <string>
+#include <vector>
+
+#include "Core/Device.h"
+
+namespace vov {
+    // Compiled as a job inside a PipelineBatch, rebuilt when its shader changes
+    class ComputePipeline {
+    public:
+        ComputePipeline(Device& device, const std::string& compPath, VkPipelineLayout pipelineLayout, const std::string& name = "");
+        ~ComputePipeline();
+
+        ComputePipeline(const ComputePipeline& other) = delete;
+        ComputePipeline(ComputePipeline&& other) noexcept = delete;
+        ComputePipeline& operator=(const ComputePipeline& other) = delete;
+        ComputePipeline& operator=(ComputePipeline&& other) noexcept = delete;
+
+        void bind(VkCommandBuffer buffer) const;
+
+        // Rounds up so every item gets a thread, the shader has to bounds check
+        static uint32_t GroupCount(uint32_t itemCount, uint32_t groupSize) { return (itemCount + groupSize - 1) / groupSize; }
+
+    private:
+        struct Handles {
+            VkPipeline pipeline{VK_NULL_HANDLE};
+            VkShaderModule module{VK_NULL_HANDLE};
+            uint64_t hash{0};
+        };
+
+        [[nodiscard]] Handles Create(const std::vector<char>& compCode) const;
+        void Destroy(const Handles& handles) const;
+
+        // See ShaderReloader
+        bool PrepareReload();
+        void ApplyReload();
+
+        Device& m_device;
+
+        std::string m_compPath{};
+        VkPipelineLayout m_pipelineLayout{VK_NULL_HANDLE};
+        std::string m_name{};
+
+        Handles m_handles{};
+        Handles m_pending{};    // rebuilt by a shader reload, swapped in at the next frame boundary
+    };
+}
+
+#endif //COMPUTEPIPELINE_H
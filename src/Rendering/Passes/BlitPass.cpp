@@ -7,7 +7,7 @@
 #include "Utils/DebugLabel.h"
 #include "Utils/ResourceManager.h"
 
-vov::BlitPass::BlitPass(Device& deviceRef, uint32_t framesInFlight, LightingPass& lightingPass, const Swapchain& swapchain): m_device{deviceRef}, m_lightingPass{lightingPass}, m_framesInFlight{framesInFlight}, m_exposureBuffers{deviceRef} {
+vov::BlitPass::BlitPass(Device& deviceRef, uint32_t framesInFlight, const Swapchain& swapchain): m_device{deviceRef}, m_framesInFlight{framesInFlight}, m_exposureBuffers{deviceRef} {
     m_descriptorPool = DescriptorPool::Builder(m_device)
             .SetName("BlitPass Descriptor Pool")
             .setMaxSets(framesInFlight * 2)
@@ -63,7 +63,8 @@ vov::BlitPass::BlitPass(Device& deviceRef, uint32_t framesInFlight, LightingPass
 
     m_descriptorSets.resize(framesInFlight);
 
-    auto dummyImage = ResourceManager::GetInstance().LoadImage(m_device, "resources/Gear.png", VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+    // The real targets only exist once a frame's render graph is compiled
+    const auto dummyImage = ResourceManager::GetInstance().LoadDummyImage(m_device);
 
     for (size_t i{0}; i < m_framesInFlight; i++) {
         m_descriptorPool->allocateDescriptor(m_descriptorSetLayout->getDescriptorSetLayout(), m_descriptorSets[i]);
@@ -71,8 +72,8 @@ vov::BlitPass::BlitPass(Device& deviceRef, uint32_t framesInFlight, LightingPass
         auto bufferInfo = m_exposureBuffers[i]->descriptorInfo();
 
         VkDescriptorImageInfo dummyInfo{};
-        dummyInfo.sampler = lightingPass.GetImage(i).getSampler();
-        dummyInfo.imageView = lightingPass.GetImage(i).GetImageView();
+        dummyInfo.sampler = dummyImage->getSampler();
+        dummyInfo.imageView = dummyImage->GetImageView();
         dummyInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 
         DescriptorWriter(*m_descriptorSetLayout, *m_descriptorPool)
@@ -95,6 +96,7 @@ void vov::BlitPass::Record(const FrameContext& context, VkCommandBuffer commandB
     ubo.camSettings.apeture = context.camera.GetAperture();
     ubo.camSettings.iso = context.camera.GetISO();
     ubo.camSettings.shutterSpeed = context.camera.GetShutterSpeed();
+    ubo.hasLines = m_hasLines ? 1 : 0;
 
     m_exposureBuffers.update(imageIndex, ubo);
 
@@ -137,9 +139,11 @@ void vov::BlitPass::Record(const FrameContext& context, VkCommandBuffer commandB
     DebugLabel::EndCmdLabel(commandBuffer);
 }
 
-void vov::BlitPass::UpdateDescriptor(uint32_t frameIndex, const Image& lightingOutput, const Image& lineOutput) {
+void vov::BlitPass::UpdateDescriptor(uint32_t frameIndex, const Image& lightingOutput, const Image* lineOutput) {
+    // Something valid has to sit in the line slot, the shader skips it
+    m_hasLines = lineOutput != nullptr;
     const auto lightingInfo = lightingOutput.descriptorInfo();
-    const auto lineInfo = lineOutput.descriptorInfo();
+    const auto lineInfo = m_hasLines ? lineOutput->descriptorInfo() : lightingInfo;
     const auto bufferInfo = m_exposureBuffers[frameIndex]->descriptorInfo();
     DescriptorWriter(*m_descriptorSetLayout, *m_descriptorPool)
             .writeBuffer(0, &bufferInfo)
@@ -147,20 +151,3 @@ void vov::BlitPass::UpdateDescriptor(uint32_t frameIndex, const Image& lightingO
             .writeImage(2, &lineInfo)
             .overwrite(m_descriptorSets[frameIndex]);
 }
-
-void vov::BlitPass::Resize(VkExtent2D newSize, const LightingPass& lightingPass) {
-    for (size_t i{0}; i < m_framesInFlight; i++) {
-        VkDescriptorImageInfo imageInfo{};
-        imageInfo.sampler = lightingPass.GetImage(i).getSampler();
-        imageInfo.imageView = lightingPass.GetImage(i).GetImageView();
-        imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-
-        auto bufferInfo = m_exposureBuffers[i]->descriptorInfo();
-
-        DescriptorWriter(*m_descriptorSetLayout, *m_descriptorPool)
-                .writeBuffer(0, &bufferInfo)
-                .writeImage(1, &imageInfo)
-                .writeImage(2, &imageInfo)
-                .overwrite(m_descriptorSets[i]);
-    }
-}
@@ -12,22 +12,22 @@ namespace vov {
 
     struct UniformBufferData {
         Camera::CameraSettings camSettings{};
+        uint32_t hasLines{0};
     };
 
     class BlitPass {
     public:
-        explicit BlitPass(Device& deviceRef, uint32_t framesInFlight, LightingPass& lightingPass, const Swapchain& swapchain);
+        explicit BlitPass(Device& deviceRef, uint32_t framesInFlight, const Swapchain& swapchain);
         ~BlitPass();
 
         void Record(const FrameContext& context, VkCommandBuffer commandBuffer, uint32_t imageIndex, const Swapchain& swapchain);
 
-        void UpdateDescriptor(uint32_t frameIndex, const Image& lightingOutput, const Image& lineOutput);
-
-        void Resize(VkExtent2D newSize, const LightingPass& lightingPass);
+        // lineOutput is null on frames without lines, their pass isn't run at all
+        void UpdateDescriptor(uint32_t frameIndex, const Image& lightingOutput, const Image* lineOutput);
 
     private:
         Device& m_device;
-        LightingPass& m_lightingPass;
+        bool m_hasLines{false};
 
         std::unique_ptr<DescriptorPool> m_descriptorPool{};
         uint32_t m_framesInFlight{};
@@ -1,14 +1,24 @@
 #include "DepthPrePass.h"
 
+#include <algorithm>
 #include <array>
 #include <stdexcept>
 
+#include <glm/gtc/constants.hpp>
+
 #include "Descriptors/DescriptorSetLayout.h"
 #include "Descriptors/DescriptorWriter.h"
 #include "Rendering/Pipeline.h"
 #include "Resources/Buffer.h"
+#include "Utils/AABB.h"
 #include "Utils/DebugLabel.h"
 
+namespace {
+    // Smoothing and the margin for turning back on keep the auto disable from flipping every frame
+    constexpr float SMOOTHING = 0.1f;
+    constexpr float HYSTERESIS = 1.25f;
+}
+
 vov::DepthPrePass::~DepthPrePass() {
     vkDestroyPipelineLayout(m_device.device(), m_pipelineLayout, nullptr);
     m_descriptorPool.reset();
@@ -16,8 +26,9 @@ vov::DepthPrePass::~DepthPrePass() {
     m_pipeline.reset();
 }
 
-void vov::DepthPrePass::Init(VkFormat depthFormat, uint32_t framesInFlight) {
+void vov::DepthPrePass::Init(VkFormat depthFormat, uint32_t framesInFlight, const TransformBuffer& transforms) {
     //Cant save device
+    m_transforms = &transforms;
     m_depthFormat = depthFormat;
     m_framesInFlight = framesInFlight;
 
@@ -38,15 +49,9 @@ void vov::DepthPrePass::Init(VkFormat depthFormat, uint32_t framesInFlight) {
 
     m_uniformBuffer.SetName("Depth Pre Pass Uniform Buffer");
 
-
-    VkPushConstantRange pushConstantRange{};
-    pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
-    pushConstantRange.offset = 0;
-    pushConstantRange.size = sizeof(PushConstant);
-
-
-    const std::array<VkDescriptorSetLayout, 1> descriptorSetLayouts = {
-        m_descriptorSetLayout->getDescriptorSetLayout()
+    const std::array<VkDescriptorSetLayout, 2> descriptorSetLayouts = {
+        m_descriptorSetLayout->getDescriptorSetLayout(),
+        transforms.GetDescriptorSetLayout().getDescriptorSetLayout()
     };
 
     m_descriptorSets.resize(framesInFlight);
@@ -64,8 +69,6 @@ void vov::DepthPrePass::Init(VkFormat depthFormat, uint32_t framesInFlight) {
     pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(descriptorSetLayouts.size());
     pipelineLayoutInfo.pSetLayouts = descriptorSetLayouts.data();
 
-    pipelineLayoutInfo.pushConstantRangeCount = 1;
-    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
     if (vkCreatePipelineLayout(m_device.device(), &pipelineLayoutInfo, nullptr, &m_pipelineLayout) !=
         VK_SUCCESS) {
         throw std::runtime_error("failed to create pipeline layout!");
@@ -90,7 +93,7 @@ void vov::DepthPrePass::Init(VkFormat depthFormat, uint32_t framesInFlight) {
 
 }
 
-void vov::DepthPrePass::Record(const FrameContext& context, Image& depthImage) {
+void vov::DepthPrePass::BeginRendering(const FrameContext& context, Image& depthImage, bool clearDepth, VkRenderingFlags flags) {
     const uint32_t imageIndex = context.frameIndex;
     const auto commandBuffer = context.commandBuffer;
 
@@ -101,19 +104,18 @@ void vov::DepthPrePass::Record(const FrameContext& context, Image& depthImage) {
 
     m_uniformBuffer.update(imageIndex, ubo);
 
-    depthImage.TransitionImageLayout(commandBuffer, VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT);
-
     VkRenderingAttachmentInfo depthAttachment{};
     depthAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
     depthAttachment.imageView = depthImage.GetImageView();
-    depthAttachment.imageLayout = depthImage.GetCurrentLayout(); //God this bad
-    depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+    depthAttachment.imageLayout = depthImage.GetCurrentLayout();
+    depthAttachment.loadOp = clearDepth ? VK_ATTACHMENT_LOAD_OP_CLEAR : VK_ATTACHMENT_LOAD_OP_LOAD;
     depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
     depthAttachment.clearValue.depthStencil = { .depth = 1.0f, .stencil = 0 };
 
     // Render Info
     VkRenderingInfo renderingInfo{};
     renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
+    renderingInfo.flags = flags;
     renderingInfo.renderArea = VkRect2D{ VkOffset2D{0, 0}, depthImage.GetExtent() };
     renderingInfo.layerCount = 1;
     renderingInfo.pDepthAttachment = &depthAttachment;
@@ -125,12 +127,14 @@ void vov::DepthPrePass::Record(const FrameContext& context, Image& depthImage) {
     );
 
     vkCmdBeginRendering(commandBuffer, &renderingInfo);
+}
 
+void vov::DepthPrePass::SetDrawState(VkCommandBuffer commandBuffer, uint32_t frameIndex, VkExtent2D extent) const {
     VkViewport viewport{};
     viewport.x = 0.0f;
     viewport.y = 0.0f;
-    viewport.width = static_cast<float>(depthImage.GetExtent().width);
-    viewport.height = static_cast<float>(depthImage.GetExtent().height);
+    viewport.width = static_cast<float>(extent.width);
+    viewport.height = static_cast<float>(extent.height);
     viewport.minDepth = 0.0f;
     viewport.maxDepth = 1.0f;
     DebugLabel::BeginCmdLabel(commandBuffer, "Viewport and scissor", {0.0f, 1.0f, 0.0f, 1.0f});
@@ -138,39 +142,127 @@ void vov::DepthPrePass::Record(const FrameContext& context, Image& depthImage) {
 
     VkRect2D scissor{};
     scissor.offset = { 0, 0 };
-    scissor.extent = depthImage.GetExtent();
+    scissor.extent = extent;
     vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
     DebugLabel::EndCmdLabel(commandBuffer);
 
-    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout, 0, 1, &m_descriptorSets[imageIndex], 0, nullptr);
-
-    m_pipeline->bind(commandBuffer);
+    const std::array descriptorSets = {m_descriptorSets[frameIndex], m_transforms->GetDescriptorSet(frameIndex)};
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout, 0, static_cast<uint32_t>(descriptorSets.size()), descriptorSets.data(), 0, nullptr);
+}
 
-    for (const auto& object : context.currentScene.getGameObjects()) {
-        for (const auto& mesh : object->model->getMeshes()) {
-            PushConstant push{};
-            push.model = mesh->getTransform().GetWorldMatrix();
+void vov::DepthPrePass::EndRendering(VkCommandBuffer commandBuffer) {
+    vkCmdEndRendering(commandBuffer);
+    DebugLabel::EndCmdLabel(commandBuffer);
+}
 
-            vkCmdPushConstants(
-                commandBuffer,
-                m_pipelineLayout,
-                VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
-                0,
-                sizeof(PushConstant),
-                &push
-            );
+void vov::DepthPrePass::Record(const FrameContext& context, Image& depthImage, const IndirectDraws& draws, bool clearDepth) {
+    const auto commandBuffer = context.commandBuffer;
 
-            mesh->bind(commandBuffer);
-            mesh->draw(commandBuffer);
+    const glm::mat4 view = context.camera.GetViewMatrix();
+    m_renderQueue.Clear();
+    if (draws.buffer != VK_NULL_HANDLE) {
+        // GPU culling decides for itself, the geometry pass draws the same list with EQUAL
+        m_drawnAll = true;
+        for (size_t i = 0; i < context.visibleMeshes.size(); ++i) {
+            Mesh* mesh = context.visibleMeshes[i];
+            m_renderQueue.Push(*m_pipeline, m_pipelineLayout, *mesh, RenderQueue::ViewDepth(view, context.worldMatrices[mesh->GetSceneIndex()], *mesh), VK_NULL_HANDLE, {draws.buffer, draws.GetOffset(i)});
+        }
+    } else {
+        SelectOccluders(context);
+        for (Mesh* mesh : m_occluders) {
+            m_renderQueue.Push(*m_pipeline, m_pipelineLayout, *mesh, RenderQueue::ViewDepth(view, context.worldMatrices[mesh->GetSceneIndex()], *mesh));
         }
     }
+    m_renderQueue.Sort();
 
-    vkCmdEndRendering(commandBuffer);
+    BeginRendering(context, depthImage, clearDepth, m_renderQueue.GetRenderingFlags(context.recorder));
+    const VkExtent2D extent = depthImage.GetExtent();
+    m_renderQueue.Record(commandBuffer, context.recorder, context.frameIndex, {{}, m_depthFormat}, [&] (VkCommandBuffer drawCommandBuffer) {
+        SetDrawState(drawCommandBuffer, context.frameIndex, extent);
+    });
 
-    depthImage.TransitionImageLayout(commandBuffer, VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL, VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
-    DebugLabel::EndCmdLabel(commandBuffer);
+    EndRendering(commandBuffer);
+}
+
+void vov::DepthPrePass::RecordIndirect(const FrameContext& context, Image& depthImage, const SceneGeometry& geometry, const IndirectDrawList& drawList) {
+    const auto commandBuffer = context.commandBuffer;
+
+    m_drawnAll = true;
+
+    BeginRendering(context, depthImage, true, 0);
+    SetDrawState(commandBuffer, context.frameIndex, depthImage.GetExtent());
+
+    if (drawList.maxDraws > 0) {
+        m_pipeline->bind(commandBuffer);
+        geometry.Bind(commandBuffer);
+        vkCmdDrawIndexedIndirectCount(commandBuffer, drawList.commands, 0, drawList.count, drawList.countOffset, drawList.maxDraws, sizeof(VkDrawIndexedIndirectCommand));
+    }
+
+    EndRendering(commandBuffer);
 }
 
 void vov::DepthPrePass::Resize(VkExtent2D newSize) {
     //Swapchain handles
 }
+
+void vov::DepthPrePass::SelectOccluders(const FrameContext& context) {
+    const OccluderSettings& settings = m_occluderSettings;
+    const glm::mat4 view = context.camera.GetViewMatrix();
+    const glm::mat4 projection = context.camera.GetProjectionMatrix();
+
+    m_occluders.clear();
+    m_occluderStats = {};
+    m_occluderStats.visible = static_cast<uint32_t>(context.visibleMeshes.size());
+
+    for (Mesh* mesh : context.visibleMeshes) {
+        const uint32_t triangles = mesh->GetDrawCount() / 3;
+        m_occluderStats.visibleTriangles += triangles;
+
+        const AABB bounds = TransformAABB(mesh->GetBoundingBox(), context.worldMatrices[mesh->GetSceneIndex()]);
+        const float radius = glm::length(bounds.max - bounds.min) * 0.5f;
+        const float depth = -(view * glm::vec4(bounds.GetCenter(), 1.f)).z;
+
+        // Bounding sphere projected to an ellipse, NDC is 2x2
+        float coverage = 1.f;
+        if (depth > radius) {
+            const float radiusX = radius * projection[0][0] / depth;
+            const float radiusY = radius * projection[1][1] / depth;
+            coverage = std::min(1.f, glm::pi<float>() * radiusX * radiusY / 4.f);
+        }
+
+        if (settings.selectOccluders && (coverage < settings.minScreenCoverage || triangles > settings.maxTriangles)) {
+            continue;
+        }
+
+        m_occluders.push_back(mesh);
+        m_occluderStats.occluders++;
+        m_occluderStats.occluderTriangles += triangles;
+        m_occluderStats.coverage += coverage;
+    }
+
+    // Not paying for itself: the occluders hide too little, or drawing them is most of the geometry pass anyway
+    const float triangleRatio = m_occluderStats.visibleTriangles > 0
+        ? static_cast<float>(m_occluderStats.occluderTriangles) / static_cast<float>(m_occluderStats.visibleTriangles)
+        : 0.f;
+    m_smoothedCoverage += (m_occluderStats.coverage - m_smoothedCoverage) * SMOOTHING;
+    m_smoothedTriangleRatio += (triangleRatio - m_smoothedTriangleRatio) * SMOOTHING;
+
+    if (!settings.autoDisable) {
+        m_active = true;
+    } else if (m_active) {
+        m_active = m_smoothedCoverage >= settings.minTotalCoverage && m_smoothedTriangleRatio <= settings.maxTriangleRatio;
+    } else {
+        m_active = m_smoothedCoverage >= settings.minTotalCoverage * HYSTERESIS && m_smoothedTriangleRatio * HYSTERESIS <= settings.maxTriangleRatio;
+    }
+    m_occluderStats.active = m_active;
+
+    if (!m_active) {
+        m_occluders.clear();
+    }
+
+    m_drawnMask.assign(context.worldMatrices.size(), false);
+    for (const Mesh* mesh : m_occluders) {
+        m_drawnMask[mesh->GetSceneIndex()] = true;
+    }
+    m_drawnAll = m_occluders.size() == context.visibleMeshes.size();
+}
@@ -5,7 +5,11 @@
 
 #include <glm/glm.hpp>
 
+#include "GpuCullPass.h"
+#include "IndirectCullPass.h"
+#include "Rendering/RenderQueue.h"
 #include "Resources/Image.h"
+#include "Resources/TransformBuffer.h"
 #include "Resources/UniformBuffer.h"
 #include "Scene/Scene.h"
 #include "Utils/FrameContext.h"
@@ -14,29 +18,67 @@ namespace vov {
     class DepthPrePass final {
     public:
 
+        // What goes into the pre pass when it isn't fed by GPU culling
+        struct OccluderSettings {
+            bool selectOccluders{true};        // Off draws every visible mesh
+            float minScreenCoverage{0.01f};    // Fraction of the screen a mesh's bounds need to cover
+            uint32_t maxTriangles{100000};     // Denser meshes cost more in the pre pass than they save
+            bool autoDisable{true};
+            float minTotalCoverage{0.3f};      // Summed occluder coverage below which the pass is skipped
+            float maxTriangleRatio{0.5f};      // Occluder triangles / visible triangles above which the pass is skipped
+        };
+
+        struct OccluderStats {
+            uint32_t visible{0};
+            uint32_t occluders{0};
+            uint32_t visibleTriangles{0};
+            uint32_t occluderTriangles{0};
+            float coverage{0.f};
+            bool active{true};
+        };
+
         explicit DepthPrePass(Device& deviceRef) : m_device{deviceRef}, m_uniformBuffer{deviceRef} {}
         ~DepthPrePass();
 
-        void Init(VkFormat depthFormat, uint32_t framesInFlight);
-        void Record(const FrameContext& context, Image& depthImage);
+        void Init(VkFormat depthFormat, uint32_t framesInFlight, const TransformBuffer& transforms);
+        // With draws set every visible mesh gets drawn, with the GPU written arguments.
+        // Without, only the selected occluders of the visible meshes, front to back.
+        // clearDepth false keeps what an earlier run left in the depth image.
+        void Record(const FrameContext& context, Image& depthImage, const IndirectDraws& draws = {}, bool clearDepth = true);
+
+        // Whole scene in one vkCmdDrawIndexedIndirectCount, the draw list comes from IndirectCullPass
+        void RecordIndirect(const FrameContext& context, Image& depthImage, const SceneGeometry& geometry, const IndirectDrawList& drawList);
 
         void Resize(VkExtent2D newSize);
 
+        // Of the last Record, with HiZ culling that is phase two
+        [[nodiscard]] const RenderQueue::Stats& GetQueueStats() const { return m_renderQueue.GetStats(); }
+
+        // Indexed by Mesh::GetSceneIndex, which meshes have their depth in the depth image.
+        // Null when every visible mesh has, the geometry pass can then depth test with EQUAL everywhere.
+        [[nodiscard]] const std::vector<bool>* GetDrawnMask() const { return m_drawnAll ? nullptr : &m_drawnMask; }
+
+        [[nodiscard]] OccluderSettings& GetOccluderSettings() { return m_occluderSettings; }
+        [[nodiscard]] const OccluderStats& GetOccluderStats() const { return m_occluderStats; }
+
         struct alignas(16) UniformBufferData
         {
             glm::mat4 view;
             glm::mat4 proj;
         };
-        struct PushConstant
-        {
-            glm::mat4 model;
-            int objectId;
-        };
 
     private:
+        void BeginRendering(const FrameContext& context, Image& depthImage, bool clearDepth, VkRenderingFlags flags);
+        // Viewport, scissor and sets 0 and 1, once on the primary or on every secondary
+        void SetDrawState(VkCommandBuffer commandBuffer, uint32_t frameIndex, VkExtent2D extent) const;
+        void EndRendering(VkCommandBuffer commandBuffer);
+        // Fills m_occluders and m_drawnMask from the visible meshes
+        void SelectOccluders(const FrameContext& context);
+
         Device& m_device;
         VkFormat m_depthFormat{VK_FORMAT_UNDEFINED};
         uint32_t m_framesInFlight{1};
+        const TransformBuffer* m_transforms{nullptr};
 
         std::unique_ptr<DescriptorPool> m_descriptorPool;
 
@@ -48,6 +90,19 @@ namespace vov {
         UniformBuffer<UniformBufferData> m_uniformBuffer;
 
         std::vector<VkDescriptorSet> m_descriptorSets{};
+
+        // Front to back, there is no material to group by
+        RenderQueue m_renderQueue{RenderQueue::Order::DEPTH_FIRST};
+
+        OccluderSettings m_occluderSettings{};
+        OccluderStats m_occluderStats{};
+        float m_smoothedCoverage{1.f};
+        float m_smoothedTriangleRatio{0.f};
+        bool m_active{true};
+
+        std::vector<Mesh*> m_occluders{};
+        std::vector<bool> m_drawnMask{};
+        bool m_drawnAll{true};
     };
 }
 
@@ -1,65 +1,51 @@
 #include "GeometryPass.h"
 
 #include <array>
+#include <bit>
 
-#include "BlitPass.h"
-#include "BlitPass.h"
-#include "BlitPass.h"
 #include "BlitPass.h"
 #include "Descriptors/DescriptorSetLayout.h"
 #include "Descriptors/DescriptorWriter.h"
+#include "Resources/MaterialTable.h"
 #include "Utils/DebugLabel.h"
 #include "Utils/ResourceManager.h"
 
-vov::GeometryPass::GeometryPass(vov::Device& deviceRef, const CreateInfo& createInfo): m_device{deviceRef}, m_uniformBuffer{deviceRef} {
-    m_geoBuffers.resize(createInfo.maxFrames);
-    for (auto & buffer : m_geoBuffers) {
-        buffer = std::make_unique<GeoBuffer>(deviceRef, createInfo.size);
-    }
+vov::GeometryPass::GeometryPass(vov::Device& deviceRef, const CreateInfo& createInfo): m_device{deviceRef}, m_transforms{createInfo.pTransforms}, m_uniformBuffer{deviceRef} {
+    m_geoBuffer = std::make_unique<GeoBuffer>(deviceRef, *createInfo.pGraph);
+    m_depthFormat = createInfo.depthFormat;
 
     m_uniformBuffer.SetName("GeometryPass Uniform Buffer");
 
     m_descriptorPool = DescriptorPool::Builder(m_device)
-            .setMaxSets(createInfo.maxFrames * 3)
-            .addPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, createInfo.maxFrames * 2)
-            .addPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 5)
-            .addPoolSize(VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 5)
-            .addPoolSize(VK_DESCRIPTOR_TYPE_SAMPLER, 5)
+            .setMaxSets(createInfo.maxFrames)
+            .addPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, createInfo.maxFrames)
+            .addPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, createInfo.maxFrames)
             .build();
 
     DebugLabel::SetObjectName(reinterpret_cast<uint64_t>(m_descriptorPool->GetHandle()), VK_OBJECT_TYPE_DESCRIPTOR_POOL, "GeometryPass Descriptor Pool");
 
     m_descriptorSetLayout = DescriptorSetLayout::Builder(m_device)
         .addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_VERTEX_BIT)
+        .addBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_VERTEX_BIT)
         .build();
 
-    //TODO: make it so this is like more global ish since i now manually match the models / mesh defintion
-    m_textureSetLayout = DescriptorSetLayout::Builder(m_device)
-            .addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT)
-            .addBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT) // Albedo
-            .addBinding(2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT) // Normal
-            .addBinding(3, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT) // Specular / metalic
-            .addBinding(4, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT) // Bump
-            .build();
-
-    VkPushConstantRange pushConstantRange{};
-    pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
-    pushConstantRange.offset = 0;
-    pushConstantRange.size = sizeof(PushConstant);
-
-    const std::array<VkDescriptorSetLayout, 2> descriptorSetLayouts = {
+    const std::array<VkDescriptorSetLayout, 3> descriptorSetLayouts = {
         m_descriptorSetLayout->getDescriptorSetLayout(),
-        m_textureSetLayout->getDescriptorSetLayout()
+        MaterialTable::GetInstance().GetSetLayout().getDescriptorSetLayout(),
+        m_transforms->GetDescriptorSetLayout().getDescriptorSetLayout()
     };
 
     m_descriptorSets.resize(createInfo.maxFrames);
+    m_materialIndices.resize(createInfo.maxFrames);
+    m_materialIndexCapacities.resize(createInfo.maxFrames, 0);
 
     for (size_t i{0}; i < createInfo.maxFrames; i++) {
         m_descriptorPool->allocateDescriptor(m_descriptorSetLayout->getDescriptorSetLayout(), m_descriptorSets[i]);
         auto bufferInfo = m_uniformBuffer.getDescriptorBufferInfo(i);
         DescriptorWriter(*m_descriptorSetLayout, *m_descriptorPool)
             .writeBuffer(0, &bufferInfo)
-            .build(m_descriptorSets[i]);
+            .overwrite(m_descriptorSets[i]);
+        EnsureMaterialIndexCapacity(static_cast<uint32_t>(i), 1024);
     }
 
     VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
@@ -67,8 +53,6 @@ vov::GeometryPass::GeometryPass(vov::Device& deviceRef, const CreateInfo& create
     pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(descriptorSetLayouts.size());
     pipelineLayoutInfo.pSetLayouts = descriptorSetLayouts.data();
 
-    pipelineLayoutInfo.pushConstantRangeCount = 1;
-    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
     if (vkCreatePipelineLayout(m_device.device(), &pipelineLayoutInfo, nullptr, &m_pipelineLayout) !=
         VK_SUCCESS) {
         throw std::runtime_error("failed to create pipeline layout!");
@@ -81,14 +65,16 @@ vov::GeometryPass::GeometryPass(vov::Device& deviceRef, const CreateInfo& create
 
     pipelineConfig.pipelineLayout = m_pipelineLayout;
 
-    pipelineConfig.colorAttachments = m_geoBuffers[0]->GetFormats();
+    pipelineConfig.colorAttachments = m_geoBuffer->GetFormats();
     pipelineConfig.depthAttachment = m_depthFormat;
+    m_inheritance = {pipelineConfig.colorAttachments, m_depthFormat};
+    m_inheritanceWithoutSelection = m_inheritance;
+    m_inheritanceWithoutSelection.colorFormats.back() = VK_FORMAT_UNDEFINED;
     //TODO: fix this to not be static
-    uint32_t gBufferAttachmentCount = 5;
+    uint32_t gBufferAttachmentCount = 4;
 
     VkPipelineColorBlendAttachmentState colorBlendAttachment = pipelineConfig.colorBlendAttachment;
-    std::array<VkPipelineColorBlendAttachmentState, 5> colorBlendAttachments = {
-        colorBlendAttachment,
+    std::array<VkPipelineColorBlendAttachmentState, 4> colorBlendAttachments = {
         colorBlendAttachment,
         colorBlendAttachment,
         colorBlendAttachment,
@@ -103,22 +89,40 @@ vov::GeometryPass::GeometryPass(vov::Device& deviceRef, const CreateInfo& create
     pipelineConfig.colorBlendInfo.attachmentCount = gBufferAttachmentCount;
     pipelineConfig.colorBlendInfo.pAttachments = colorBlendAttachments.data();
 
-    pipelineConfig.depthAttachment = VK_FORMAT_D32_SFLOAT;
 
+    m_pipelines = std::make_unique<PipelinePermutations>(
+        m_device,
+        "shaders/deferred.vert.spv",
+        "shaders/deferred.frag.spv",
+        pipelineConfig,
+        Mesh::MATERIAL_FLAG_COUNT
+    );
+
+    // Meshes the depth pre pass left out write their own depth
+    pipelineConfig.name = "Geometry Pass Depth Write Pipeline";
+    pipelineConfig.depthStencilInfo.depthWriteEnable = VK_TRUE;
+    pipelineConfig.depthStencilInfo.depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
 
-    m_pipeline = std::make_unique<Pipeline>(
+    m_depthWritePipelines = std::make_unique<PipelinePermutations>(
         m_device,
         "shaders/deferred.vert.spv",
         "shaders/deferred.frag.spv",
-        pipelineConfig
+        pipelineConfig,
+        Mesh::MATERIAL_FLAG_COUNT
     );
+
+    // Untextured meshes and the full set are the common ones, the rest compile when a mesh first needs them
+    for (const uint32_t flags : {0u, Mesh::MATERIAL_HAS_ALBEDO | Mesh::MATERIAL_HAS_NORMAL | Mesh::MATERIAL_HAS_SPECULAR}) {
+        (void)m_pipelines->Get(flags);
+        (void)m_depthWritePipelines->Get(flags);
+    }
 }
 
 vov::GeometryPass::~GeometryPass() {
     vkDestroyPipelineLayout(m_device.device(), m_pipelineLayout, nullptr);
 }
 
-void vov::GeometryPass::Record(const FrameContext& context, const Image& depthImage) {
+void vov::GeometryPass::Record(const FrameContext& context, const Image& depthImage, const IndirectDraws& draws, const std::vector<bool>* prepassMask) {
     const uint32_t imageIndex = context.frameIndex;
     const auto commandBuffer = context.commandBuffer;
 
@@ -129,10 +133,15 @@ void vov::GeometryPass::Record(const FrameContext& context, const Image& depthIm
 
     m_uniformBuffer.update(imageIndex, ubo);
 
-    m_geoBuffers[imageIndex]->TransitionWriting(commandBuffer);
+    // Only the visible meshes are drawn, the rest of the entries can be stale
+    EnsureMaterialIndexCapacity(imageIndex, static_cast<uint32_t>(context.worldMatrices.size()));
+    auto* materialIndices = static_cast<uint32_t*>(m_materialIndices[imageIndex]->GetRawData());
+    for (const Mesh* mesh : context.visibleMeshes) {
+        materialIndices[mesh->GetSceneIndex()] = mesh->GetMaterialIndex();
+    }
+    m_materialIndices[imageIndex]->flush();
 
-    const auto& gBufferAttachments = m_geoBuffers[imageIndex]->GetRenderingAttachments();
-    const uint32_t gBufferAttachmentCount = m_geoBuffers[imageIndex]->GetRenderAttachmentCount();
+    const auto gBufferAttachments = m_geoBuffer->GetRenderingAttachments();
     VkRenderingAttachmentInfo depthAttachment{};
     depthAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
     depthAttachment.imageView = depthImage.GetImageView();
@@ -142,19 +151,44 @@ void vov::GeometryPass::Record(const FrameContext& context, const Image& depthIm
     depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
 
     // Render Info
-    const VkExtent2D extent = m_geoBuffers[imageIndex]->GetExtent();
+    const VkExtent2D extent = m_geoBuffer->GetExtent();
     VkRenderingInfo renderingInfo{};
     renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
     renderingInfo.renderArea = VkRect2D{ VkOffset2D{0, 0}, extent };
     renderingInfo.layerCount = 1;
-    renderingInfo.colorAttachmentCount = gBufferAttachmentCount;
+    renderingInfo.colorAttachmentCount = static_cast<uint32_t>(gBufferAttachments.size());
     renderingInfo.pColorAttachments = gBufferAttachments.data();
     renderingInfo.pDepthAttachment = &depthAttachment;
     renderingInfo.pStencilAttachment = nullptr;
 
+    const glm::mat4 view = context.camera.GetViewMatrix();
+    m_renderQueue.Clear();
+    for (size_t i = 0; i < context.visibleMeshes.size(); ++i) {
+        Mesh* mesh = context.visibleMeshes[i];
+
+        RenderQueue::IndirectArgs indirect{};
+        if (draws.buffer != VK_NULL_HANDLE) {
+            indirect = {draws.buffer, draws.GetOffset(i)};
+        }
+        const bool hasDepth = prepassMask == nullptr || (*prepassMask)[mesh->GetSceneIndex()];
+        const Pipeline& pipeline = (hasDepth ? m_pipelines : m_depthWritePipelines)->Get(mesh->GetMaterialFlags());
+        m_renderQueue.Push(pipeline, m_pipelineLayout, *mesh, RenderQueue::ViewDepth(view, context.worldMatrices[mesh->GetSceneIndex()], *mesh), VK_NULL_HANDLE, indirect);
+    }
+    m_renderQueue.Sort();
+    renderingInfo.flags = m_renderQueue.GetRenderingFlags(context.recorder);
+
     DebugLabel::BeginCmdLabel(commandBuffer, "Geometrypass", glm::vec4{1.f, 0, 0 ,1.f});
     vkCmdBeginRendering(commandBuffer, &renderingInfo);
 
+    m_renderQueue.Record(commandBuffer, context.recorder, imageIndex, m_selectionEnabled ? m_inheritance : m_inheritanceWithoutSelection, [&] (VkCommandBuffer drawCommandBuffer) {
+        SetDrawState(drawCommandBuffer, imageIndex, extent);
+    });
+
+    vkCmdEndRendering(commandBuffer);
+    DebugLabel::EndCmdLabel(commandBuffer);
+}
+
+void vov::GeometryPass::SetDrawState(VkCommandBuffer commandBuffer, uint32_t frameIndex, VkExtent2D extent) const {
     VkViewport viewport;
     viewport.x = 0.0f;
     viewport.y = 0.0f;
@@ -169,50 +203,27 @@ void vov::GeometryPass::Record(const FrameContext& context, const Image& depthIm
     scissor.extent = extent;
     vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
 
-    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout, 0, 1, &m_descriptorSets[imageIndex], 0, nullptr);
-
-    m_pipeline->bind(commandBuffer);
-
-    for (const auto& object : context.currentScene.getGameObjects()) {
-        if (context.camera.GetFrustum().isBoxVisible(object->model->GetBoundingBox())) {
-            for (const auto& mesh : object->model->getMeshes()) {
-                PushConstant push{};
-                push.model = mesh->getTransform().GetWorldMatrix();
-                vkCmdPushConstants(
-                    commandBuffer,
-                    m_pipelineLayout,
-                    VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
-                    0,
-                    sizeof(PushConstant),
-                    &push
-                );
-
-                auto meshDescriptorSet = mesh->getDescriptorSet();
-
-                vkCmdBindDescriptorSets(
-                    commandBuffer,
-                    VK_PIPELINE_BIND_POINT_GRAPHICS,
-                    m_pipelineLayout,
-                    1, // Texture set
-                    1, &meshDescriptorSet,
-                    0, nullptr
-                );
-
-                mesh->bind(commandBuffer);
-                mesh->draw(commandBuffer);
-
-            }
-        }
-    }
-
-    vkCmdEndRendering(commandBuffer);
-    DebugLabel::EndCmdLabel(commandBuffer);
-
-    m_geoBuffers[imageIndex]->TransitionSampling(commandBuffer);
+    const std::array<VkDescriptorSet, 3> sets = {
+        m_descriptorSets[frameIndex],
+        MaterialTable::GetInstance().GetDescriptorSet(),
+        m_transforms->GetDescriptorSet(frameIndex)
+    };
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout, 0, static_cast<uint32_t>(sets.size()), sets.data(), 0, nullptr);
 }
 
-void vov::GeometryPass::Resize(VkExtent2D newSize) const {
-    for (auto & buffer : m_geoBuffers) {
-        buffer->Resize(newSize);
+void vov::GeometryPass::EnsureMaterialIndexCapacity(uint32_t frameIndex, uint32_t meshCount) {
+    if (meshCount <= m_materialIndexCapacities[frameIndex]) {
+        return;
     }
+
+    m_materialIndexCapacities[frameIndex] = std::bit_ceil(meshCount);
+    auto& buffer = m_materialIndices[frameIndex];
+    buffer = std::make_unique<Buffer>(m_device, sizeof(uint32_t) * m_materialIndexCapacities[frameIndex], VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU, true);
+    buffer->map();
+    buffer->SetName("Material Indices " + std::to_string(frameIndex));
+
+    const auto bufferInfo = buffer->descriptorInfo();
+    DescriptorWriter(*m_descriptorSetLayout, *m_descriptorPool)
+        .writeBuffer(1, &bufferInfo)
+        .overwrite(m_descriptorSets[frameIndex]);
 }
@@ -1,7 +1,11 @@
 #ifndef GEOMETRYPASS_H
 #define GEOMETRYPASS_H
 #include "Core/Device.h"
+#include "GpuCullPass.h"
+#include "Rendering/PipelinePermutations.h"
+#include "Rendering/RenderQueue.h"
 #include "Resources/GeoBuffer.h"
+#include "Resources/TransformBuffer.h"
 #include "Resources/UniformBuffer.h"
 #include "Scene/Scene.h"
 
@@ -11,8 +15,9 @@ namespace vov {
         struct CreateInfo {
             int maxFrames{};
             Scene* pScene{};
-            VkExtent2D size{};
+            RenderGraph* pGraph{};
             VkFormat depthFormat{};
+            const TransformBuffer* pTransforms{};
         };
 
         struct alignas(16) UniformBufferData {
@@ -20,45 +25,71 @@ namespace vov {
             glm::mat4 proj;
         };
 
-        struct PushConstant {
-            glm::mat4 model;
-            uint32_t objectId;
-        };
-
         explicit GeometryPass(Device& deviceRef, const CreateInfo& createInfo);
         ~GeometryPass();
 
-        void Record(const FrameContext& context, const Image& depthImage);
+        // Creates this frame's G-buffer as the pass's attachments
+        void Declare(RenderGraph::PassBuilder& pass) { m_geoBuffer->Declare(pass, m_selectionEnabled); }
+        // For the lighting pass
+        void DeclareSampling(RenderGraph::PassBuilder& pass) const { m_geoBuffer->DeclareSampling(pass); }
+
+        // draws comes from GpuCullPass, without it every visible mesh gets a regular draw.
+        // prepassMask is DepthPrePass::GetDrawnMask, meshes outside it depth test with LESS_OR_EQUAL and write depth.
+        void Record(const FrameContext& context, const Image& depthImage, const IndirectDraws& draws = {}, const std::vector<bool>* prepassMask = nullptr);
 
-        void Resize(VkExtent2D newSize) const;
+        [[nodiscard]] const RenderQueue::Stats& GetQueueStats() const { return m_renderQueue.GetStats(); }
 
-        [[nodiscard]] Image& GetAlbedo(uint32_t imageIndex) const { return m_geoBuffers[imageIndex]->GetAlbedo(); }
-        [[nodiscard]] Image& GetNormal(uint32_t imageIndex) const { return m_geoBuffers[imageIndex]->GetNormal(); }
-        [[nodiscard]] Image& GetSpecualar(uint32_t imageIndex) const { return m_geoBuffers[imageIndex]->GetSpecular(); }
-        [[nodiscard]] Image& GetWorldPos(uint32_t imageIndex) const { return m_geoBuffers[imageIndex]->GetWorldPos(); }
+        // Only valid between this pass and the lighting pass of the frame being recorded
+        [[nodiscard]] Image& GetAlbedo() const { return m_geoBuffer->GetAlbedo(); }
+        [[nodiscard]] Image& GetNormal() const { return m_geoBuffer->GetNormal(); }
+        [[nodiscard]] Image& GetSpecualar() const { return m_geoBuffer->GetSpecular(); }
+        [[nodiscard]] Image& GetSelection() const { return m_geoBuffer->GetSelection(); }
 
-        using PixelCallback = std::function<void(glm::vec3)>;
+        // Mesh IDs for GPU picking, see GeoBuffer. Only frames that pick turn it on, off it costs no bandwidth.
+        // Set before Declare
+        [[nodiscard]] bool IsSelectionEnabled() const { return m_selectionEnabled; }
+        void SetSelectionEnabled(bool enabled) { m_selectionEnabled = enabled; }
+        // After Record, see GeoBuffer::ReadSelectionPixel
+        void ReadSelectionPixel(ReadbackRing& readback, VkCommandBuffer commandBuffer, uint32_t frameIndex, glm::ivec2 pixel, ReadbackRing::Callback callback) const {
+            m_geoBuffer->ReadSelectionPixel(readback, commandBuffer, frameIndex, pixel, std::move(callback));
+        }
 
     private:
+        // Viewport, scissor and all three sets, once on the primary or on every secondary
+        void SetDrawState(VkCommandBuffer commandBuffer, uint32_t frameIndex, VkExtent2D extent) const;
+        // Grows the frame's material index buffer, only after the frame's fence like TransformBuffer
+        void EnsureMaterialIndexCapacity(uint32_t frameIndex, uint32_t meshCount);
+
         Device& m_device;
 
         VkFormat m_depthFormat{VK_FORMAT_UNDEFINED};
         uint32_t m_framesInFlight{1};
+        const TransformBuffer* m_transforms{nullptr};
 
         std::unique_ptr<DescriptorPool> m_descriptorPool{};
 
         std::unique_ptr<DescriptorSetLayout> m_descriptorSetLayout{};
         VkPipelineLayout m_pipelineLayout{VK_NULL_HANDLE};
 
-        std::unique_ptr<Pipeline> m_pipeline{};
+        // Keyed by Mesh::GetMaterialFlags
+        std::unique_ptr<PipelinePermutations> m_pipelines{};
+        std::unique_ptr<PipelinePermutations> m_depthWritePipelines{};
 
         UniformBuffer<UniformBufferData> m_uniformBuffer;
         std::vector<VkDescriptorSet> m_descriptorSets{};
 
-        std::unique_ptr<DescriptorSetLayout> m_textureSetLayout{};
-        VkDescriptorSet m_textureSet{};
+        // MaterialTable index by Mesh::GetSceneIndex, per frame in flight. Set 0 binding 1
+        std::vector<std::unique_ptr<Buffer>> m_materialIndices{};
+        std::vector<uint32_t> m_materialIndexCapacities{};
+
+        std::unique_ptr<GeoBuffer> m_geoBuffer{};
+        // G-buffer formats for secondaries, they don't change on resize. Without selection its attachment is left out
+        SecondaryRecorder::Inheritance m_inheritance{};
+        SecondaryRecorder::Inheritance m_inheritanceWithoutSelection{};
+        bool m_selectionEnabled{false};
 
-        std::vector<std::unique_ptr<GeoBuffer>> m_geoBuffers{};
+        // Materials are bindless, draws only differ in pipeline and geometry
+        RenderQueue m_renderQueue{RenderQueue::Order::STATE_FIRST};
     };
 }
 
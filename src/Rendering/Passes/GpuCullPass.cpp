@@ -0,0 +1,188 @@
+#include "GpuCullPass.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <stdexcept>
+#include <string>
+
+#include "HiZPass.h"
+#include "Descriptors/DescriptorWriter.h"
+#include "Scene/Mesh.h"
+#include "Scene/Scene.h"
+#include "Utils/DebugLabel.h"
+
+vov::GpuCullPass::GpuCullPass(Device& deviceRef, uint32_t framesInFlight): m_device{deviceRef} {
+    m_descriptorPool = DescriptorPool::Builder(m_device)
+        .SetName("GPU Cull Pass Descriptor Pool")
+        .setMaxSets(framesInFlight)
+        .addPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, framesInFlight * 3)
+        .addPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, framesInFlight)
+        .build();
+
+    m_descriptorSetLayout = DescriptorSetLayout::Builder(m_device)
+        .addBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT) // Objects
+        .addBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT) // Draw commands
+        .addBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT) // History
+        .addBinding(3, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT) // HiZ
+        .build();
+
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(PushConstant);
+
+    const std::array descriptorSetLayouts = {
+        m_descriptorSetLayout->getDescriptorSetLayout()
+    };
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(descriptorSetLayouts.size());
+    pipelineLayoutInfo.pSetLayouts = descriptorSetLayouts.data();
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+    if (vkCreatePipelineLayout(m_device.device(), &pipelineLayoutInfo, nullptr, &m_pipelineLayout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create pipeline layout!");
+    }
+
+    m_pipeline = std::make_unique<ComputePipeline>(m_device, "shaders/occlusionCull.comp.spv", m_pipelineLayout, "GPU Cull Pipeline");
+
+    m_frames.resize(framesInFlight);
+    for (uint32_t i = 0; i < framesInFlight; ++i) {
+        m_descriptorPool->allocateDescriptor(m_descriptorSetLayout->getDescriptorSetLayout(), m_frames[i].descriptorSet);
+        EnsureCapacity(m_frames[i], 1024, i);
+    }
+}
+
+vov::GpuCullPass::~GpuCullPass() {
+    m_frames.clear();
+    m_history.reset();
+    m_pipeline.reset();
+    vkDestroyPipelineLayout(m_device.device(), m_pipelineLayout, nullptr);
+    m_descriptorPool.reset();
+    m_descriptorSetLayout.reset();
+}
+
+void vov::GpuCullPass::Prepare(const FrameContext& context) {
+    FrameResources& frame = m_frames[context.frameIndex];
+    const auto objectCount = static_cast<uint32_t>(context.visibleMeshes.size());
+
+    EnsureCapacity(frame, objectCount, context.frameIndex);
+
+    uint32_t meshCount = 0;
+    auto* objects = static_cast<GpuObject*>(frame.objects->GetRawData());
+    for (uint32_t i = 0; i < objectCount; ++i) {
+        Mesh* mesh = context.visibleMeshes[i];
+        const AABB bounds = TransformAABB(mesh->GetBoundingBox(), context.worldMatrices[mesh->GetSceneIndex()]);
+
+        objects[i].boundsMin = glm::vec4(bounds.min, 1.f);
+        objects[i].boundsMax = glm::vec4(bounds.max, 1.f);
+        objects[i].drawCount = mesh->GetDrawCount();
+        objects[i].historyIndex = mesh->GetSceneIndex();
+        objects[i].indexed = mesh->IsIndexed();
+
+        meshCount = std::max(meshCount, mesh->GetSceneIndex() + 1);
+    }
+    frame.objects->flush();
+
+    EnsureHistory(context.commandBuffer, std::max<uint32_t>(meshCount, static_cast<uint32_t>(context.worldMatrices.size())));
+}
+
+void vov::GpuCullPass::RecordPhaseOne(const FrameContext& context, const HiZPass& hiZ) {
+    const FrameResources& frame = m_frames[context.frameIndex];
+
+    const auto objectInfo = frame.objects->descriptorInfo();
+    const auto drawInfo = frame.draws->descriptorInfo();
+    const auto historyInfo = m_history->descriptorInfo();
+    const auto hiZInfo = hiZ.GetDescriptorInfo(context.frameIndex);
+    DescriptorWriter(*m_descriptorSetLayout, *m_descriptorPool)
+        .writeBuffer(0, &objectInfo)
+        .writeBuffer(1, &drawInfo)
+        .writeBuffer(2, &historyInfo)
+        .writeImage(3, &hiZInfo)
+        .overwrite(frame.descriptorSet);
+
+    DebugLabel::BeginCmdLabel(context.commandBuffer, "GPU Cull Phase One", {0.5f, 0.0f, 1.0f, 1.0f});
+
+    // History was last written by the previous frame's phase two
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(context.commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+    Dispatch(context, hiZ, 0);
+
+    DebugLabel::EndCmdLabel(context.commandBuffer);
+}
+
+void vov::GpuCullPass::RecordPhaseTwo(const FrameContext& context, const HiZPass& hiZ) {
+    DebugLabel::BeginCmdLabel(context.commandBuffer, "GPU Cull Phase Two", {0.5f, 0.0f, 1.0f, 1.0f});
+    Dispatch(context, hiZ, 1);
+    DebugLabel::EndCmdLabel(context.commandBuffer);
+}
+
+vov::IndirectDraws vov::GpuCullPass::GetSection(uint32_t frameIndex, uint32_t section) const {
+    const FrameResources& frame = m_frames[frameIndex];
+    return {frame.draws->getBuffer(), static_cast<VkDeviceSize>(section) * frame.capacity * sizeof(VkDrawIndexedIndirectCommand)};
+}
+
+void vov::GpuCullPass::EnsureCapacity(FrameResources& frame, uint32_t objectCount, uint32_t frameIndex) {
+    if (objectCount <= frame.capacity) {
+        return;
+    }
+
+    // Only this frame's fence guards these, which BeginFrame already waited on
+    frame.capacity = std::bit_ceil(objectCount);
+
+    frame.objects = std::make_unique<Buffer>(m_device, sizeof(GpuObject) * frame.capacity, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU, true);
+    frame.objects->map();
+    frame.objects->SetName("GPU Cull Objects " + std::to_string(frameIndex));
+
+    // Phase one, phase two and final draws back to back
+    frame.draws = std::make_unique<Buffer>(m_device, sizeof(VkDrawIndexedIndirectCommand) * frame.capacity * 3, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+    frame.draws->SetName("GPU Cull Draws " + std::to_string(frameIndex));
+}
+
+void vov::GpuCullPass::EnsureHistory(VkCommandBuffer commandBuffer, uint32_t meshCount) {
+    if (meshCount <= m_historyCapacity) {
+        return;
+    }
+
+    // Every frame in flight reads the history, the old one can only go once the GPU is done with all of them.
+    // Only happens when a scene with more meshes gets loaded.
+    if (m_history) {
+        vkDeviceWaitIdle(m_device.device());
+    }
+
+    m_historyCapacity = std::bit_ceil(meshCount);
+    m_history = std::make_unique<Buffer>(m_device, sizeof(uint32_t) * m_historyCapacity, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+    m_history->SetName("GPU Cull History");
+
+    // Start out with everything visible, the first frame then draws all candidates in phase one
+    vkCmdFillBuffer(commandBuffer, m_history->getBuffer(), 0, VK_WHOLE_SIZE, 1);
+}
+
+void vov::GpuCullPass::Dispatch(const FrameContext& context, const HiZPass& hiZ, uint32_t phase) {
+    const auto commandBuffer = context.commandBuffer;
+    const FrameResources& frame = m_frames[context.frameIndex];
+
+    glm::mat4 projection = context.camera.GetProjectionMatrix();
+    projection[1][1] *= -1;
+
+    PushConstant push{};
+    push.viewProjection = projection * context.camera.GetViewMatrix();
+    push.objectCount = static_cast<uint32_t>(context.visibleMeshes.size());
+    push.capacity = frame.capacity;
+    push.phase = phase;
+    push.mipLevels = hiZ.GetMipLevels();
+
+    m_pipeline->bind(commandBuffer);
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipelineLayout, 0, 1, &frame.descriptorSet, 0, nullptr);
+    vkCmdPushConstants(commandBuffer, m_pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstant), &push);
+
+    if (push.objectCount > 0) {
+        vkCmdDispatch(commandBuffer, ComputePipeline::GroupCount(push.objectCount, 64), 1, 1);
+    }
+}
@@ -0,0 +1,102 @@
+#ifndef GPUCULLPASS_H
+#define GPUCULLPASS_H
+
+#include <memory>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Core/Device.h"
+#include "Descriptors/DescriptorPool.h"
+#include "Descriptors/DescriptorSetLayout.h"
+#include "Rendering/ComputePipeline.h"
+#include "Resources/Buffer.h"
+#include "Utils/FrameContext.h"
+
+namespace vov {
+    class HiZPass;
+
+    // Slice of a GPU written draw buffer, slot i holds the VkDrawIndexedIndirectCommand of FrameContext::visibleMeshes[i].
+    // Culled meshes get an instance count of 0.
+    struct IndirectDraws {
+        VkBuffer buffer{VK_NULL_HANDLE};
+        VkDeviceSize offset{0};
+
+        [[nodiscard]] VkDeviceSize GetOffset(size_t slot) const { return offset + slot * sizeof(VkDrawIndexedIndirectCommand); }
+    };
+
+    // Two phase occlusion culling against the HiZ pyramid, fully on the GPU:
+    // phase one draws whatever was visible last frame, that depth builds the pyramid,
+    // phase two tests everything against it and draws the meshes that just became visible.
+    class GpuCullPass final {
+    public:
+        struct GpuObject {
+            glm::vec4 boundsMin;
+            glm::vec4 boundsMax;
+            uint32_t drawCount;    // Index count, or vertex count for meshes without an index buffer
+            uint32_t historyIndex; // Mesh::GetSceneIndex, also the draw's firstInstance
+            uint32_t indexed;
+            uint32_t padding;
+        };
+
+        struct PushConstant {
+            glm::mat4 viewProjection;
+            uint32_t objectCount;
+            uint32_t capacity;
+            uint32_t phase;
+            uint32_t mipLevels;
+        };
+
+        GpuCullPass(Device& deviceRef, uint32_t framesInFlight);
+        ~GpuCullPass();
+
+        GpuCullPass(const GpuCullPass& other) = delete;
+        GpuCullPass(GpuCullPass&& other) noexcept = delete;
+        GpuCullPass& operator=(const GpuCullPass& other) = delete;
+        GpuCullPass& operator=(GpuCullPass&& other) noexcept = delete;
+
+        // Uploads the candidates and grows the draw buffer, before the frame's render graph is built so it can be imported
+        void Prepare(const FrameContext& context);
+        // Writes the phase one draws, the render graph puts the barrier in front of the draws reading them
+        void RecordPhaseOne(const FrameContext& context, const HiZPass& hiZ);
+        // Needs the pyramid built from phase one's depth, writes the phase two and final draws
+        void RecordPhaseTwo(const FrameContext& context, const HiZPass& hiZ);
+
+        [[nodiscard]] IndirectDraws GetPhaseOneDraws(uint32_t frameIndex) const { return GetSection(frameIndex, 0); }
+        [[nodiscard]] IndirectDraws GetPhaseTwoDraws(uint32_t frameIndex) const { return GetSection(frameIndex, 1); }
+        // Everything visible this frame, phase one and two together
+        [[nodiscard]] IndirectDraws GetFinalDraws(uint32_t frameIndex) const { return GetSection(frameIndex, 2); }
+
+        [[nodiscard]] bool IsEnabled() const { return m_enabled; }
+        void SetEnabled(bool enabled) { m_enabled = enabled; }
+
+    private:
+        struct FrameResources {
+            std::unique_ptr<Buffer> objects{};
+            std::unique_ptr<Buffer> draws{};
+            uint32_t capacity{0};
+            VkDescriptorSet descriptorSet{VK_NULL_HANDLE};
+        };
+
+        [[nodiscard]] IndirectDraws GetSection(uint32_t frameIndex, uint32_t section) const;
+        void EnsureCapacity(FrameResources& frame, uint32_t objectCount, uint32_t frameIndex);
+        void EnsureHistory(VkCommandBuffer commandBuffer, uint32_t meshCount);
+        void Dispatch(const FrameContext& context, const HiZPass& hiZ, uint32_t phase);
+
+        Device& m_device;
+        bool m_enabled{true};
+
+        std::unique_ptr<DescriptorPool> m_descriptorPool{};
+        std::unique_ptr<DescriptorSetLayout> m_descriptorSetLayout{};
+        VkPipelineLayout m_pipelineLayout{VK_NULL_HANDLE};
+        std::unique_ptr<ComputePipeline> m_pipeline{};
+
+        std::vector<FrameResources> m_frames{};
+
+        // One uint per scene mesh, was it visible last frame. Shared by all frames in flight.
+        std::unique_ptr<Buffer> m_history{};
+        uint32_t m_historyCapacity{0};
+    };
+}
+
+#endif //GPUCULLPASS_H
@@ -0,0 +1,208 @@
+#include "HiZPass.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <stdexcept>
+#include <string>
+
+#include "Descriptors/DescriptorWriter.h"
+#include "Utils/DebugLabel.h"
+
+vov::HiZPass::HiZPass(Device& deviceRef, uint32_t framesInFlight, VkExtent2D extent): m_device{deviceRef}, m_framesInFlight{framesInFlight}, m_extent{extent} {
+    m_descriptorPool = DescriptorPool::Builder(m_device)
+        .SetName("HiZ Pass Descriptor Pool")
+        .setMaxSets(framesInFlight * MAX_MIP_LEVELS)
+        .addPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, framesInFlight * MAX_MIP_LEVELS)
+        .addPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, framesInFlight * MAX_MIP_LEVELS)
+        .build();
+
+    m_descriptorSetLayout = DescriptorSetLayout::Builder(m_device)
+        .addBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT)
+        .addBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT)
+        .build();
+
+    m_sampler.SetName("HiZ Sampler");
+
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(PushConstant);
+
+    const std::array descriptorSetLayouts = {
+        m_descriptorSetLayout->getDescriptorSetLayout()
+    };
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(descriptorSetLayouts.size());
+    pipelineLayoutInfo.pSetLayouts = descriptorSetLayouts.data();
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+    if (vkCreatePipelineLayout(m_device.device(), &pipelineLayoutInfo, nullptr, &m_pipelineLayout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create pipeline layout!");
+    }
+
+    m_pipeline = std::make_unique<ComputePipeline>(m_device, "shaders/hiZBuild.comp.spv", m_pipelineLayout, "HiZ Build Pipeline");
+
+    CreatePyramids();
+}
+
+vov::HiZPass::~HiZPass() {
+    DestroyPyramids();
+    m_pipeline.reset();
+    vkDestroyPipelineLayout(m_device.device(), m_pipelineLayout, nullptr);
+    m_descriptorPool.reset();
+    m_descriptorSetLayout.reset();
+}
+
+void vov::HiZPass::Record(const FrameContext& context, Image& depthImage) {
+    const auto commandBuffer = context.commandBuffer;
+    Pyramid& pyramid = m_pyramids[context.frameIndex];
+
+    DebugLabel::BeginCmdLabel(commandBuffer, "HiZ Build", {0.5f, 0.0f, 1.0f, 1.0f});
+
+    // The swapchain hands out a different depth image every frame, so mip 0's source gets rewritten each time
+    VkDescriptorImageInfo depthInfo{};
+    depthInfo.sampler = m_sampler.getHandle();
+    depthInfo.imageView = depthImage.GetImageView();
+    depthInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    VkDescriptorImageInfo mip0Info{};
+    mip0Info.imageView = pyramid.mipViews[0]->getHandle();
+    mip0Info.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+    DescriptorWriter(*m_descriptorSetLayout, *m_descriptorPool)
+        .writeImage(0, &depthInfo)
+        .writeImage(1, &mip0Info)
+        .overwrite(pyramid.descriptorSets[0]);
+
+    // Last frame's culling read the pyramid, everything in it gets overwritten
+    VkImageMemoryBarrier pyramidBarrier{};
+    pyramidBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    pyramidBarrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+    pyramidBarrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+    pyramidBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    pyramidBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    pyramidBarrier.image = pyramid.image;
+    pyramidBarrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, m_mipLevels, 0, 1};
+    pyramidBarrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    pyramidBarrier.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &pyramidBarrier);
+
+    m_pipeline->bind(commandBuffer);
+
+    VkExtent2D srcSize = depthImage.GetExtent();
+    for (uint32_t mip = 0; mip < m_mipLevels; ++mip) {
+        const VkExtent2D dstSize = {std::max(1u, m_extent.width >> mip), std::max(1u, m_extent.height >> mip)};
+
+        vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipelineLayout, 0, 1, &pyramid.descriptorSets[mip], 0, nullptr);
+
+        PushConstant push{};
+        push.srcSize = {static_cast<int>(srcSize.width), static_cast<int>(srcSize.height)};
+        push.dstSize = {static_cast<int>(dstSize.width), static_cast<int>(dstSize.height)};
+        vkCmdPushConstants(commandBuffer, m_pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstant), &push);
+
+        vkCmdDispatch(commandBuffer, ComputePipeline::GroupCount(dstSize.width, 8), ComputePipeline::GroupCount(dstSize.height, 8), 1);
+
+        // Next mip reads this one, the culling shader reads all of them
+        VkMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+        srcSize = dstSize;
+    }
+
+    DebugLabel::EndCmdLabel(commandBuffer);
+}
+
+void vov::HiZPass::Resize(VkExtent2D newSize) {
+    // Renderer waits for the device before calling resize callbacks
+    DestroyPyramids();
+    m_extent = newSize;
+    CreatePyramids();
+}
+
+VkDescriptorImageInfo vov::HiZPass::GetDescriptorInfo(uint32_t frameIndex) const {
+    VkDescriptorImageInfo imageInfo{};
+    imageInfo.sampler = m_sampler.getHandle();
+    imageInfo.imageView = m_pyramids[frameIndex].view->getHandle();
+    imageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+    return imageInfo;
+}
+
+void vov::HiZPass::CreatePyramids() {
+    m_mipLevels = std::min<uint32_t>(std::bit_width(std::max(m_extent.width, m_extent.height)), MAX_MIP_LEVELS);
+    m_pyramids.resize(m_framesInFlight);
+
+    for (uint32_t frame = 0; frame < m_framesInFlight; ++frame) {
+        Pyramid& pyramid = m_pyramids[frame];
+
+        VkImageCreateInfo imageInfo{};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.extent.width = m_extent.width;
+        imageInfo.extent.height = m_extent.height;
+        imageInfo.extent.depth = 1;
+        imageInfo.mipLevels = m_mipLevels;
+        imageInfo.arrayLayers = 1;
+        imageInfo.format = FORMAT;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        imageInfo.usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+        imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+        VmaAllocationCreateInfo allocInfo{};
+        allocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+
+        if (vmaCreateImage(m_device.allocator(), &imageInfo, &allocInfo, &pyramid.image, &pyramid.allocation, nullptr) != VK_SUCCESS) {
+            throw std::runtime_error("Failed to create HiZ image!");
+        }
+        DebugLabel::NameImage(pyramid.image, "HiZ Pyramid " + std::to_string(frame));
+
+        pyramid.view = std::make_unique<ImageView>(m_device, pyramid.image, FORMAT, VK_IMAGE_ASPECT_COLOR_BIT, m_mipLevels);
+        pyramid.view->SetName("HiZ Pyramid View " + std::to_string(frame));
+
+        for (uint32_t mip = 0; mip < m_mipLevels; ++mip) {
+            pyramid.mipViews.push_back(std::make_unique<ImageView>(m_device, pyramid.image, FORMAT, VK_IMAGE_ASPECT_COLOR_BIT, 1, mip));
+        }
+
+        // Lives in GENERAL from here on, the build writes it and the culling samples it
+        m_device.TransitionImageLayout(pyramid.image, FORMAT, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL, m_mipLevels);
+
+        pyramid.descriptorSets.resize(m_mipLevels);
+        for (uint32_t mip = 0; mip < m_mipLevels; ++mip) {
+            VkDescriptorImageInfo dstInfo{};
+            dstInfo.imageView = pyramid.mipViews[mip]->getHandle();
+            dstInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+            DescriptorWriter writer(*m_descriptorSetLayout, *m_descriptorPool);
+            writer.writeImage(1, &dstInfo);
+
+            // Mip 0 reads the depth image, which is only known when recording
+            VkDescriptorImageInfo srcInfo{};
+            if (mip > 0) {
+                srcInfo.sampler = m_sampler.getHandle();
+                srcInfo.imageView = pyramid.mipViews[mip - 1]->getHandle();
+                srcInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+                writer.writeImage(0, &srcInfo);
+            }
+
+            if (!writer.build(pyramid.descriptorSets[mip])) {
+                throw std::runtime_error("Failed to allocate HiZ descriptor set!");
+            }
+        }
+    }
+}
+
+void vov::HiZPass::DestroyPyramids() {
+    m_descriptorPool->resetPool();
+
+    for (auto& pyramid : m_pyramids) {
+        pyramid.mipViews.clear();
+        pyramid.view.reset();
+        vmaDestroyImage(m_device.allocator(), pyramid.image, pyramid.allocation);
+    }
+    m_pyramids.clear();
+}
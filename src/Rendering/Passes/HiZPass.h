@@ -0,0 +1,78 @@
+#ifndef HIZPASS_H
+#define HIZPASS_H
+
+#include <memory>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Core/Device.h"
+#include "Descriptors/DescriptorPool.h"
+#include "Descriptors/DescriptorSetLayout.h"
+#include "Rendering/ComputePipeline.h"
+#include "Resources/Image.h"
+#include "Resources/Image/ImageView.h"
+#include "Resources/Image/Sampler.h"
+#include "Utils/FrameContext.h"
+
+namespace vov {
+    // Builds a max depth pyramid from the depth pre pass, every texel holds the furthest depth of the pixels under it.
+    // Mip 0 is the depth buffer itself, odd sizes fold the leftover row/column into the last texel so nothing gets lost.
+    class HiZPass final {
+    public:
+        static constexpr VkFormat FORMAT = VK_FORMAT_R32_SFLOAT;
+        static constexpr uint32_t MAX_MIP_LEVELS = 16;
+
+        struct PushConstant {
+            glm::ivec2 srcSize;
+            glm::ivec2 dstSize;
+        };
+
+        HiZPass(Device& deviceRef, uint32_t framesInFlight, VkExtent2D extent);
+        ~HiZPass();
+
+        HiZPass(const HiZPass& other) = delete;
+        HiZPass(HiZPass&& other) noexcept = delete;
+        HiZPass& operator=(const HiZPass& other) = delete;
+        HiZPass& operator=(HiZPass&& other) noexcept = delete;
+
+        // Samples the depth image as SHADER_READ_ONLY_OPTIMAL, the pass reading it as COMPUTE_SAMPLED lets the render graph
+        // do the transitions around it. Only the pyramid, which the graph doesn't know about, is synchronized in here
+        void Record(const FrameContext& context, Image& depthImage);
+
+        void Resize(VkExtent2D newSize);
+
+        // The whole pyramid, stays in GENERAL
+        [[nodiscard]] VkDescriptorImageInfo GetDescriptorInfo(uint32_t frameIndex) const;
+        [[nodiscard]] VkExtent2D GetExtent() const { return m_extent; }
+        [[nodiscard]] uint32_t GetMipLevels() const { return m_mipLevels; }
+
+    private:
+        struct Pyramid {
+            VkImage image{VK_NULL_HANDLE};
+            VmaAllocation allocation{VK_NULL_HANDLE};
+            std::unique_ptr<ImageView> view{};
+            std::vector<std::unique_ptr<ImageView>> mipViews{};
+            std::vector<VkDescriptorSet> descriptorSets{}; // One per mip, reads the mip above and writes this one
+        };
+
+        void CreatePyramids();
+        void DestroyPyramids();
+
+        Device& m_device;
+        uint32_t m_framesInFlight{};
+        VkExtent2D m_extent{};
+        uint32_t m_mipLevels{1};
+
+        std::unique_ptr<DescriptorPool> m_descriptorPool{};
+        std::unique_ptr<DescriptorSetLayout> m_descriptorSetLayout{};
+        VkPipelineLayout m_pipelineLayout{VK_NULL_HANDLE};
+        std::unique_ptr<ComputePipeline> m_pipeline{};
+
+        Sampler m_sampler{m_device, VK_FILTER_NEAREST, VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, MAX_MIP_LEVELS};
+
+        std::vector<Pyramid> m_pyramids{};
+    };
+}
+
+#endif //HIZPASS_H
@@ -0,0 +1,154 @@
+#include "IndirectCullPass.h"
+
+#include <algorithm>
+#include <bit>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+
+#include "Descriptors/DescriptorWriter.h"
+#include "Scene/Scene.h"
+#include "Utils/DebugLabel.h"
+
+vov::IndirectCullPass::IndirectCullPass(Device& deviceRef, uint32_t framesInFlight, const TransformBuffer& transforms): m_device{deviceRef}, m_transforms{transforms} {
+    m_descriptorPool = DescriptorPool::Builder(m_device)
+        .SetName("Indirect Cull Pass Descriptor Pool")
+        .setMaxSets(framesInFlight * LIST_COUNT)
+        .addPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, framesInFlight * LIST_COUNT * 4)
+        .build();
+
+    m_cullSetLayout = DescriptorSetLayout::Builder(m_device)
+        .addBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT) // Mesh infos
+        .addBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT) // World matrices
+        .addBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT) // Draw counts
+        .addBinding(3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT) // Draw commands
+        .build();
+
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(PushConstant);
+
+    const std::array descriptorSetLayouts = {
+        m_cullSetLayout->getDescriptorSetLayout()
+    };
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(descriptorSetLayouts.size());
+    pipelineLayoutInfo.pSetLayouts = descriptorSetLayouts.data();
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+    if (vkCreatePipelineLayout(m_device.device(), &pipelineLayoutInfo, nullptr, &m_pipelineLayout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create pipeline layout!");
+    }
+
+    m_pipeline = std::make_unique<ComputePipeline>(m_device, "shaders/indirectCull.comp.spv", m_pipelineLayout, "Indirect Cull Pipeline");
+
+    m_frames.resize(framesInFlight);
+    for (uint32_t i = 0; i < framesInFlight; ++i) {
+        FrameResources& frame = m_frames[i];
+        for (auto& list : frame.lists) {
+            m_descriptorPool->allocateDescriptor(m_cullSetLayout->getDescriptorSetLayout(), list.cullSet);
+        }
+
+        frame.counts = std::make_unique<Buffer>(m_device, sizeof(uint32_t) * LIST_COUNT, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+        frame.counts->SetName("Indirect Draw Counts " + std::to_string(i));
+
+        EnsureCapacity(frame, 1024, i);
+    }
+}
+
+vov::IndirectCullPass::~IndirectCullPass() {
+    m_frames.clear();
+    m_pipeline.reset();
+    vkDestroyPipelineLayout(m_device.device(), m_pipelineLayout, nullptr);
+    m_descriptorPool.reset();
+    m_cullSetLayout.reset();
+}
+
+void vov::IndirectCullPass::Prepare(const SceneGeometry& geometry, uint32_t frameIndex) {
+    FrameResources& frame = m_frames[frameIndex];
+
+    frame.meshCount = geometry.GetMeshCount();
+    EnsureCapacity(frame, frame.meshCount, frameIndex);
+}
+
+void vov::IndirectCullPass::Record(const FrameContext& context, const SceneGeometry& geometry) {
+    const auto commandBuffer = context.commandBuffer;
+    const FrameResources& frame = m_frames[context.frameIndex];
+
+    DebugLabel::BeginCmdLabel(commandBuffer, "Indirect Cull", {0.5f, 0.0f, 1.0f, 1.0f});
+
+    vkCmdFillBuffer(commandBuffer, frame.counts->getBuffer(), 0, VK_WHOLE_SIZE, 0);
+
+    VkMemoryBarrier clearBarrier{};
+    clearBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    clearBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    clearBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &clearBarrier, 0, nullptr, 0, nullptr);
+
+    if (frame.meshCount > 0) {
+        const auto meshInfo = geometry.GetMeshInfoDescriptor();
+        const auto worldInfo = m_transforms.GetDescriptorInfo(context.frameIndex);
+        const auto countInfo = frame.counts->descriptorInfo();
+
+        Camera::Frustum shadowFrustum{};
+        auto& light = context.directionalLight;
+        shadowFrustum.update(light.GetProjectionMatrix() * light.GetViewMatrix());
+
+        m_pipeline->bind(commandBuffer);
+
+        for (uint32_t list = 0; list < LIST_COUNT; ++list) {
+            const ListResources& resources = frame.lists[list];
+            const auto commandInfo = resources.commands->descriptorInfo();
+
+            DescriptorWriter(*m_cullSetLayout, *m_descriptorPool)
+                .writeBuffer(0, &meshInfo)
+                .writeBuffer(1, &worldInfo)
+                .writeBuffer(2, &countInfo)
+                .writeBuffer(3, &commandInfo)
+                .overwrite(resources.cullSet);
+
+            const Camera::Frustum& frustum = list == CAMERA_LIST ? context.camera.GetFrustum() : shadowFrustum;
+
+            PushConstant push{};
+            std::copy(std::begin(frustum.planes), std::end(frustum.planes), push.planes);
+            push.meshCount = frame.meshCount;
+            push.list = list;
+
+            vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipelineLayout, 0, 1, &resources.cullSet, 0, nullptr);
+            vkCmdPushConstants(commandBuffer, m_pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstant), &push);
+            vkCmdDispatch(commandBuffer, ComputePipeline::GroupCount(frame.meshCount, 64), 1, 1);
+        }
+    }
+
+    DebugLabel::EndCmdLabel(commandBuffer);
+}
+
+vov::IndirectDrawList vov::IndirectCullPass::GetDrawList(uint32_t frameIndex, List list) const {
+    const FrameResources& frame = m_frames[frameIndex];
+
+    IndirectDrawList drawList{};
+    drawList.commands = frame.lists[list].commands->getBuffer();
+    drawList.count = frame.counts->getBuffer();
+    drawList.countOffset = sizeof(uint32_t) * list;
+    drawList.maxDraws = frame.meshCount;
+    return drawList;
+}
+
+void vov::IndirectCullPass::EnsureCapacity(FrameResources& frame, uint32_t meshCount, uint32_t frameIndex) {
+    if (meshCount <= frame.capacity) {
+        return;
+    }
+
+    // Only this frame's fence guards these, which BeginFrame already waited on
+    frame.capacity = std::bit_ceil(meshCount);
+
+    for (uint32_t list = 0; list < LIST_COUNT; ++list) {
+        ListResources& resources = frame.lists[list];
+
+        resources.commands = std::make_unique<Buffer>(m_device, sizeof(VkDrawIndexedIndirectCommand) * frame.capacity, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+        resources.commands->SetName("Indirect Draw Commands " + std::to_string(frameIndex) + "/" + std::to_string(list));
+    }
+}
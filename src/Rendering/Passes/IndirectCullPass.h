@@ -0,0 +1,95 @@
+#ifndef INDIRECTCULLPASS_H
+#define INDIRECTCULLPASS_H
+
+#include <array>
+#include <memory>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Core/Device.h"
+#include "Descriptors/DescriptorPool.h"
+#include "Descriptors/DescriptorSetLayout.h"
+#include "Rendering/ComputePipeline.h"
+#include "Resources/Buffer.h"
+#include "Resources/SceneGeometry.h"
+#include "Resources/TransformBuffer.h"
+#include "Utils/FrameContext.h"
+
+namespace vov {
+    // Everything a pass needs for one vkCmdDrawIndexedIndirectCount over SceneGeometry
+    struct IndirectDrawList {
+        VkBuffer commands{VK_NULL_HANDLE};
+        VkBuffer count{VK_NULL_HANDLE};
+        VkDeviceSize countOffset{0};
+        uint32_t maxDraws{0};
+    };
+
+    // GPU driven culling for the whole scene: a compute shader frustum tests every mesh of SceneGeometry
+    // and appends the survivors to a draw list per view, the CPU never touches individual meshes.
+    class IndirectCullPass final {
+    public:
+        enum List : uint32_t {
+            CAMERA_LIST = 0,
+            SHADOW_LIST,
+
+            LIST_COUNT
+        };
+
+        struct PushConstant {
+            glm::vec4 planes[6];
+            uint32_t meshCount;
+            uint32_t list;
+        };
+
+        IndirectCullPass(Device& deviceRef, uint32_t framesInFlight, const TransformBuffer& transforms);
+        ~IndirectCullPass();
+
+        IndirectCullPass(const IndirectCullPass& other) = delete;
+        IndirectCullPass(IndirectCullPass&& other) noexcept = delete;
+        IndirectCullPass& operator=(const IndirectCullPass& other) = delete;
+        IndirectCullPass& operator=(IndirectCullPass&& other) noexcept = delete;
+
+        // Grows the draw lists to the scene, before the frame's render graph is built so it can import them
+        void Prepare(const SceneGeometry& geometry, uint32_t frameIndex);
+        // Camera list uses the camera frustum, shadow list the directional light's. The draws reading them get their
+        // barrier from the render graph
+        void Record(const FrameContext& context, const SceneGeometry& geometry);
+
+        // Draws carry the scene index as firstInstance, same as Mesh::draw, so the regular pipelines can draw them
+        [[nodiscard]] IndirectDrawList GetDrawList(uint32_t frameIndex, List list) const;
+
+        // Needs multiDrawIndirect and drawIndirectCount
+        [[nodiscard]] bool IsSupported() const { return m_device.SupportsDrawIndirectCount(); }
+        [[nodiscard]] bool IsEnabled() const { return m_enabled && IsSupported(); }
+        void SetEnabled(bool enabled) { m_enabled = enabled; }
+
+    private:
+        struct ListResources {
+            std::unique_ptr<Buffer> commands{};
+            VkDescriptorSet cullSet{VK_NULL_HANDLE};
+        };
+
+        struct FrameResources {
+            std::unique_ptr<Buffer> counts{};
+            std::array<ListResources, LIST_COUNT> lists{};
+            uint32_t capacity{0};
+            uint32_t meshCount{0};
+        };
+
+        void EnsureCapacity(FrameResources& frame, uint32_t meshCount, uint32_t frameIndex);
+
+        Device& m_device;
+        const TransformBuffer& m_transforms;
+        bool m_enabled{false};
+
+        std::unique_ptr<DescriptorPool> m_descriptorPool{};
+        std::unique_ptr<DescriptorSetLayout> m_cullSetLayout{};
+        VkPipelineLayout m_pipelineLayout{VK_NULL_HANDLE};
+        std::unique_ptr<ComputePipeline> m_pipeline{};
+
+        std::vector<FrameResources> m_frames{};
+    };
+}
+
+#endif //INDIRECTCULLPASS_H
@@ -10,7 +10,7 @@
 #include "Utils/DebugLabel.h"
 #include "Utils/ResourceManager.h"
 
-vov::LightingPass::LightingPass(Device& deviceRef, uint32_t framesInFlight, VkFormat format, VkExtent2D extent, const HDRI* hdri): m_device{deviceRef}, m_framesInFlight{framesInFlight}, m_imageFormat{format}, m_uniformBuffers{deviceRef} {
+vov::LightingPass::LightingPass(Device& deviceRef, uint32_t framesInFlight, VkFormat format, RenderGraph& graph, const HDRI* hdri): m_device{deviceRef}, m_framesInFlight{framesInFlight}, m_graph{graph}, m_imageFormat{format}, m_uniformBuffers{deviceRef} {
     m_descriptorPool = DescriptorPool::Builder(m_device)
             .setMaxSets(framesInFlight * 10)
             .addPoolSize(VK_DESCRIPTOR_TYPE_SAMPLER, framesInFlight * 3)
@@ -26,8 +26,7 @@ vov::LightingPass::LightingPass(Device& deviceRef, uint32_t framesInFlight, VkFo
     m_geobufferSamplersSetLayout = DescriptorSetLayout::Builder(m_device)
             .addBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT) //albedo
             .addBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT) //normal
-            .addBinding(2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT) //Specular
-            .addBinding(3, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT) //MetallicRoughness
+            .addBinding(2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT) //MetallicRoughness
             .addBinding(4, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT) //Selection
             .addBinding(5, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT) //Depth
             .addBinding(6, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT) //Shadow
@@ -124,12 +123,14 @@ vov::LightingPass::LightingPass(Device& deviceRef, uint32_t framesInFlight, VkFo
     pipelineConfig.colorAttachments = {format};
     // pipelineConfig.depthAttachment
 
-    m_pipeline = std::make_unique<Pipeline>(
+    m_pipelines = std::make_unique<PipelinePermutations>(
         m_device,
         "shaders/triangle.vert.spv",
         "shaders/lightingPass.frag.spv",
-        pipelineConfig
+        pipelineConfig,
+        1
     );
+    (void)m_pipelines->Get(0);
 
     m_textureDescriptors.resize(framesInFlight);
 
@@ -144,7 +145,6 @@ vov::LightingPass::LightingPass(Device& deviceRef, uint32_t framesInFlight, VkFo
         writer.writeImage(0, &dummyInfo);
         writer.writeImage(1, &dummyInfo);
         writer.writeImage(2, &dummyInfo);
-        writer.writeImage(3, &dummyInfo);
         writer.writeImage(4, &dummyInfo);
         writer.writeImage(5, &dummyInfo);
         writer.writeImage(6, &dummyInfo); // Shadow map
@@ -179,38 +179,34 @@ vov::LightingPass::LightingPass(Device& deviceRef, uint32_t framesInFlight, VkFo
     if (!hdriWriter.build(m_hdriSamplerDescriptorSets)) {
         throw std::runtime_error("Failed to build descriptor set for LightingPass");
     }
-
-    m_renderTargets.resize(framesInFlight);
-    for (int index{0}; index < framesInFlight; ++index) {
-        m_renderTargets[index] = std::make_unique<Image>(
-            m_device,
-            extent,
-            format,
-            VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-            VMA_MEMORY_USAGE_AUTO,
-            true,
-            true,
-            VK_FILTER_NEAREST
-        );
-        m_renderTargets[index]->SetName("LightTarget:" + std::to_string(index));
-    }
 }
 
 vov::LightingPass::~LightingPass() {
     vkDestroyPipelineLayout(m_device.device(), m_pipelineLayout, nullptr);
 }
 
+vov::RenderGraph::Resource vov::LightingPass::Declare(RenderGraph::PassBuilder& pass) {
+    m_renderTarget = pass.Create({
+        "LightTarget",
+        m_imageFormat,
+        VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+        VK_FILTER_NEAREST
+    }, RenderGraph::Usage::COLOR_ATTACHMENT);
+    return m_renderTarget;
+}
+
 void vov::LightingPass::Record(const FrameContext& context, VkCommandBuffer commandBuffer, uint32_t imageIndex, const GeometryPass& geoPass, const HDRI& hdri, ShadowPass& shadowPass, Scene& scene) {
-    auto& currentImage = m_renderTargets[imageIndex];
+    Image* currentImage = &GetImage();
 
     auto cameraPos = glm::vec4(context.camera.m_position, 0);
     UniformBufferData ubo{};
     ubo.camSettings.cameraPos = cameraPos;
 
-    ubo.lightInfo.direction = scene.GetDirectionalLight().GetDirection();
-    ubo.lightInfo.color = scene.GetDirectionalLight().GetColor();
-    ubo.lightInfo.intensity = scene.GetDirectionalLight().GetIntensity();
-    ubo.lightInfo.lightProjView = scene.GetDirectionalLight().GetLightProjection() * scene.GetDirectionalLight().GetLightView();
+    DirectionalLight& light = context.directionalLight;
+    ubo.lightInfo.direction = light.GetDirection();
+    ubo.lightInfo.color = light.GetColor();
+    ubo.lightInfo.intensity = light.GetIntensity();
+    ubo.lightInfo.lightProjView = light.GetLightProjection() * light.GetLightView();
 
     ubo.camSettings.apeture = context.camera.GetAperture();
     ubo.camSettings.iso = context.camera.GetISO();
@@ -220,9 +216,10 @@ void vov::LightingPass::Record(const FrameContext& context, VkCommandBuffer comm
 
     ubo.proj = context.camera.GetProjectionMatrix();
     ubo.view = context.camera.GetViewMatrix();
+    ubo.inverseViewProj = glm::inverse(ubo.proj * ubo.view);
     ubo.viewportSize = {static_cast<float>(currentImage->GetExtent().width), static_cast<float>(currentImage->GetExtent().height)};
 
-    const auto& pointLights = scene.getPointLights();
+    const auto& pointLights = context.pointLights;
     ubo.pointLightCount = static_cast<uint32_t>(pointLights.size());
 
     ubo.debugViewMode = static_cast<int>(context.debugView);
@@ -246,16 +243,9 @@ void vov::LightingPass::Record(const FrameContext& context, VkCommandBuffer comm
     }
 
     if (!pointLights.empty()) {
-        std::vector<PointLight::PointLightData> pointLightData;
-        pointLightData.reserve(pointLights.size());
-        for (const auto& light: pointLights) {
-            pointLightData.push_back(light->getPointLightData());
-        }
-        m_pointLightBuffers[imageIndex]->copyTo(pointLightData.data(), sizeof(PointLight::PointLightData) * pointLights.size());
+        m_pointLightBuffers[imageIndex]->copyTo(pointLights.data(), sizeof(PointLight::PointLightData) * pointLights.size());
     }
 
-    m_renderTargets[imageIndex]->TransitionImageLayout(commandBuffer, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
-
     VkRenderingAttachmentInfo colorAttachment{};
     colorAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
     colorAttachment.imageView = currentImage->GetImageView();
@@ -291,22 +281,19 @@ void vov::LightingPass::Record(const FrameContext& context, VkCommandBuffer comm
     vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout, 2, 1, &m_hdriSamplerDescriptorSets, 0, nullptr);
     vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout, 3, 1, &m_pointLightDescriptorSets[imageIndex], 0, nullptr);
 
-    m_pipeline->bind(commandBuffer);
+    m_pipelines->Get(context.debugView != DebugView::NONE ? 1u : 0u).bind(commandBuffer);
     vkCmdDraw(commandBuffer, 3, 1, 0, 0);
 
     vkCmdEndRendering(commandBuffer);
-
-    m_renderTargets[imageIndex]->TransitionImageLayout(commandBuffer, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
     DebugLabel::EndCmdLabel(commandBuffer);
 }
 
-void vov::LightingPass::UpdateDescriptors(uint32_t frameIndex, const Image& albedo, const Image& normal, const Image& specular, const Image& bump, const Image& depth, const Image& shadowMap) {
+void vov::LightingPass::UpdateDescriptors(uint32_t frameIndex, const Image& albedo, const Image& normal, const Image& specular, const Image& depth, const Image& shadowMap) {
     DescriptorWriter writer(*m_geobufferSamplersSetLayout, *m_descriptorPool);
 
     const auto albedoInfo = albedo.descriptorInfo();
     const auto normalInfo = normal.descriptorInfo();
     const auto specularInfo = specular.descriptorInfo();
-    const auto bumpInfo = bump.descriptorInfo();
     const auto depthInfo = depth.descriptorInfo();
     const auto shadowMapInfo = shadowMap.descriptorInfo();
 
@@ -314,28 +301,11 @@ void vov::LightingPass::UpdateDescriptors(uint32_t frameIndex, const Image& albe
             .writeImage(0, &albedoInfo)
             .writeImage(1, &normalInfo)
             .writeImage(2, &specularInfo)
-            .writeImage(3, &bumpInfo)
             .writeImage(5, &depthInfo)
             .writeImage(6, &shadowMapInfo)
             .overwrite(m_textureDescriptors[frameIndex]);
 }
 
-vov::Image& vov::LightingPass::GetImage(int imageIndex) const {
-    return *m_renderTargets[imageIndex];
-}
-
-void vov::LightingPass::Resize(VkExtent2D newSize) {
-    m_renderTargets.clear();
-    m_renderTargets.resize(m_framesInFlight);
-
-    for (int index{0}; index < m_framesInFlight; ++index) {
-        m_renderTargets[index] = std::make_unique<Image>(
-            m_device,
-            newSize,
-            m_imageFormat,
-            VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-            VMA_MEMORY_USAGE_AUTO
-        );
-        m_renderTargets[index]->SetName("LightTarget" + index);
-    }
+vov::Image& vov::LightingPass::GetImage() const {
+    return m_graph.GetImage(m_renderTarget);
 }
@@ -3,6 +3,7 @@
 #include "GeometryPass.h"
 #include "ShadowPass.h"
 #include "Core/Device.h"
+#include "Rendering/PipelinePermutations.h"
 #include "Rendering/Swapchain.h"
 #include "Resources/HDRI.h"
 #include "Utils/FrameContext.h"
@@ -28,6 +29,7 @@ namespace vov {
         struct alignas(16) UniformBufferData {
             glm::mat4 proj{};
             glm::mat4 view{};
+            glm::mat4 inverseViewProj{};    // the G-buffer has no positions, they are rebuilt from depth with it
             Camera::CameraSettings camSettings{};
             DirectionalLightInfo lightInfo{};
             uint32_t  pointLightCount{};
@@ -38,15 +40,17 @@ namespace vov {
             int debugViewMode{static_cast<int>(DebugView::NONE)};
         };
 
-        explicit LightingPass(Device& deviceRef,uint32_t framesInFlight, VkFormat format, VkExtent2D extent, const HDRI* hdri = nullptr);
+        explicit LightingPass(Device& deviceRef,uint32_t framesInFlight, VkFormat format, RenderGraph& graph, const HDRI* hdri = nullptr);
         ~LightingPass();
 
+        // Creates this frame's target, written as the pass's attachment
+        [[nodiscard]] RenderGraph::Resource Declare(RenderGraph::PassBuilder& pass);
+
         void Record(const FrameContext& context, VkCommandBuffer commandBuffer, uint32_t imageIndex, const GeometryPass& geoPass, const HDRI& hdri, ShadowPass& shadowPass, Scene& scene);
 
-        void UpdateDescriptors(uint32_t frameIndex, const Image& albedo, const Image& normal, const Image& specular, const Image& bump, const Image& depth, const Image& shadowMap);
+        void UpdateDescriptors(uint32_t frameIndex, const Image& albedo, const Image& normal, const Image& specular, const Image& depth, const Image& shadowMap);
 
-        [[nodiscard]] Image& GetImage(int imageIndex) const;
-        void Resize(VkExtent2D newSize);
+        [[nodiscard]] Image& GetImage() const;
 
     private:
         Device& m_device;
@@ -68,11 +72,13 @@ namespace vov {
         std::unique_ptr<DescriptorSetLayout> m_hdriSamplerSetLayout{};
         VkDescriptorSet m_hdriSamplerDescriptorSets{};
 
-        std::vector<std::unique_ptr<Image>> m_renderTargets{};
+        RenderGraph& m_graph;
+        RenderGraph::Resource m_renderTarget{};
         VkFormat m_imageFormat{};
 
         VkPipelineLayout m_pipelineLayout{};
-        std::unique_ptr<Pipeline> m_pipeline;
+        // Without the debug views unless one is picked, see lightingPass.frag
+        std::unique_ptr<PipelinePermutations> m_pipelines;
     };
 }
 
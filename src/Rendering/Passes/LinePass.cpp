@@ -10,7 +10,7 @@
 
 
 
-vov::LinePass::LinePass(Device& deviceRef, uint32_t framesInFlight, VkExtent2D extent): m_device{deviceRef}, m_framesInFlight{framesInFlight} {
+vov::LinePass::LinePass(Device& deviceRef, uint32_t framesInFlight, RenderGraph& graph): m_device{deviceRef}, m_framesInFlight{framesInFlight}, m_graph{graph} {
     m_descriptorPool = DescriptorPool::Builder(m_device)
         .setMaxSets(framesInFlight * 2)
         .addPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, framesInFlight * 2)
@@ -38,17 +38,6 @@ vov::LinePass::LinePass(Device& deviceRef, uint32_t framesInFlight, VkExtent2D e
             .build(m_descriptorSets[i]);
     }
 
-    m_renderTargets.resize(m_framesInFlight);
-    for (int index{0}; index < m_framesInFlight; ++index) {
-        m_renderTargets[index] = std::make_unique<Image>(
-            m_device,
-            extent,
-            VK_FORMAT_R8G8B8A8_UNORM,
-            VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-            VMA_MEMORY_USAGE_GPU_ONLY
-        );
-    }
-
     PipelineConfigInfo pipelineInfo{};
     Pipeline::DefaultPipelineConfigInfo(pipelineInfo);
 
@@ -60,7 +49,7 @@ vov::LinePass::LinePass(Device& deviceRef, uint32_t framesInFlight, VkExtent2D e
     pipelineInfo.depthStencilInfo.depthCompareOp = VK_COMPARE_OP_LESS;
 
     pipelineInfo.colorAttachments = {
-        m_renderTargets[0]->GetFormat()
+        GetImage().GetFormat()
     };
 
     pipelineInfo.inputAssemblyInfo.topology = VK_PRIMITIVE_TOPOLOGY_LINE_LIST;
@@ -125,10 +114,20 @@ vov::LinePass::~LinePass() {
     vkDestroyPipelineLayout(m_device.device(), m_pipelineLayout, nullptr);
 }
 
+vov::RenderGraph::Resource vov::LinePass::Declare(RenderGraph::PassBuilder& pass) {
+    m_renderTarget = pass.Create({
+        "LineTarget",
+        VK_FORMAT_R8G8B8A8_UNORM,
+        VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+        VK_FILTER_LINEAR
+    }, RenderGraph::Usage::COLOR_ATTACHMENT);
+    return m_renderTarget;
+}
+
 void vov::LinePass::Record(FrameContext context, VkCommandBuffer commandBuffer, uint32_t imageIndex, Image& depthImage) {
-    Image& renderTarget = *m_renderTargets[imageIndex];
+    Image& renderTarget = GetImage();
 
-    UpdateVertexBuffer();
+    UpdateVertexBuffer(context.lines);
 
     auto cameraPos = context.camera.GetPosition();
     UniformBuffer uniformData{};
@@ -142,9 +141,6 @@ void vov::LinePass::Record(FrameContext context, VkCommandBuffer commandBuffer,
     m_uniformBuffers[imageIndex]->copyTo(&uniformData, sizeof(UniformBuffer));
 
 
-    renderTarget.TransitionImageLayout(commandBuffer, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
-    depthImage.TransitionImageLayout(commandBuffer, VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL);
-
     VkRenderingAttachmentInfo colorAttachment{};
     colorAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
     colorAttachment.imageView = renderTarget.GetImageView();
@@ -158,8 +154,8 @@ void vov::LinePass::Record(FrameContext context, VkCommandBuffer commandBuffer,
     depthAttachment.imageView = depthImage.GetImageView();
     depthAttachment.imageLayout = depthImage.GetCurrentLayout();
     depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
-    // depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-    depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    // Only tested, nothing to write back
+    depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_NONE;
 
     VkRenderingInfo renderingInfo{};
     renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
@@ -191,37 +187,17 @@ void vov::LinePass::Record(FrameContext context, VkCommandBuffer commandBuffer,
     const VkBuffer buffers[] = {m_vertexBuffer->getBuffer()};
     const VkDeviceSize offsets[] = {0};
     vkCmdBindVertexBuffers(commandBuffer, 0, 1, buffers, offsets);
-    vkCmdDraw(commandBuffer, static_cast<uint32_t>(LineManager::GetInstance().GetLines().size() * 2), 1, 0, 0);
+    vkCmdDraw(commandBuffer, static_cast<uint32_t>(context.lines.size() * 2), 1, 0, 0);
 
     vkCmdEndRendering(commandBuffer);
-
-    renderTarget.TransitionImageLayout(commandBuffer, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
     DebugLabel::EndCmdLabel(commandBuffer);
 }
 
-void vov::LinePass::Resize(VkExtent2D newSize) {
-    m_renderTargets.clear();
-    m_renderTargets.resize(m_framesInFlight);
-
-    for (int index{0}; index < m_framesInFlight; ++index) {
-        m_renderTargets[index] = std::make_unique<Image>(
-            m_device,
-            newSize,
-            VK_FORMAT_R8G8B8A8_UNORM,
-            VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-            VMA_MEMORY_USAGE_AUTO
-        );
-        m_renderTargets[index]->SetName("LineTarget: " + std::to_string(index));
-    }
-
-}
-
-vov::Image& vov::LinePass::GetImage(int imageIndex) const {
-    return *m_renderTargets[imageIndex];
+vov::Image& vov::LinePass::GetImage() const {
+    return m_graph.GetImage(m_renderTarget);
 }
 
-void vov::LinePass::UpdateVertexBuffer() {
-    std::vector<LineManager::Line> lines = LineManager::GetInstance().GetLines();
+void vov::LinePass::UpdateVertexBuffer(const std::vector<LineManager::Line>& lines) {
     const size_t requiredVertexCount = lines.size() * 2; // assuming 2 vertices per line
 
     if (requiredVertexCount <= 0) {
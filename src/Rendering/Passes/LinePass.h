@@ -7,7 +7,9 @@
 #include "Rendering/Pipeline.h"
 #include "Resources/Buffer.h"
 #include "Resources/Image.h"
+#include "Rendering/RenderGraph.h"
 #include "Utils/FrameContext.h"
+#include "Utils/LineManager.h"
 
 namespace vov {
     class LinePass {
@@ -19,17 +21,18 @@ namespace vov {
         };
 
 
-        explicit LinePass(Device& deviceRef, uint32_t framesInFlight, VkExtent2D extent);
+        explicit LinePass(Device& deviceRef, uint32_t framesInFlight, RenderGraph& graph);
         ~LinePass();
 
-        void Record(FrameContext context, VkCommandBuffer commandBuffer, uint32_t imageIndex, Image& depthImage);
+        // Creates this frame's target, written as the pass's attachment. Depth is only tested against
+        [[nodiscard]] RenderGraph::Resource Declare(RenderGraph::PassBuilder& pass);
 
-        void Resize(VkExtent2D newSize);
+        void Record(FrameContext context, VkCommandBuffer commandBuffer, uint32_t imageIndex, Image& depthImage);
 
-        [[nodiscard]] Image& GetImage(int imageIndex) const;
+        [[nodiscard]] Image& GetImage() const;
 
     private:
-        void UpdateVertexBuffer();
+        void UpdateVertexBuffer(const std::vector<LineManager::Line>& lines);
 
 
         Device& m_device;
@@ -41,7 +44,8 @@ namespace vov {
 
         std::vector<std::unique_ptr<Buffer>> m_uniformBuffers{};
 
-        std::vector<std::unique_ptr<Image>> m_renderTargets{};
+        RenderGraph& m_graph;
+        RenderGraph::Resource m_renderTarget{};
 
         std::unique_ptr<Pipeline> m_pipeline{};
         VkPipelineLayout m_pipelineLayout{};
@@ -7,7 +7,7 @@
 #include "Resources/Buffer.h"
 #include "Utils/DebugLabel.h"
 
-vov::ShadowPass::ShadowPass(Device& deviceRef, uint32_t framesInFlight, VkFormat format, VkExtent2D extent): m_device{deviceRef}, m_framesInFlight{framesInFlight}, m_imageFormat{format}, m_uniformBuffer{deviceRef} {
+vov::ShadowPass::ShadowPass(Device& deviceRef, uint32_t framesInFlight, VkFormat format, VkExtent2D extent, const TransformBuffer& transforms): m_device{deviceRef}, m_framesInFlight{framesInFlight}, m_imageFormat{format}, m_transforms{transforms}, m_uniformBuffer{deviceRef} {
     m_descriptorPool = DescriptorPool::Builder(m_device)
             .SetName("ShadowPass Descriptor Pool")
             .setMaxSets(framesInFlight * 2)
@@ -46,18 +46,12 @@ vov::ShadowPass::ShadowPass(Device& deviceRef, uint32_t framesInFlight, VkFormat
     }
 
     const std::array descriptorSetLayouts = {
-        m_descriptorSetLayout->getDescriptorSetLayout()
+        m_descriptorSetLayout->getDescriptorSetLayout(),
+        m_transforms.GetDescriptorSetLayout().getDescriptorSetLayout()
     };
 
-    VkPushConstantRange pushConstantRange{};
-    pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
-    pushConstantRange.offset = 0;
-    pushConstantRange.size = sizeof(PushConstant);
-
     VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
     pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    pipelineLayoutInfo.pushConstantRangeCount = 1;
-    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
     pipelineLayoutInfo.setLayoutCount = static_cast<uint32_t>(descriptorSetLayouts.size());
     pipelineLayoutInfo.pSetLayouts = descriptorSetLayouts.data();
 
@@ -93,24 +87,22 @@ vov::ShadowPass::~ShadowPass() {
     vkDestroyPipelineLayout(m_device.device(), m_pipelineLayout, nullptr);
 }
 
-void vov::ShadowPass::Record(const FrameContext& context) {
+void vov::ShadowPass::BeginRendering(const FrameContext& context, VkRenderingFlags flags) {
     const uint32_t imageIndex = context.frameIndex;
     const auto commandBuffer = context.commandBuffer;
 
     UniformBufferData ubo{};
-    ubo.lightViewMatrix = context.currentScene.GetDirectionalLight().GetViewMatrix();
-    ubo.lightProjectionMatrix = context.currentScene.GetDirectionalLight().GetProjectionMatrix();
+    ubo.lightViewMatrix = context.directionalLight.GetViewMatrix();
+    ubo.lightProjectionMatrix = context.directionalLight.GetProjectionMatrix();
 
     ubo.lightProjectionMatrix[1][1] *= -1;
 
     m_uniformBuffer.update(imageIndex, ubo);
 
-    m_depthImage->TransitionImageLayout(commandBuffer, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT);
-
     VkRenderingAttachmentInfo depthAttachment{};
     depthAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
     depthAttachment.imageView = m_depthImage->GetImageView();
-    depthAttachment.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+    depthAttachment.imageLayout = m_depthImage->GetCurrentLayout();
     depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
     depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
     depthAttachment.clearValue.depthStencil = { .depth = 1.0f, .stencil = 0 };
@@ -118,6 +110,7 @@ void vov::ShadowPass::Record(const FrameContext& context) {
     const VkExtent2D extent = m_depthImage->GetExtent();
     VkRenderingInfo renderingInfo{};
     renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
+    renderingInfo.flags = flags;
     renderingInfo.renderArea = VkRect2D{VkOffset2D{0, 0}, extent};
     renderingInfo.layerCount = 1;
     renderingInfo.pDepthAttachment = &depthAttachment;
@@ -129,7 +122,10 @@ void vov::ShadowPass::Record(const FrameContext& context) {
     );
 
     vkCmdBeginRendering(commandBuffer, &renderingInfo);
+}
 
+void vov::ShadowPass::SetDrawState(VkCommandBuffer commandBuffer, uint32_t frameIndex) const {
+    const VkExtent2D extent = m_depthImage->GetExtent();
     VkViewport viewport;
     viewport.x = 0.0f;
     viewport.y = 0.0f;
@@ -144,34 +140,46 @@ void vov::ShadowPass::Record(const FrameContext& context) {
     scissor.extent = extent;
     vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
 
-    m_pipeline->bind(commandBuffer);
-
-    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout, 0, 1, &m_descriptorSets[imageIndex], 0, nullptr);
+    const std::array descriptorSets = {m_descriptorSets[frameIndex], m_transforms.GetDescriptorSet(frameIndex)};
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout, 0, static_cast<uint32_t>(descriptorSets.size()), descriptorSets.data(), 0, nullptr);
+}
 
-    for (const auto& object : context.currentScene.getGameObjects()) {
-        for (const auto& mesh : object->model->getMeshes()) {
-            PushConstant push{};
-            push.model = mesh->getTransform().GetWorldMatrix();
+void vov::ShadowPass::EndRendering(VkCommandBuffer commandBuffer) {
+    vkCmdEndRendering(commandBuffer);
+    DebugLabel::EndCmdLabel(commandBuffer);
+}
 
-            vkCmdPushConstants(
-                commandBuffer,
-                m_pipelineLayout,
-                VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
-                0,
-                sizeof(PushConstant),
-                &push
-            );
+void vov::ShadowPass::Record(const FrameContext& context) {
+    const auto commandBuffer = context.commandBuffer;
 
-            mesh->bind(commandBuffer);
-            mesh->draw(commandBuffer);
-        }
+    const glm::mat4 lightView = context.directionalLight.GetViewMatrix();
+    m_renderQueue.Clear();
+    for (const Mesh* mesh : context.shadowCasters) {
+        m_renderQueue.Push(*m_pipeline, m_pipelineLayout, *mesh, RenderQueue::ViewDepth(lightView, context.worldMatrices[mesh->GetSceneIndex()], *mesh));
     }
+    m_renderQueue.Sort();
 
-    vkCmdEndRendering(commandBuffer);
+    BeginRendering(context, m_renderQueue.GetRenderingFlags(context.recorder));
+    m_renderQueue.Record(commandBuffer, context.recorder, context.frameIndex, {{}, m_imageFormat}, [&] (VkCommandBuffer drawCommandBuffer) {
+        SetDrawState(drawCommandBuffer, context.frameIndex);
+    });
 
-    m_depthImage->TransitionImageLayout(commandBuffer, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+    EndRendering(commandBuffer);
+}
 
-    DebugLabel::EndCmdLabel(commandBuffer);
+void vov::ShadowPass::RecordIndirect(const FrameContext& context, const SceneGeometry& geometry, const IndirectDrawList& drawList) {
+    const auto commandBuffer = context.commandBuffer;
+
+    BeginRendering(context, 0);
+    SetDrawState(commandBuffer, context.frameIndex);
+
+    if (drawList.maxDraws > 0) {
+        m_pipeline->bind(commandBuffer);
+        geometry.Bind(commandBuffer);
+        vkCmdDrawIndexedIndirectCount(commandBuffer, drawList.commands, 0, drawList.count, drawList.countOffset, drawList.maxDraws, sizeof(VkDrawIndexedIndirectCommand));
+    }
+
+    EndRendering(commandBuffer);
 }
 
 void vov::ShadowPass::Resize(VkExtent2D newSize) {
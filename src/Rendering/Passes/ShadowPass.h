@@ -5,7 +5,10 @@
 #include "Descriptors/DescriptorPool.h"
 #include "Descriptors/DescriptorSetLayout.h"
 #include "Rendering/Pipeline.h"
+#include "Rendering/RenderQueue.h"
+#include "IndirectCullPass.h"
 #include "Resources/Image.h"
+#include "Resources/TransformBuffer.h"
 #include "Resources/UniformBuffer.h"
 #include "Scene/Scene.h"
 #include "Scene/Lights/DirectionalLight.h"
@@ -19,22 +22,28 @@ namespace vov {
             glm::mat4 lightProjectionMatrix{};
         };
 
-        struct PushConstant {
-            glm::mat4 model{};
-        };
-
-        explicit ShadowPass(Device& deviceRef, uint32_t framesInFlight, VkFormat format, VkExtent2D extent);
+        explicit ShadowPass(Device& deviceRef, uint32_t framesInFlight, VkFormat format, VkExtent2D extent, const TransformBuffer& transforms);
         ~ShadowPass();
 
         void Record(const FrameContext& context);
 
+        // Same as DepthPrePass::RecordIndirect but with the light's matrices
+        void RecordIndirect(const FrameContext& context, const SceneGeometry& geometry, const IndirectDrawList& drawList);
+
         void Resize(VkExtent2D newSize);
+        [[nodiscard]] const RenderQueue::Stats& GetQueueStats() const { return m_renderQueue.GetStats(); }
         Image& GetDepthImage(int frameIndex);
 
     private:
+        void BeginRendering(const FrameContext& context, VkRenderingFlags flags);
+        // Viewport, scissor and sets 0 and 1, once on the primary or on every secondary
+        void SetDrawState(VkCommandBuffer commandBuffer, uint32_t frameIndex) const;
+        void EndRendering(VkCommandBuffer commandBuffer);
+
         Device& m_device;
         uint32_t m_framesInFlight{};
         VkFormat m_imageFormat{};
+        const TransformBuffer& m_transforms;
 
         std::unique_ptr<DescriptorPool> m_descriptorPool{};
         std::unique_ptr<DescriptorSetLayout> m_descriptorSetLayout{};
@@ -46,6 +55,9 @@ namespace vov {
 
         std::unique_ptr<Pipeline> m_pipeline{};
         VkPipelineLayout m_pipelineLayout{};
+
+        // Front to back from the light
+        RenderQueue m_renderQueue{RenderQueue::Order::DEPTH_FIRST};
     };
 }
 
@@ -5,25 +5,54 @@
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <sstream>
 #include <Utils/Chalk.h>
 
+#include "PipelineBatch.h"
+#include "ShaderReloader.h"
 #include "Scene/Mesh.h"
 #include "Utils/DebugLabel.h"
 
 namespace vov {
     Pipeline::Pipeline(Device& device, const std::string& vertPath, const std::string& fragPath,
-                       const PipelineConfigInfo& configInfo): m_device(device) {
-        CreateGraphicsPipeline(vertPath, fragPath, configInfo);
+                       const PipelineConfigInfo& configInfo): m_device(device), m_vertPath{vertPath}, m_fragPath{fragPath} {
+        assert(configInfo.pipelineLayout != VK_NULL_HANDLE && "no pipelineLayout provided in configInfo");
+
+        // Layouts are shared between pipelines, named here so no two jobs touch the same one
+        if (!configInfo.name.empty()) {
+            DebugLabel::SetObjectName(
+                reinterpret_cast<uint64_t>(configInfo.pipelineLayout),
+                VK_OBJECT_TYPE_PIPELINE_LAYOUT,
+                configInfo.name.c_str()
+            );
+        }
+
+        // The config can point at the caller's stack, the job and every reload use a copy of everything it points to
+        CopyConfigInfo(configInfo, m_config, m_blendAttachments);
+
+        PipelineBatch::GetInstance().Submit("Graphics pipeline", [this] {
+            m_handles = CreateGraphicsPipeline(ReadStage(m_vertPath), ReadStage(m_fragPath));
+        });
+
+        ShaderReloader::Reloadable reloadable{};
+        for (const std::string* path : {&m_vertPath, &m_fragPath}) {
+            if (!path->empty()) {
+                reloadable.spirvFiles.push_back(std::filesystem::path(*path).filename().string());
+            }
+        }
+        reloadable.prepare = [this] { return PrepareReload(); };
+        reloadable.apply = [this] { ApplyReload(); };
+        ShaderReloader::GetInstance().Register(this, std::move(reloadable));
     }
 
     Pipeline::~Pipeline() {
-        vkDestroyShaderModule(m_device.device(), m_vertShaderModule, nullptr);
-        vkDestroyShaderModule(m_device.device(), m_fragShaderModule, nullptr);
-        vkDestroyPipeline(m_device.device(), m_graphicsPipeline, nullptr);
+        ShaderReloader::GetInstance().Unregister(this);
+        Destroy(m_pending);
+        Destroy(m_handles);
     }
 
     void Pipeline::bind(VkCommandBuffer buffer) const {
-        vkCmdBindPipeline(buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphicsPipeline);
+        vkCmdBindPipeline(buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_handles.pipeline);
     }
 
     void Pipeline::DefaultPipelineConfigInfo(PipelineConfigInfo& configInfo) {
@@ -104,6 +133,16 @@ namespace vov {
         configInfo.vertexBindingDescriptions = std::move(Mesh::Vertex::getBindingDescriptions());
     }
 
+    void Pipeline::CopyConfigInfo(const PipelineConfigInfo& source, PipelineConfigInfo& config, std::vector<VkPipelineColorBlendAttachmentState>& blendAttachments) {
+        config = source;
+        blendAttachments.assign(
+            source.colorBlendInfo.pAttachments, source.colorBlendInfo.pAttachments + source.colorBlendInfo.attachmentCount);
+        config.dynamicStateEnables.assign(
+            source.dynamicStateInfo.pDynamicStates, source.dynamicStateInfo.pDynamicStates + source.dynamicStateInfo.dynamicStateCount);
+        config.colorBlendInfo.pAttachments = blendAttachments.data();
+        config.dynamicStateInfo.pDynamicStates = config.dynamicStateEnables.data();
+    }
+
     std::vector<char> Pipeline::readFile(const std::string& filename) {
         std::ifstream file(filename, std::ios::ate | std::ios::binary);
 
@@ -122,53 +161,104 @@ namespace vov {
         return buffer;
     }
 
-    void Pipeline::CreateGraphicsPipeline(const std::string& vertPath, const std::string& fragPath,
-                                          const PipelineConfigInfo& configInfo) {
-        assert(configInfo.pipelineLayout != VK_NULL_HANDLE && "no pipelineLayout provided in configInfo");
+    std::vector<char> Pipeline::ReadStage(const std::string& path) {
+        return path.empty() ? std::vector<char>{} : readFile(path);
+    }
+
+    bool Pipeline::PrepareReload() {
+        const std::vector<char> vertCode = ReadStage(m_vertPath);
+        const std::vector<char> fragCode = ReadStage(m_fragPath);
+
+        // Against the newest build, the one waiting to be swapped in if there is one
+        const Handles& latest = m_pending.pipeline != VK_NULL_HANDLE ? m_pending : m_handles;
+        if (ShaderReloader::Hash(vertCode) == latest.vertHash && ShaderReloader::Hash(fragCode) == latest.fragHash) {
+            return false;
+        }
+
+        try {
+            Handles handles = CreateGraphicsPipeline(vertCode, fragCode);
+            Destroy(m_pending);
+            m_pending = handles;
+            return true;
+        } catch (const std::exception& exception) {
+            std::cerr << "Failed to reload " << m_config.name << ": " << exception.what() << std::endl;
+            return false;
+        }
+    }
+
+    void Pipeline::ApplyReload() {
+        Destroy(m_handles);
+        m_handles = m_pending;
+        m_pending = {};
+    }
+
+    void Pipeline::Destroy(const Handles& handles) const {
+        vkDestroyShaderModule(m_device.device(), handles.vertModule, nullptr);
+        vkDestroyShaderModule(m_device.device(), handles.fragModule, nullptr);
+        vkDestroyPipeline(m_device.device(), handles.pipeline, nullptr);
+    }
+
+    Pipeline::Handles Pipeline::CreateGraphicsPipeline(const std::vector<char>& vertCode, const std::vector<char>& fragCode) const {
+        const PipelineConfigInfo& configInfo = m_config;
+        Handles handles{};
+        handles.vertHash = ShaderReloader::Hash(vertCode);
+        handles.fragHash = ShaderReloader::Hash(fragCode);
+
+        // Both stages get the same constants, ids a stage doesn't declare are ignored
+        std::vector<VkSpecializationMapEntry> specializationEntries(configInfo.specializationConstants.size());
+        for (uint32_t i = 0; i < specializationEntries.size(); ++i) {
+            specializationEntries[i] = {i, static_cast<uint32_t>(i * sizeof(uint32_t)), sizeof(uint32_t)};
+        }
+        VkSpecializationInfo specializationInfo{};
+        specializationInfo.mapEntryCount = static_cast<uint32_t>(specializationEntries.size());
+        specializationInfo.pMapEntries = specializationEntries.data();
+        specializationInfo.dataSize = configInfo.specializationConstants.size() * sizeof(uint32_t);
+        specializationInfo.pData = configInfo.specializationConstants.data();
+        const VkSpecializationInfo* pSpecializationInfo = specializationEntries.empty() ? nullptr : &specializationInfo;
 
         std::vector<VkPipelineShaderStageCreateInfo> shaderStages;
+        // Printed in one go, other pipelines may be compiling next to this one
+        std::ostringstream log{};
 
-        if (!vertPath.empty()) {
-            std::string VertFileName = std::filesystem::path(vertPath).filename().string();
-            auto vertCode = readFile(vertPath);
-            std::cout << "Vert file: " << Chalk::Green << VertFileName << Chalk::Reset << std::endl;
-            std::cout << "Vert code size: " << Chalk::Green << vertCode.size() << Chalk::Reset << std::endl;
+        if (!m_vertPath.empty()) {
+            std::string VertFileName = std::filesystem::path(m_vertPath).filename().string();
+            log << "Vert file: " << Chalk::Green << VertFileName << Chalk::Reset << std::endl;
+            log << "Vert code size: " << Chalk::Green << vertCode.size() << Chalk::Reset << std::endl;
 
-            CreateShaderModule(vertCode, &m_vertShaderModule);
+            CreateShaderModule(vertCode, &handles.vertModule);
 
             VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
             vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
             vertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
-            vertShaderStageInfo.module = m_vertShaderModule;
+            vertShaderStageInfo.module = handles.vertModule;
             vertShaderStageInfo.pName = "main";
             vertShaderStageInfo.flags = 0;
-            vertShaderStageInfo.pSpecializationInfo = nullptr;
+            vertShaderStageInfo.pSpecializationInfo = pSpecializationInfo;
             vertShaderStageInfo.pNext = nullptr;
 
             shaderStages.push_back(vertShaderStageInfo);
         }
 
-        if (!fragPath.empty()) {
-            std::string FragFileName = std::filesystem::path(fragPath).filename().string();
-            auto fragCode = readFile(fragPath);
-            std::cout << "Frag file: " << Chalk::Blue << FragFileName << Chalk::Reset << std::endl;
-            std::cout << "Frag code size: " << Chalk::Blue << fragCode.size() << Chalk::Reset << std::endl;
+        if (!m_fragPath.empty()) {
+            std::string FragFileName = std::filesystem::path(m_fragPath).filename().string();
+            log << "Frag file: " << Chalk::Blue << FragFileName << Chalk::Reset << std::endl;
+            log << "Frag code size: " << Chalk::Blue << fragCode.size() << Chalk::Reset << std::endl;
 
-            CreateShaderModule(fragCode, &m_fragShaderModule);
+            CreateShaderModule(fragCode, &handles.fragModule);
 
             VkPipelineShaderStageCreateInfo fragShaderStageInfo{};
             fragShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
             fragShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-            fragShaderStageInfo.module = m_fragShaderModule;
+            fragShaderStageInfo.module = handles.fragModule;
             fragShaderStageInfo.pName = "main";
             fragShaderStageInfo.flags = 0;
-            fragShaderStageInfo.pSpecializationInfo = nullptr;
+            fragShaderStageInfo.pSpecializationInfo = pSpecializationInfo;
             fragShaderStageInfo.pNext = nullptr;
 
             shaderStages.push_back(fragShaderStageInfo);
         }
 
-        std::cout << std::endl;
+        std::cout << log.str() << std::endl;
 
 
         VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
@@ -207,18 +297,11 @@ namespace vov {
         pipelineInfo.basePipelineIndex = -1;
         pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
 
-        if (!configInfo.name.empty()) {
-            DebugLabel::SetObjectName(
-                reinterpret_cast<uint64_t>(pipelineInfo.layout),
-                VK_OBJECT_TYPE_PIPELINE_LAYOUT,
-                configInfo.name.c_str()
-            );
-        }
-
-
-        if (vkCreateGraphicsPipelines(m_device.device(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_graphicsPipeline) != VK_SUCCESS) {
+        if (vkCreateGraphicsPipelines(m_device.device(), m_device.GetPipelineCache(), 1, &pipelineInfo, nullptr, &handles.pipeline) != VK_SUCCESS) {
+            Destroy(handles);
             throw std::runtime_error("Can't make pipeline!");
         }
+        return handles;
     }
 
     void Pipeline::CreateShaderModule(const std::vector<char>& code, VkShaderModule* shaderModule) const {
@@ -26,9 +26,13 @@ namespace vov {
         std::vector<VkVertexInputBindingDescription> vertexBindingDescriptions{};
         std::vector<VkVertexInputAttributeDescription> vertexAttributeDescriptions{};
 
+        // Value of every stage's constant_id i, bools as VkBool32. Empty keeps the shaders' defaults
+        std::vector<uint32_t> specializationConstants{};
+
         VkPipelineLayout pipelineLayout = nullptr;
     };
 
+    // Compiled as a job inside a PipelineBatch, rebuilt when its shaders change
     class Pipeline {
     public:
         Pipeline(Device& device, const std::string& vertPath, const std::string& fragPath, const PipelineConfigInfo& configInfo);
@@ -41,19 +45,40 @@ namespace vov {
 
         void bind(VkCommandBuffer buffer) const;
         static void DefaultPipelineConfigInfo(PipelineConfigInfo& configInfo);
+        // Copies source into config with the blend attachments it points to moved into blendAttachments,
+        // for configs that outlive the caller's stack
+        static void CopyConfigInfo(const PipelineConfigInfo& source, PipelineConfigInfo& config, std::vector<VkPipelineColorBlendAttachmentState>& blendAttachments);
 
-    private:
         static std::vector<char> readFile(const std::string& filename);
 
-        void CreateGraphicsPipeline(const std::string& vertPath, const std::string& fragPath, const PipelineConfigInfo& configInfo);
+    private:
+        struct Handles {
+            VkPipeline pipeline{VK_NULL_HANDLE};
+            VkShaderModule vertModule{VK_NULL_HANDLE};
+            VkShaderModule fragModule{VK_NULL_HANDLE};
+            uint64_t vertHash{0};
+            uint64_t fragHash{0};
+        };
+
+        [[nodiscard]] Handles CreateGraphicsPipeline(const std::vector<char>& vertCode, const std::vector<char>& fragCode) const;
+        void Destroy(const Handles& handles) const;
+        [[nodiscard]] static std::vector<char> ReadStage(const std::string& path);
+
+        // See ShaderReloader
+        bool PrepareReload();
+        void ApplyReload();
 
         void CreateShaderModule(const std::vector<char>& code, VkShaderModule* shaderModule) const;
 
         Device& m_device;
 
-        VkPipeline m_graphicsPipeline{VK_NULL_HANDLE};
-        VkShaderModule m_vertShaderModule{VK_NULL_HANDLE};
-        VkShaderModule m_fragShaderModule{VK_NULL_HANDLE};
+        std::string m_vertPath{};
+        std::string m_fragPath{};
+        PipelineConfigInfo m_config{};
+        std::vector<VkPipelineColorBlendAttachmentState> m_blendAttachments{};
+
+        Handles m_handles{};
+        Handles m_pending{};    // rebuilt by a shader reload, swapped in at the next frame boundary
     };
 }
 
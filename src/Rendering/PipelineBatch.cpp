@@ -0,0 +1,25 @@
+#include "PipelineBatch.h"
+
+#include <stdexcept>
+
+void vov::PipelineBatch::Begin() {
+    if (m_active) {
+        throw std::runtime_error("pipeline batch already started!");
+    }
+    m_active = true;
+}
+
+void vov::PipelineBatch::End() {
+    m_active = false;
+    // The calling thread compiles too while it waits, a build that threw comes back out of here
+    JobSystem::GetInstance().Wait(m_counter);
+}
+
+void vov::PipelineBatch::Submit(const char* name, std::function<void()> build) {
+    if (!m_active) {
+        build();
+        return;
+    }
+
+    JobSystem::GetInstance().Schedule(name, std::move(build), &m_counter);
+}
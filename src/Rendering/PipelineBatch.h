@@ -0,0 +1,33 @@
+#ifndef PIPELINEBATCH_H
+#define PIPELINEBATCH_H
+
+#include <functional>
+
+#include "Core/JobSystem.h"
+#include "Utils/Singleton.h"
+
+namespace vov {
+    // Pipelines made between Begin and End compile as jobs, all sharing the device's pipeline cache, which Vulkan
+    // synchronizes itself. End joins them, nothing may bind or destroy one of them before that. Outside a batch
+    // pipelines are built right away like before
+    class PipelineBatch final : public Singleton<PipelineBatch> {
+    public:
+        void Begin();
+        // Rethrows the first thing a build threw
+        void End();
+
+        [[nodiscard]] bool IsActive() const { return m_active; }
+
+        // Only the pipeline's own handles may be touched in build, anything shared has to be done before
+        void Submit(const char* name, std::function<void()> build);
+
+    private:
+        friend class Singleton;
+        PipelineBatch() = default;
+
+        JobCounter m_counter{};
+        bool m_active{false};
+    };
+}
+
+#endif //PIPELINEBATCH_H
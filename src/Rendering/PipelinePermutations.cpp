@@ -0,0 +1,32 @@
+#include "PipelinePermutations.h"
+
+#include <cassert>
+
+namespace vov {
+    PipelinePermutations::PipelinePermutations(Device& device, const std::string& vertPath, const std::string& fragPath, const PipelineConfigInfo& configInfo, uint32_t flagCount):
+        m_device{device}, m_vertPath{vertPath}, m_fragPath{fragPath}, m_flagCount{flagCount} {
+        assert(flagCount <= 32 && "a key only has 32 flags");
+        Pipeline::CopyConfigInfo(configInfo, m_config, m_blendAttachments);
+    }
+
+    const Pipeline& PipelinePermutations::Get(uint32_t key) {
+        if (m_flagCount < 32) {
+            key &= (1u << m_flagCount) - 1;
+        }
+
+        auto it = m_pipelines.find(key);
+        if (it != m_pipelines.end()) {
+            return *it->second;
+        }
+
+        PipelineConfigInfo config = m_config;
+        config.name = m_config.name + " #" + std::to_string(key);
+        config.specializationConstants.resize(m_flagCount);
+        for (uint32_t flag = 0; flag < m_flagCount; ++flag) {
+            config.specializationConstants[flag] = (key >> flag) & 1u ? VK_TRUE : VK_FALSE;
+        }
+
+        it = m_pipelines.emplace(key, std::make_unique<Pipeline>(m_device, m_vertPath, m_fragPath, config)).first;
+        return *it->second;
+    }
+}
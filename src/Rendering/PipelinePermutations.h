@@ -0,0 +1,42 @@
+#ifndef PIPELINEPERMUTATIONS_H
+#define PIPELINEPERMUTATIONS_H
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Pipeline.h"
+
+namespace vov {
+    // Pipelines of one shader pair that only differ in boolean specialization constants, bit i of a key is constant_id i.
+    // A permutation is made the first time it's asked for and goes through the device's pipeline cache, so after
+    // the first run it costs a cache hit. Outside a PipelineBatch that happens right away on the calling thread
+    class PipelinePermutations final {
+    public:
+        PipelinePermutations(Device& device, const std::string& vertPath, const std::string& fragPath, const PipelineConfigInfo& configInfo, uint32_t flagCount);
+
+        PipelinePermutations(const PipelinePermutations& other) = delete;
+        PipelinePermutations(PipelinePermutations&& other) noexcept = delete;
+        PipelinePermutations& operator=(const PipelinePermutations& other) = delete;
+        PipelinePermutations& operator=(PipelinePermutations&& other) noexcept = delete;
+
+        // Bits past flagCount are ignored. Not thread safe, call it where the draws get collected
+        [[nodiscard]] const Pipeline& Get(uint32_t key);
+
+        [[nodiscard]] size_t GetCount() const { return m_pipelines.size(); }
+
+    private:
+        Device& m_device;
+
+        std::string m_vertPath{};
+        std::string m_fragPath{};
+        PipelineConfigInfo m_config{};
+        std::vector<VkPipelineColorBlendAttachmentState> m_blendAttachments{};
+        uint32_t m_flagCount{0};
+
+        std::unordered_map<uint32_t, std::unique_ptr<Pipeline>> m_pipelines{};
+    };
+}
+
+#endif //PIPELINEPERMUTATIONS_H
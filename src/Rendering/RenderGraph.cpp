@@ -0,0 +1,433 @@
+#include "RenderGraph.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+    constexpr VkAccessFlags2 WRITE_ACCESS = VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+                                            VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT | VK_ACCESS_2_TRANSFER_WRITE_BIT;
+
+    void RecordBarriers(VkCommandBuffer commandBuffer, const std::vector<VkImageMemoryBarrier2>& imageBarriers, const VkMemoryBarrier2& memoryBarrier) {
+        const bool hasMemoryBarrier = memoryBarrier.srcStageMask != VK_PIPELINE_STAGE_2_NONE || memoryBarrier.dstStageMask != VK_PIPELINE_STAGE_2_NONE;
+        if (imageBarriers.empty() && !hasMemoryBarrier) {
+            return;
+        }
+
+        VkDependencyInfo dependencyInfo{};
+        dependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+        dependencyInfo.memoryBarrierCount = hasMemoryBarrier ? 1 : 0;
+        dependencyInfo.pMemoryBarriers = &memoryBarrier;
+        dependencyInfo.imageMemoryBarrierCount = static_cast<uint32_t>(imageBarriers.size());
+        dependencyInfo.pImageMemoryBarriers = imageBarriers.data();
+        vkCmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+    }
+}
+
+void vov::RenderGraph::PassBuilder::Read(Resource resource, Usage usage) {
+    m_graph.m_passes[m_pass].accesses.push_back({resource, usage});
+}
+
+void vov::RenderGraph::PassBuilder::Write(Resource resource, Usage usage) {
+    m_graph.m_passes[m_pass].accesses.push_back({resource, usage});
+}
+
+vov::RenderGraph::Resource vov::RenderGraph::PassBuilder::Create(const RenderTargetPool::Description& description, Usage usage) {
+    const auto resource = static_cast<Resource>(m_graph.m_resources.size());
+    ResourceNode& node = m_graph.m_resources.emplace_back();
+    node.name = description.name;
+    node.transient = true;
+    node.description = description;
+
+    Write(resource, usage);
+    return resource;
+}
+
+void vov::RenderGraph::PassBuilder::SideEffect() {
+    m_graph.m_passes[m_pass].sideEffect = true;
+}
+
+vov::RenderGraph::RenderGraph(RenderTargetPool& targets): m_targets{targets} {
+}
+
+void vov::RenderGraph::Reset() {
+    m_resources.clear();
+    m_passes.clear();
+
+    ++m_frame;
+    std::erase_if(m_states, [&] (const auto& entry) {
+        return entry.second.lastFrame + STATE_LIFETIME < m_frame;
+    });
+}
+
+vov::RenderGraph::Resource vov::RenderGraph::ImportImage(const std::string& name, Image& image) {
+    ResourceNode& node = m_resources.emplace_back();
+    node.name = name;
+    node.image = &image;
+    return static_cast<Resource>(m_resources.size() - 1);
+}
+
+vov::RenderGraph::Resource vov::RenderGraph::ImportBuffer(const std::string& name, VkBuffer buffer) {
+    ResourceNode& node = m_resources.emplace_back();
+    node.name = name;
+    node.buffer = buffer;
+    return static_cast<Resource>(m_resources.size() - 1);
+}
+
+void vov::RenderGraph::Export(Resource resource, Usage usage) {
+    m_resources[resource].exported = true;
+    m_resources[resource].exportUsage = usage;
+}
+
+void vov::RenderGraph::AddPass(const std::string& name, const std::function<void(PassBuilder&)>& setup, std::function<void(VkCommandBuffer)> execute) {
+    PassNode& pass = m_passes.emplace_back();
+    pass.name = name;
+    pass.execute = std::move(execute);
+
+    PassBuilder builder{*this, static_cast<uint32_t>(m_passes.size() - 1)};
+    setup(builder);
+}
+
+void vov::RenderGraph::Compile() {
+    m_stats = {};
+    m_stats.passes = static_cast<uint32_t>(m_passes.size());
+
+    Cull();
+    AllocateTransients();
+
+    // Transients start over every frame, whatever the last user left in them is thrown away
+    std::vector<bool> written(m_resources.size(), false);
+
+    for (PassNode& pass : m_passes) {
+        if (pass.culled) {
+            continue;
+        }
+
+        // Everything a pass does to one resource goes into one barrier
+        std::vector<std::pair<Resource, UsageInfo>> merged{};
+        for (const Access& access : pass.accesses) {
+            const UsageInfo info = GetUsageInfo(access.usage);
+            const auto existing = std::ranges::find(merged, access.resource, &std::pair<Resource, UsageInfo>::first);
+            if (existing == merged.end()) {
+                merged.emplace_back(access.resource, info);
+                continue;
+            }
+
+            if (m_resources[access.resource].image != nullptr && existing->second.layout != info.layout) {
+                throw std::runtime_error("failed to compile render graph, " + pass.name + " uses " + m_resources[access.resource].name + " in two layouts!");
+            }
+            existing->second.stages |= info.stages;
+            existing->second.access |= info.access;
+            existing->second.write |= info.write;
+        }
+
+        for (const auto& [resource, info] : merged) {
+            const ResourceNode& node = m_resources[resource];
+            AddBarrier(pass, node, info, node.transient && !written[resource]);
+            written[resource] = true;
+        }
+
+        m_stats.barriers += static_cast<uint32_t>(pass.imageBarriers.size());
+        if (pass.memoryBarrier.srcStageMask != VK_PIPELINE_STAGE_2_NONE || pass.memoryBarrier.dstStageMask != VK_PIPELINE_STAGE_2_NONE) {
+            ++m_stats.barriers;
+        }
+    }
+
+    m_exportPass = {};
+    for (const ResourceNode& node : m_resources) {
+        if (!node.exported || node.image == nullptr) {
+            continue;
+        }
+
+        AddBarrier(m_exportPass, node, GetUsageInfo(node.exportUsage), false);
+        if (node.exportUsage == Usage::PRESENT) {
+            // Comes back through the acquire semaphore, the submit waits on it at color output. Whatever touches
+            // the image first next time has to start from there
+            State& state = GetState(GetKey(node));
+            state.writeStages = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+            state.writeAccess = VK_ACCESS_2_NONE;
+            state.readStages = VK_PIPELINE_STAGE_2_NONE;
+            state.visibleStages = VK_PIPELINE_STAGE_2_NONE;
+            state.visibleAccess = VK_ACCESS_2_NONE;
+        }
+    }
+    m_stats.barriers += static_cast<uint32_t>(m_exportPass.imageBarriers.size());
+}
+
+void vov::RenderGraph::Execute(VkCommandBuffer commandBuffer) {
+    const auto record = [commandBuffer] (const PassNode& pass) {
+        RecordBarriers(commandBuffer, pass.imageBarriers, pass.memoryBarrier);
+        for (size_t i = 0; i < pass.imageBarriers.size(); ++i) {
+            const VkImageMemoryBarrier2& barrier = pass.imageBarriers[i];
+            pass.barrierImages[i]->SetCurrentState(barrier.newLayout, barrier.dstStageMask, barrier.dstAccessMask);
+        }
+    };
+
+    for (const PassNode& pass : m_passes) {
+        if (pass.culled) {
+            continue;
+        }
+
+        record(pass);
+        pass.execute(commandBuffer);
+    }
+
+    record(m_exportPass);
+}
+
+vov::Image& vov::RenderGraph::GetImage(Resource resource) const {
+    const ResourceNode& node = m_resources[resource];
+    if (node.image == nullptr) {
+        throw std::runtime_error("failed to get render graph image " + node.name + ", it is a buffer or nothing uses it!");
+    }
+    return *node.image;
+}
+
+std::string vov::RenderGraph::ToGraphviz() const {
+    std::ostringstream dot{};
+    dot << "digraph RenderGraph {\n";
+    dot << "    rankdir=LR;\n";
+    dot << "    node [fontname=\"Helvetica\"];\n";
+    dot << "    edge [fontname=\"Helvetica\", fontsize=9];\n";
+
+    for (size_t index = 0; index < m_passes.size(); ++index) {
+        const PassNode& pass = m_passes[index];
+        dot << "    pass" << index << " [shape=box, label=\"" << pass.name;
+        if (!pass.culled) {
+            const size_t barriers = pass.imageBarriers.size() + (pass.memoryBarrier.dstStageMask != VK_PIPELINE_STAGE_2_NONE ? 1 : 0);
+            dot << "\\n" << barriers << " barriers";
+        }
+        dot << "\"" << (pass.culled ? ", style=dashed, fontcolor=gray" : ", style=filled, fillcolor=\"#ffe8b0\"") << "];\n";
+    }
+
+    for (size_t index = 0; index < m_resources.size(); ++index) {
+        const ResourceNode& node = m_resources[index];
+        dot << "    resource" << index << " [shape=" << (node.buffer != VK_NULL_HANDLE ? "cylinder" : "ellipse") << ", label=\"" << node.name;
+        if (node.transient) {
+            dot << "\\ntransient";
+        }
+        if (node.exported) {
+            dot << "\\n-> " << GetUsageName(node.exportUsage);
+        }
+        dot << "\"" << (node.transient ? ", style=filled, fillcolor=\"#c8e0ff\"" : "") << "];\n";
+    }
+
+    for (size_t index = 0; index < m_passes.size(); ++index) {
+        for (const Access& access : m_passes[index].accesses) {
+            if (GetUsageInfo(access.usage).write) {
+                dot << "    pass" << index << " -> resource" << access.resource;
+            } else {
+                dot << "    resource" << access.resource << " -> pass" << index;
+            }
+            dot << " [label=\"" << GetUsageName(access.usage) << "\"" << (m_passes[index].culled ? ", style=dashed" : "") << "];\n";
+        }
+    }
+
+    dot << "}\n";
+    return dot.str();
+}
+
+vov::RenderGraph::UsageInfo vov::RenderGraph::GetUsageInfo(Usage usage) {
+    constexpr VkPipelineStageFlags2 depthStages = VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT;
+
+    switch (usage) {
+        case Usage::COLOR_ATTACHMENT:
+            return {VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, true};
+        case Usage::DEPTH_ATTACHMENT:
+            return {depthStages, VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL, true};
+        case Usage::DEPTH_READ:
+            // Same layout as writing, going back and forth between depth passes costs nothing
+            return {depthStages, VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT, VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL, false};
+        case Usage::FRAGMENT_SAMPLED:
+            return {VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, false};
+        case Usage::COMPUTE_SAMPLED:
+            return {VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, false};
+        case Usage::COMPUTE_WRITE:
+            return {VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL, true};
+        case Usage::INDIRECT:
+            return {VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT, VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED, false};
+        case Usage::TRANSFER_SRC:
+            return {VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, false};
+        case Usage::TRANSFER_DST:
+            return {VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, true};
+        case Usage::PRESENT:
+            // Presentation waits on the submit's semaphore, the barrier only has to change the layout
+            return {VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, false};
+    }
+    return {};
+}
+
+const char* vov::RenderGraph::GetUsageName(Usage usage) {
+    switch (usage) {
+        case Usage::COLOR_ATTACHMENT: return "color attachment";
+        case Usage::DEPTH_ATTACHMENT: return "depth attachment";
+        case Usage::DEPTH_READ: return "depth read";
+        case Usage::FRAGMENT_SAMPLED: return "fragment sampled";
+        case Usage::COMPUTE_SAMPLED: return "compute sampled";
+        case Usage::COMPUTE_WRITE: return "compute write";
+        case Usage::INDIRECT: return "indirect";
+        case Usage::TRANSFER_SRC: return "transfer src";
+        case Usage::TRANSFER_DST: return "transfer dst";
+        case Usage::PRESENT: return "present";
+    }
+    return "";
+}
+
+uint64_t vov::RenderGraph::GetKey(const ResourceNode& resource) const {
+    return resource.image != nullptr ? reinterpret_cast<uint64_t>(resource.image->getImage()) : reinterpret_cast<uint64_t>(resource.buffer);
+}
+
+vov::RenderGraph::State& vov::RenderGraph::GetState(uint64_t key) {
+    const auto [state, inserted] = m_states.try_emplace(key);
+    if (inserted) {
+        // Never seen, whatever touched it last might still be running
+        state->second.writeStages = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+        state->second.writeAccess = VK_ACCESS_2_MEMORY_WRITE_BIT;
+    }
+    return state->second;
+}
+
+void vov::RenderGraph::Cull() {
+    // Backwards, a pass stays when it has a side effect or writes something a pass after it needs. Writes count
+    // as reads too, an attachment loaded and added to still needs whoever wrote it before
+    std::vector<bool> needed(m_resources.size(), false);
+    for (size_t index = 0; index < m_resources.size(); ++index) {
+        needed[index] = m_resources[index].exported;
+    }
+
+    for (auto pass = m_passes.rbegin(); pass != m_passes.rend(); ++pass) {
+        const bool live = pass->sideEffect || std::ranges::any_of(pass->accesses, [&] (const Access& access) {
+            return GetUsageInfo(access.usage).write && needed[access.resource];
+        });
+
+        pass->culled = !live;
+        if (!live) {
+            ++m_stats.culledPasses;
+            continue;
+        }
+
+        for (const Access& access : pass->accesses) {
+            needed[access.resource] = true;
+        }
+    }
+}
+
+void vov::RenderGraph::AllocateTransients() {
+    constexpr uint32_t unused = std::numeric_limits<uint32_t>::max();
+    std::vector<uint32_t> firstPass(m_resources.size(), unused);
+    std::vector<uint32_t> lastPass(m_resources.size(), 0);
+
+    for (uint32_t index = 0; index < m_passes.size(); ++index) {
+        if (m_passes[index].culled) {
+            continue;
+        }
+        for (const Access& access : m_passes[index].accesses) {
+            firstPass[access.resource] = std::min(firstPass[access.resource], index);
+            lastPass[access.resource] = std::max(lastPass[access.resource], index);
+        }
+    }
+
+    std::vector<Resource> transients{};
+    for (Resource resource = 0; resource < m_resources.size(); ++resource) {
+        if (m_resources[resource].transient && firstPass[resource] != unused) {
+            transients.push_back(resource);
+        }
+    }
+    std::ranges::sort(transients, {}, [&] (Resource resource) { return firstPass[resource]; });
+
+    m_targets.BeginFrame();
+    for (const Resource resource : transients) {
+        ResourceNode& node = m_resources[resource];
+        node.image = &m_targets.Acquire(node.description, firstPass[resource], lastPass[resource]);
+    }
+    m_targets.EndFrame();
+
+    m_stats.transientImages = static_cast<uint32_t>(transients.size());
+}
+
+void vov::RenderGraph::AddBarrier(PassNode& pass, const ResourceNode& resource, const UsageInfo& usage, bool discard) {
+    State& state = GetState(GetKey(resource));
+
+    Image* image = resource.image;
+    if (image != nullptr && state.lastFrame != m_frame && image->GetCurrentLayout() != state.layout) {
+        // Something outside the graph used it since, the image tracks that itself
+        const Image::SubresourceState& imageState = image->GetState();
+        state.layout = imageState.layout;
+        state.writeStages = imageState.writeStages;
+        state.writeAccess = imageState.writeAccess;
+        state.readStages = imageState.readStages;
+        state.visibleStages = imageState.visibleStages;
+        state.visibleAccess = imageState.visibleAccess;
+    }
+    state.lastFrame = m_frame;
+
+    const bool layoutChange = image != nullptr && (discard || usage.layout != state.layout);
+
+    VkPipelineStageFlags2 srcStages{VK_PIPELINE_STAGE_2_NONE};
+    VkAccessFlags2 srcAccess{VK_ACCESS_2_NONE};
+    if (usage.write || layoutChange) {
+        // Has to wait for every read since the last write too, they can't see what this is about to do
+        srcStages = state.writeStages | state.readStages;
+        srcAccess = state.writeAccess;
+    } else if ((usage.stages & ~state.visibleStages) != 0 || (usage.access & ~state.visibleAccess) != 0) {
+        srcStages = state.writeStages;
+        srcAccess = state.writeAccess;
+    }
+
+    const bool barrier = layoutChange || srcStages != VK_PIPELINE_STAGE_2_NONE;
+    if (barrier && layoutChange) {
+        VkImageMemoryBarrier2 imageBarrier{};
+        imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+        imageBarrier.srcStageMask = srcStages;
+        imageBarrier.srcAccessMask = srcAccess;
+        imageBarrier.dstStageMask = usage.stages;
+        imageBarrier.dstAccessMask = usage.access;
+        imageBarrier.oldLayout = discard ? VK_IMAGE_LAYOUT_UNDEFINED : state.layout;
+        imageBarrier.newLayout = usage.layout;
+        imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        imageBarrier.image = image->getImage();
+
+        VkImageAspectFlags aspect = VK_IMAGE_ASPECT_COLOR_BIT;
+        if (image->HasDepth()) {
+            aspect = image->HasStencil() ? VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT : VK_IMAGE_ASPECT_DEPTH_BIT;
+        }
+        imageBarrier.subresourceRange = {aspect, 0, image->getMipLevels(), 0, 1};
+
+        pass.imageBarriers.push_back(imageBarrier);
+        pass.barrierImages.push_back(image);
+    } else if (barrier) {
+        // Same layout, a global barrier does it and they all fold into one
+        pass.memoryBarrier.srcStageMask |= srcStages;
+        pass.memoryBarrier.srcAccessMask |= srcAccess;
+        pass.memoryBarrier.dstStageMask |= usage.stages;
+        pass.memoryBarrier.dstAccessMask |= usage.access;
+    }
+
+    if (usage.write) {
+        state.writeStages = usage.stages;
+        state.writeAccess = usage.access & WRITE_ACCESS;
+        state.readStages = VK_PIPELINE_STAGE_2_NONE;
+        state.visibleStages = usage.stages;
+        state.visibleAccess = usage.access;
+    } else if (layoutChange) {
+        // The transition is a write of its own, later reads chain onto it
+        state.writeStages = usage.stages;
+        state.writeAccess = VK_ACCESS_2_NONE;
+        state.readStages = usage.stages;
+        state.visibleStages = usage.stages;
+        state.visibleAccess = usage.access;
+    } else {
+        state.readStages |= usage.stages;
+        if (barrier) {
+            state.visibleStages |= usage.stages;
+            state.visibleAccess |= usage.access;
+        }
+    }
+
+    if (image != nullptr) {
+        state.layout = usage.layout;
+    }
+}
@@ -0,0 +1,158 @@
+#ifndef RENDERGRAPH_H
+#define RENDERGRAPH_H
+
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Resources/Image.h"
+#include "Resources/RenderTargetPool.h"
+
+namespace vov {
+    // The frame as a list of passes that say which images and buffers they read and write, declared again every frame.
+    // Compile drops the passes nothing ends up using, puts the transient images into the pool by how long they live
+    // and works out the barriers. Execute records every pass behind one batched barrier with exactly the stages and
+    // accesses on both sides. What a resource was last used for carries over into the next frame, the first barrier
+    // of a frame waits on the last one's work instead of everything.
+    class RenderGraph final {
+    public:
+        // How a pass uses a resource, decides stage, access and layout
+        enum class Usage : uint32_t {
+            COLOR_ATTACHMENT,
+            DEPTH_ATTACHMENT,   // tested and written
+            DEPTH_READ,         // tested only, the pass stores nothing back
+            FRAGMENT_SAMPLED,
+            COMPUTE_SAMPLED,
+            COMPUTE_WRITE,      // storage image or buffer
+            INDIRECT,           // draw commands and counts
+            TRANSFER_SRC,
+            TRANSFER_DST,
+            PRESENT
+        };
+
+        using Resource = uint32_t;
+
+        class PassBuilder {
+        public:
+            void Read(Resource resource, Usage usage);
+            void Write(Resource resource, Usage usage);
+            // A transient image only this pass and the ones after it see, written here first
+            [[nodiscard]] Resource Create(const RenderTargetPool::Description& description, Usage usage);
+            // Kept even when nothing reads what it writes, for work the next frame builds on
+            void SideEffect();
+
+        private:
+            friend class RenderGraph;
+            PassBuilder(RenderGraph& graph, uint32_t pass): m_graph{graph}, m_pass{pass} {}
+
+            RenderGraph& m_graph;
+            uint32_t m_pass;
+        };
+
+        struct Stats {
+            uint32_t passes{0};
+            uint32_t culledPasses{0};
+            uint32_t barriers{0};       // single image or memory barriers, batched into one call per pass
+            uint32_t transientImages{0};
+        };
+
+        explicit RenderGraph(RenderTargetPool& targets);
+        ~RenderGraph() = default;
+
+        RenderGraph(const RenderGraph& other) = delete;
+        RenderGraph(RenderGraph&& other) noexcept = delete;
+        RenderGraph& operator=(const RenderGraph& other) = delete;
+        RenderGraph& operator=(RenderGraph&& other) noexcept = delete;
+
+        // Top of the frame, forgets the last one's passes and resources
+        void Reset();
+
+        [[nodiscard]] Resource ImportImage(const std::string& name, Image& image);
+        [[nodiscard]] Resource ImportBuffer(const std::string& name, VkBuffer buffer);
+        // Left in this usage after the last pass, the passes writing it are never culled
+        void Export(Resource resource, Usage usage);
+
+        void AddPass(const std::string& name, const std::function<void(PassBuilder&)>& setup, std::function<void(VkCommandBuffer)> execute);
+
+        void Compile();
+        void Execute(VkCommandBuffer commandBuffer);
+
+        // Transient images only exist between Compile and the end of the frame
+        [[nodiscard]] Image& GetImage(Resource resource) const;
+        [[nodiscard]] const Stats& GetStats() const { return m_stats; }
+        // The compiled frame for graphviz, culled passes are dashed
+        [[nodiscard]] std::string ToGraphviz() const;
+
+    private:
+        struct UsageInfo {
+            VkPipelineStageFlags2 stages{VK_PIPELINE_STAGE_2_NONE};
+            VkAccessFlags2 access{VK_ACCESS_2_NONE};
+            VkImageLayout layout{VK_IMAGE_LAYOUT_UNDEFINED};
+            bool write{false};
+        };
+
+        struct ResourceNode {
+            std::string name{};
+            Image* image{nullptr};
+            VkBuffer buffer{VK_NULL_HANDLE};
+            bool transient{false};
+            RenderTargetPool::Description description{};
+            bool exported{false};
+            Usage exportUsage{Usage::PRESENT};
+        };
+
+        struct Access {
+            Resource resource{0};
+            Usage usage{Usage::COLOR_ATTACHMENT};
+        };
+
+        struct PassNode {
+            std::string name{};
+            std::vector<Access> accesses{};
+            std::function<void(VkCommandBuffer)> execute{};
+            bool sideEffect{false};
+            bool culled{false};
+
+            std::vector<VkImageMemoryBarrier2> imageBarriers{};
+            std::vector<Image*> barrierImages{};    // to move their tracked layout along
+            VkMemoryBarrier2 memoryBarrier{VK_STRUCTURE_TYPE_MEMORY_BARRIER_2};
+        };
+
+        // Of an image or buffer, across passes and frames
+        struct State {
+            VkPipelineStageFlags2 writeStages{VK_PIPELINE_STAGE_2_NONE};
+            VkAccessFlags2 writeAccess{VK_ACCESS_2_NONE};
+            VkPipelineStageFlags2 readStages{VK_PIPELINE_STAGE_2_NONE};    // read since the last write
+            VkPipelineStageFlags2 visibleStages{VK_PIPELINE_STAGE_2_NONE}; // already waited on the last write
+            VkAccessFlags2 visibleAccess{VK_ACCESS_2_NONE};
+            VkImageLayout layout{VK_IMAGE_LAYOUT_UNDEFINED};                // as of the passes compiled so far
+            uint64_t lastFrame{0};
+        };
+
+        // Unused for this many frames they are dropped, a resource seen again just gets a conservative first barrier
+        static constexpr uint64_t STATE_LIFETIME{16};
+
+        [[nodiscard]] static UsageInfo GetUsageInfo(Usage usage);
+        [[nodiscard]] static const char* GetUsageName(Usage usage);
+        [[nodiscard]] uint64_t GetKey(const ResourceNode& resource) const;
+        [[nodiscard]] State& GetState(uint64_t key);
+
+        void Cull();
+        void AllocateTransients();
+        void AddBarrier(PassNode& pass, const ResourceNode& resource, const UsageInfo& usage, bool discard);
+
+        RenderTargetPool& m_targets;
+
+        std::vector<ResourceNode> m_resources{};
+        std::vector<PassNode> m_passes{};
+        PassNode m_exportPass{};    // only the barriers after the last pass
+
+        std::unordered_map<uint64_t, State> m_states{};
+        uint64_t m_frame{0};
+
+        Stats m_stats{};
+    };
+}
+
+#endif //RENDERGRAPH_H
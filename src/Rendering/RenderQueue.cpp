@@ -0,0 +1,160 @@
+#include "RenderQueue.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+
+#include "Pipeline.h"
+#include "Scene/Mesh.h"
+
+void vov::RenderQueue::Push(const Pipeline& pipeline, VkPipelineLayout pipelineLayout, const Mesh& mesh, float viewDepth, VkDescriptorSet materialSet, const IndirectArgs& indirect) {
+    const uint32_t pipelineId = GetId(m_pipelineIds, reinterpret_cast<uintptr_t>(&pipeline), PIPELINE_BITS);
+    const uint32_t materialId = materialSet != VK_NULL_HANDLE ? GetId(m_materialIds, reinterpret_cast<uint64_t>(materialSet), MATERIAL_BITS) : 0;
+    const uint32_t geometryId = GetId(m_geometryIds, reinterpret_cast<uint64_t>(mesh.GetVertexBuffer()->getBuffer()), GEOMETRY_BITS);
+
+    DrawPacket packet{};
+    packet.key = MakeKey(pipelineId, materialId, geometryId, viewDepth);
+    packet.pipeline = &pipeline;
+    packet.pipelineLayout = pipelineLayout;
+    packet.materialSet = materialSet;
+    packet.mesh = &mesh;
+    packet.indirect = indirect;
+    m_packets.push_back(packet);
+}
+
+void vov::RenderQueue::Sort() {
+    std::ranges::sort(m_packets, {}, &DrawPacket::key);
+}
+
+void vov::RenderQueue::Record(VkCommandBuffer commandBuffer) {
+    m_stats = RecordRange(commandBuffer, 0, m_packets.size());
+}
+
+void vov::RenderQueue::Record(VkCommandBuffer commandBuffer, SecondaryRecorder* recorder, uint32_t frameIndex, const SecondaryRecorder::Inheritance& inheritance, const SetupFunction& setup) {
+    const uint32_t sliceCount = recorder != nullptr ? recorder->GetSliceCount(m_packets.size()) : 0;
+    if (sliceCount == 0) {
+        setup(commandBuffer);
+        Record(commandBuffer);
+        return;
+    }
+
+    std::array<Stats, SecondaryRecorder::MAX_SLICES> sliceStats{};
+    recorder->Record(commandBuffer, frameIndex, inheritance, m_packets.size(), [&] (VkCommandBuffer secondary, size_t begin, size_t end, uint32_t slice) {
+        setup(secondary);
+        sliceStats[slice] = RecordRange(secondary, begin, end);
+    });
+
+    m_stats = {};
+    for (uint32_t slice = 0; slice < sliceCount; ++slice) {
+        m_stats.draws += sliceStats[slice].draws;
+        m_stats.pipelineBinds += sliceStats[slice].pipelineBinds;
+        m_stats.descriptorSetBinds += sliceStats[slice].descriptorSetBinds;
+        m_stats.vertexBufferBinds += sliceStats[slice].vertexBufferBinds;
+        m_stats.indexBufferBinds += sliceStats[slice].indexBufferBinds;
+        m_stats.skipped += sliceStats[slice].skipped;
+    }
+    m_stats.secondaries = sliceCount;
+}
+
+VkRenderingFlags vov::RenderQueue::GetRenderingFlags(const SecondaryRecorder* recorder) const {
+    return recorder != nullptr ? recorder->GetRenderingFlags(m_packets.size()) : 0;
+}
+
+vov::RenderQueue::Stats vov::RenderQueue::RecordRange(VkCommandBuffer commandBuffer, size_t begin, size_t end) const {
+    Stats stats{};
+
+    const Pipeline* boundPipeline = nullptr;
+    VkDescriptorSet boundMaterial = VK_NULL_HANDLE;
+    VkBuffer boundVertexBuffer = VK_NULL_HANDLE;
+    VkBuffer boundIndexBuffer = VK_NULL_HANDLE;
+
+    for (size_t i = begin; i < end; ++i) {
+        const DrawPacket& packet = m_packets[i];
+        const Mesh& mesh = *packet.mesh;
+
+        if (packet.pipeline != boundPipeline) {
+            packet.pipeline->bind(commandBuffer);
+            boundPipeline = packet.pipeline;
+            ++stats.pipelineBinds;
+        } else {
+            ++stats.skipped;
+        }
+
+        if (packet.materialSet != VK_NULL_HANDLE) {
+            if (packet.materialSet != boundMaterial) {
+                vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, packet.pipelineLayout, m_materialSetIndex, 1, &packet.materialSet, 0, nullptr);
+                boundMaterial = packet.materialSet;
+                ++stats.descriptorSetBinds;
+            } else {
+                ++stats.skipped;
+            }
+        }
+
+        const VkBuffer vertexBuffer = mesh.GetVertexBuffer()->getBuffer();
+        if (vertexBuffer != boundVertexBuffer) {
+            constexpr VkDeviceSize offset = 0;
+            vkCmdBindVertexBuffers(commandBuffer, 0, 1, &vertexBuffer, &offset);
+            boundVertexBuffer = vertexBuffer;
+            ++stats.vertexBufferBinds;
+        } else {
+            ++stats.skipped;
+        }
+
+        if (mesh.IsIndexed()) {
+            const VkBuffer indexBuffer = mesh.GetIndexBuffer()->getBuffer();
+            if (indexBuffer != boundIndexBuffer) {
+                vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+                boundIndexBuffer = indexBuffer;
+                ++stats.indexBufferBinds;
+            } else {
+                ++stats.skipped;
+            }
+        }
+
+        if (packet.indirect.buffer != VK_NULL_HANDLE) {
+            mesh.drawIndirect(commandBuffer, packet.indirect.buffer, packet.indirect.offset);
+        } else {
+            mesh.draw(commandBuffer);
+        }
+        ++stats.draws;
+    }
+
+    return stats;
+}
+
+float vov::RenderQueue::ViewDepth(const glm::mat4& view, const glm::mat4& world, const Mesh& mesh) {
+    const glm::vec3 center = (mesh.GetBoundingBox().min + mesh.GetBoundingBox().max) * 0.5f;
+    return -(view * world * glm::vec4(center, 1.f)).z;
+}
+
+uint64_t vov::RenderQueue::MakeKey(uint32_t pipelineId, uint32_t materialId, uint32_t geometryId, float viewDepth) const {
+    // Positive floats sort the same as their bits, the top 16 keep the exponent so near objects get the most precision
+    const uint64_t depth = std::bit_cast<uint32_t>(std::max(viewDepth, 0.f)) >> (32 - DEPTH_BITS);
+    const uint64_t pipeline = pipelineId;
+    const uint64_t material = materialId;
+    const uint64_t geometry = geometryId;
+
+    if (m_order == Order::DEPTH_FIRST) {
+        return pipeline << (DEPTH_BITS + MATERIAL_BITS + GEOMETRY_BITS) |
+               depth << (MATERIAL_BITS + GEOMETRY_BITS) |
+               material << GEOMETRY_BITS |
+               geometry;
+    }
+
+    return pipeline << (MATERIAL_BITS + GEOMETRY_BITS + DEPTH_BITS) |
+           material << (GEOMETRY_BITS + DEPTH_BITS) |
+           geometry << DEPTH_BITS |
+           depth;
+}
+
+uint32_t vov::RenderQueue::GetId(std::unordered_map<uint64_t, uint32_t>& ids, uint64_t handle, uint32_t bits) {
+    if (const auto it = ids.find(handle); it != ids.end()) {
+        return it->second;
+    }
+
+    // Past the last id everything shares it, that only costs sort quality, the recorder compares real handles
+    const uint32_t maxId = (1u << bits) - 1;
+    const uint32_t id = std::min(static_cast<uint32_t>(ids.size()), maxId);
+    ids.emplace(handle, id);
+    return id;
+}
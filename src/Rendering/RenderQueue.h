@@ -0,0 +1,104 @@
+#ifndef RENDERQUEUE_H
+#define RENDERQUEUE_H
+
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Core/Device.h"
+#include "SecondaryRecorder.h"
+
+namespace vov {
+    class Mesh;
+    class Pipeline;
+
+    // Collects the mesh draws of a pass, sorts them by a packed 64 bit key and records them
+    // while skipping pipeline, descriptor set and buffer binds that are already bound.
+    class RenderQueue final {
+    public:
+        enum class Order {
+            // pipeline | material | geometry | depth, for passes where state changes cost the most
+            STATE_FIRST,
+            // pipeline | depth | material | geometry, for depth only passes, every mesh has its own buffers
+            // so grouping by geometry would throw away front to back without saving a bind
+            DEPTH_FIRST
+        };
+
+        // Arguments of a GPU written draw, see Mesh::drawIndirect
+        struct IndirectArgs {
+            VkBuffer buffer{VK_NULL_HANDLE};
+            VkDeviceSize offset{0};
+        };
+
+        struct DrawPacket {
+            uint64_t key{0};
+            const Pipeline* pipeline{nullptr};
+            VkPipelineLayout pipelineLayout{VK_NULL_HANDLE};
+            VkDescriptorSet materialSet{VK_NULL_HANDLE}; // Bound at the queue's material set index, null for none
+            const Mesh* mesh{nullptr};
+            IndirectArgs indirect{};
+        };
+
+        // Bound state changes of the last Record, skipped is how many binds the sort and the cache saved.
+        // Split recording starts every secondary with nothing bound, so the binds go up with the secondaries
+        struct Stats {
+            uint32_t draws{0};
+            uint32_t pipelineBinds{0};
+            uint32_t descriptorSetBinds{0};
+            uint32_t vertexBufferBinds{0};
+            uint32_t indexBufferBinds{0};
+            uint32_t skipped{0};
+            uint32_t secondaries{0};
+        };
+
+        // Binds what the pass would otherwise bind once, viewport, scissor and the sets that don't change per draw
+        using SetupFunction = std::function<void(VkCommandBuffer commandBuffer)>;
+
+        static constexpr uint32_t PIPELINE_BITS = 8;
+        static constexpr uint32_t MATERIAL_BITS = 20;
+        static constexpr uint32_t GEOMETRY_BITS = 20;
+        static constexpr uint32_t DEPTH_BITS = 16;
+
+        explicit RenderQueue(Order order = Order::STATE_FIRST, uint32_t materialSetIndex = 1): m_order{order}, m_materialSetIndex{materialSetIndex} {}
+
+        void Clear() { m_packets.clear(); }
+        // viewDepth is the distance along the view direction, only used for ordering, negative counts as 0
+        void Push(const Pipeline& pipeline, VkPipelineLayout pipelineLayout, const Mesh& mesh, float viewDepth, VkDescriptorSet materialSet = VK_NULL_HANDLE, const IndirectArgs& indirect = {});
+        void Sort();
+        // Sets outside the material set index are left to the pass, they don't change per draw
+        void Record(VkCommandBuffer commandBuffer);
+        // Splits the queue over secondaries when there is a recorder and enough draws, inline otherwise.
+        // setup runs on every command buffer the draws end up in, rendering has to have begun with GetRenderingFlags
+        void Record(VkCommandBuffer commandBuffer, SecondaryRecorder* recorder, uint32_t frameIndex, const SecondaryRecorder::Inheritance& inheritance, const SetupFunction& setup);
+        [[nodiscard]] VkRenderingFlags GetRenderingFlags(const SecondaryRecorder* recorder) const;
+
+        [[nodiscard]] const Stats& GetStats() const { return m_stats; }
+        [[nodiscard]] size_t GetSize() const { return m_packets.size(); }
+
+        // Depth of the mesh's bounds center along the view direction of the given view matrix, world is the mesh's
+        [[nodiscard]] static float ViewDepth(const glm::mat4& view, const glm::mat4& world, const Mesh& mesh);
+        [[nodiscard]] uint64_t MakeKey(uint32_t pipelineId, uint32_t materialId, uint32_t geometryId, float viewDepth) const;
+
+    private:
+        // Only reads the packets, safe to call for disjoint ranges from several threads
+        [[nodiscard]] Stats RecordRange(VkCommandBuffer commandBuffer, size_t begin, size_t end) const;
+
+        // Small ids handed out in first seen order, they stay the same across frames so the sort is stable
+        static uint32_t GetId(std::unordered_map<uint64_t, uint32_t>& ids, uint64_t handle, uint32_t bits);
+
+        Order m_order;
+        uint32_t m_materialSetIndex;
+
+        std::vector<DrawPacket> m_packets{};
+        Stats m_stats{};
+
+        std::unordered_map<uint64_t, uint32_t> m_pipelineIds{};
+        std::unordered_map<uint64_t, uint32_t> m_materialIds{};
+        std::unordered_map<uint64_t, uint32_t> m_geometryIds{};
+    };
+}
+
+#endif //RENDERQUEUE_H
@@ -221,7 +221,7 @@ namespace vov {
         init_info.Device = m_device.device();
         init_info.QueueFamily = m_device.FindPhysicalQueueFamilies().graphicsFamily;
         init_info.Queue = m_device.graphicsQueue();
-        init_info.PipelineCache = VK_NULL_HANDLE;
+        init_info.PipelineCache = m_device.GetPipelineCache();
         init_info.DescriptorPool = m_descriptorPool->getDescriptorPool();
         init_info.MinImageCount = Swapchain::MAX_FRAMES_IN_FLIGHT;
         init_info.ImageCount = Swapchain::MAX_FRAMES_IN_FLIGHT;
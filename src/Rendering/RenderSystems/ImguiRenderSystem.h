@@ -10,6 +10,7 @@
 #include "imgui_internal.h"
 #include "imgui_impl_vulkan.h"
 #include "Core/Device.h"
+#include "Descriptors/DescriptorPool.h"
 #include "Scene/GameObject.h"
 #include "Utils/Camera.h"
 #include "Utils/DebugLabel.h"
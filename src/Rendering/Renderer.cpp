@@ -10,15 +10,23 @@ namespace vov {
     Renderer::Renderer(Window& windowRef, Device& deviceRef): m_window{windowRef}, m_device{deviceRef} {
         recreateSwapChain();
         createCommandBuffers();
+        createQueryPool();
     }
 
     Renderer::~Renderer() {
+        if (m_queryPool != VK_NULL_HANDLE) {
+            vkDestroyQueryPool(m_device.device(), m_queryPool, nullptr);
+        }
         freeCommandBuffers();
     }
 
     VkCommandBuffer Renderer::BeginFrame() {
         assert(!m_isFrameStarted && "Frame not in progress yet??");
 
+        if (m_swapChain->IsVSync() != m_vsync) {
+            recreateSwapChain();
+        }
+
         const auto result = m_swapChain->acquireNextImage(&m_currentImageIndex);
         if (result == VK_ERROR_OUT_OF_DATE_KHR) {
             recreateSwapChain();
@@ -30,6 +38,8 @@ namespace vov {
         }
 
         m_isFrameStarted = true;
+        // Acquiring waited on this frame's fence, its last timestamps are in
+        readGpuTime();
 
         const auto commandBuffer = GetCurrentCommandBuffer();
         VkCommandBufferBeginInfo beginInfo{};
@@ -39,6 +49,11 @@ namespace vov {
             throw std::runtime_error("failed to begin recording command buffer!");
         }
 
+        if (m_queryPool != VK_NULL_HANDLE) {
+            const uint32_t firstQuery = static_cast<uint32_t>(m_currentFrameIndex) * 2;
+            vkCmdResetQueryPool(commandBuffer, m_queryPool, firstQuery, 2);
+            vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_queryPool, firstQuery);
+        }
 
         return commandBuffer;
     }
@@ -48,6 +63,11 @@ namespace vov {
 
 
         const auto commandBuffer = GetCurrentCommandBuffer();
+        if (m_queryPool != VK_NULL_HANDLE) {
+            vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_queryPool, static_cast<uint32_t>(m_currentFrameIndex) * 2 + 1);
+            m_queryWritten[m_currentFrameIndex] = true;
+        }
+
         if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
             throw std::runtime_error("failed to record command buffer!");
         }
@@ -71,16 +91,7 @@ namespace vov {
             commandBuffer == GetCurrentCommandBuffer() &&
             "Can't begin render pass on command buffer from a different frame");
 
-        m_swapChain->GetImage(static_cast<int>(m_currentImageIndex)).TransitionImageLayout(
-            commandBuffer,
-            VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
-        );
-
-        m_swapChain->GetDepthImage(static_cast<int>(m_currentImageIndex)).TransitionImageLayout(
-            commandBuffer,
-            VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL
-        );
-
+        // Both already moved into attachment layouts by the render graph
         std::array<VkClearValue, 2> clearValues{};
         clearValues[0].color = {0.01f, 0.01f, 0.01f, 1.0f};
         clearValues[1].depthStencil = {1.0f, 0};
@@ -88,7 +99,7 @@ namespace vov {
         const VkRenderingAttachmentInfoKHR color_attachment_info{
             .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR,
             .imageView = m_swapChain->GetImageView(static_cast<int>(m_currentImageIndex)),
-            .imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+            .imageLayout = m_swapChain->GetImage(static_cast<int>(m_currentImageIndex)).GetCurrentLayout(),
             .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
             .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
             .clearValue = clearValues[0],
@@ -97,7 +108,7 @@ namespace vov {
         const VkRenderingAttachmentInfo depth_attachment_info = {
             .sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR,
             .imageView = m_swapChain->GetDepthImage(static_cast<int>(m_currentImageIndex)).GetImageView(),
-            .imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+            .imageLayout = m_swapChain->GetDepthImage(static_cast<int>(m_currentImageIndex)).GetCurrentLayout(),
             .loadOp = VK_ATTACHMENT_LOAD_OP_LOAD,
             // .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
             .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
@@ -144,14 +155,6 @@ namespace vov {
         // vkCmdEndRenderPass(commandBuffer);
         vov::vkCmdEndRenderingKHR(commandBuffer);
 
-        m_swapChain->GetImage(static_cast<int>(m_currentImageIndex)).TransitionImageLayout(
-            commandBuffer, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR
-        );
-
-        m_swapChain->GetDepthImage(static_cast<int>(m_currentImageIndex)).TransitionImageLayout(
-            commandBuffer, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
-        );
-
         DebugLabel::EndCmdLabel(commandBuffer);
     }
 
@@ -183,11 +186,49 @@ namespace vov {
         commandBuffers.clear();
     }
 
+    void Renderer::createQueryPool() {
+        const VkPhysicalDeviceLimits& limits = m_device.getProperties().limits;
+        if (!limits.timestampComputeAndGraphics || limits.timestampPeriod <= 0.f) {
+            return;
+        }
+
+        VkQueryPoolCreateInfo queryPoolInfo{};
+        queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        queryPoolInfo.queryCount = Swapchain::MAX_FRAMES_IN_FLIGHT * 2;
+
+        if (vkCreateQueryPool(m_device.device(), &queryPoolInfo, nullptr, &m_queryPool) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create timestamp query pool!");
+        }
+    }
+
+    void Renderer::readGpuTime() {
+        if (m_queryPool == VK_NULL_HANDLE || !m_queryWritten[m_currentFrameIndex]) {
+            return;
+        }
+
+        std::array<uint64_t, 2> timestamps{};
+        const VkResult result = vkGetQueryPoolResults(
+            m_device.device(),
+            m_queryPool,
+            static_cast<uint32_t>(m_currentFrameIndex) * 2,
+            2,
+            sizeof(timestamps),
+            timestamps.data(),
+            sizeof(uint64_t),
+            VK_QUERY_RESULT_64_BIT);
+
+        if (result == VK_SUCCESS && timestamps[1] >= timestamps[0]) {
+            const double period = m_device.getProperties().limits.timestampPeriod;
+            m_gpuTime = static_cast<double>(timestamps[1] - timestamps[0]) * period / 1e6;
+        }
+    }
+
     void Renderer::recreateSwapChain() {
         auto extent = m_window.getExtent();
         while (extent.width == 0 || extent.height == 0) {
             extent = m_window.getExtent();
-            glfwWaitEvents();
+            m_window.WaitEvents();
         }
         vkDeviceWaitIdle(m_device.device());
 
@@ -196,10 +237,10 @@ namespace vov {
         }
 
         if (m_swapChain == nullptr) {
-            m_swapChain = std::make_unique<Swapchain>(m_device, extent);
+            m_swapChain = std::make_unique<Swapchain>(m_device, extent, m_vsync);
         } else {
             std::shared_ptr<Swapchain> oldSwapChain = std::move(m_swapChain);
-            m_swapChain = std::make_unique<Swapchain>(m_device, extent, oldSwapChain);
+            m_swapChain = std::make_unique<Swapchain>(m_device, extent, oldSwapChain, m_vsync);
 
             //TODO: fix cuz removed cuz broken :(
 
@@ -1,5 +1,6 @@
 #ifndef VRENDERPASS_H
 #define VRENDERPASS_H
+#include <array>
 #include <cassert>
 #include <functional>
 #include <memory>
@@ -53,12 +54,23 @@ namespace vov {
 
         void SetResizeCallback(const std::function<void(VkExtent2D)>& func) { m_resizeCallback = func; }
 
+        // Recreates the swapchain at the next BeginFrame when it changes
+        void SetVSync(bool vsync) { m_vsync = vsync; }
+        [[nodiscard]] bool IsVSync() const { return m_vsync; }
+
+        // Blocks until the GPU finished every frame submitted so far, not while one is being recorded
+        void WaitForGpu() const { m_swapChain->WaitForFrames(); }
+        // Of the last frame the GPU finished, in milliseconds between its first and last timestamp. 0 without timestamps
+        [[nodiscard]] double GetGpuTime() const { return m_gpuTime; }
+
         Swapchain& getSwapchain(){ return *m_swapChain; }
 
     private:
         void createCommandBuffers();
         void freeCommandBuffers();
         void recreateSwapChain();
+        void createQueryPool();
+        void readGpuTime();
 
         Window& m_window;
         Device& m_device;
@@ -68,6 +80,12 @@ namespace vov {
         uint32_t m_currentImageIndex{};
         int m_currentFrameIndex{0};
         bool m_isFrameStarted{false};
+        bool m_vsync{false};
+
+        // Two timestamps per frame in flight, around everything the frame's command buffer does
+        VkQueryPool m_queryPool{VK_NULL_HANDLE};
+        std::array<bool, Swapchain::MAX_FRAMES_IN_FLIGHT> m_queryWritten{};
+        double m_gpuTime{0};
 
         std::function<void(VkExtent2D)> m_resizeCallback{};
     };
@@ -0,0 +1,136 @@
+#include "SecondaryRecorder.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+#include "Core/JobSystem.h"
+#include "Utils/DebugLabel.h"
+
+vov::SecondaryRecorder::SecondaryRecorder(Device& deviceRef, uint32_t framesInFlight): m_device{deviceRef} {
+    m_threadCount = std::min(JobSystem::GetInstance().GetWorkerCount(), MAX_SLICES);
+
+    const uint32_t graphicsFamily = m_device.FindPhysicalQueueFamilies().graphicsFamily;
+
+    m_frames.resize(framesInFlight);
+    for (uint32_t frame = 0; frame < framesInFlight; ++frame) {
+        for (uint32_t slot = 0; slot < MAX_SLICES; ++slot) {
+            VkCommandPoolCreateInfo poolInfo{};
+            poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+            poolInfo.queueFamilyIndex = graphicsFamily;
+            // No per buffer reset, the whole pool goes at once in BeginFrame
+            poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+
+            VkCommandPool& commandPool = m_frames[frame].slots[slot].commandPool;
+            if (vkCreateCommandPool(m_device.device(), &poolInfo, nullptr, &commandPool) != VK_SUCCESS) {
+                throw std::runtime_error("failed to create secondary command pool!");
+            }
+            DebugLabel::SetObjectName(
+                reinterpret_cast<uint64_t>(commandPool),
+                VK_OBJECT_TYPE_COMMAND_POOL,
+                "Secondary Command Pool " + std::to_string(frame) + "." + std::to_string(slot)
+            );
+        }
+    }
+}
+
+vov::SecondaryRecorder::~SecondaryRecorder() {
+    // Destroying the pool frees its buffers
+    for (const FrameResources& frame : m_frames) {
+        for (const Slot& slot : frame.slots) {
+            vkDestroyCommandPool(m_device.device(), slot.commandPool, nullptr);
+        }
+    }
+}
+
+void vov::SecondaryRecorder::BeginFrame(uint32_t frameIndex) {
+    for (Slot& slot : m_frames[frameIndex].slots) {
+        if (slot.used == 0) {
+            continue;
+        }
+        vkResetCommandPool(m_device.device(), slot.commandPool, 0);
+        slot.used = 0;
+    }
+}
+
+uint32_t vov::SecondaryRecorder::GetSliceCount(size_t drawCount) const {
+    if (!m_enabled || m_threadCount < 2) {
+        return 0;
+    }
+
+    const size_t slices = std::min<size_t>(m_threadCount, drawCount / MIN_DRAWS_PER_SLICE);
+    return slices >= 2 ? static_cast<uint32_t>(slices) : 0;
+}
+
+VkRenderingFlags vov::SecondaryRecorder::GetRenderingFlags(size_t drawCount) const {
+    return GetSliceCount(drawCount) > 0 ? VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT : 0;
+}
+
+void vov::SecondaryRecorder::Record(VkCommandBuffer primary, uint32_t frameIndex, const Inheritance& inheritance, size_t drawCount, const RecordFunction& record) {
+    const uint32_t sliceCount = GetSliceCount(drawCount);
+    if (sliceCount == 0) {
+        throw std::runtime_error("failed to split draws, too few for secondary command buffers!");
+    }
+
+    // Allocated up front on this thread, the workers only touch their own slot's pool
+    FrameResources& frame = m_frames[frameIndex];
+    std::array<VkCommandBuffer, MAX_SLICES> commandBuffers{};
+    for (uint32_t slice = 0; slice < sliceCount; ++slice) {
+        commandBuffers[slice] = Acquire(frame.slots[slice]);
+    }
+
+    VkCommandBufferInheritanceRenderingInfo renderingInfo{};
+    renderingInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO;
+    renderingInfo.colorAttachmentCount = static_cast<uint32_t>(inheritance.colorFormats.size());
+    renderingInfo.pColorAttachmentFormats = inheritance.colorFormats.data();
+    renderingInfo.depthAttachmentFormat = inheritance.depthFormat;
+    renderingInfo.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+    VkCommandBufferInheritanceInfo inheritanceInfo{};
+    inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    inheritanceInfo.pNext = &renderingInfo;
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT | VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+    // One slice per job, whichever worker runs it is the only one touching that slot's pool
+    JobSystem::GetInstance().ParallelFor("Record secondaries", sliceCount, 1, [&] (size_t firstSlice, size_t lastSlice) {
+        for (size_t slice = firstSlice; slice < lastSlice; ++slice) {
+            const VkCommandBuffer commandBuffer = commandBuffers[slice];
+            if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
+                throw std::runtime_error("failed to begin recording secondary command buffer!");
+            }
+
+            // Contiguous ranges keep the sorted order, executing in slice order draws exactly what inline would
+            const size_t begin = drawCount * slice / sliceCount;
+            const size_t end = drawCount * (slice + 1) / sliceCount;
+            record(commandBuffer, begin, end, static_cast<uint32_t>(slice));
+
+            if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+                throw std::runtime_error("failed to record secondary command buffer!");
+            }
+        }
+    });
+
+    vkCmdExecuteCommands(primary, sliceCount, commandBuffers.data());
+}
+
+VkCommandBuffer vov::SecondaryRecorder::Acquire(Slot& slot) {
+    if (slot.used == slot.commandBuffers.size()) {
+        VkCommandBufferAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+        allocInfo.commandPool = slot.commandPool;
+        allocInfo.commandBufferCount = 1;
+
+        VkCommandBuffer commandBuffer{};
+        if (vkAllocateCommandBuffers(m_device.device(), &allocInfo, &commandBuffer) != VK_SUCCESS) {
+            throw std::runtime_error("failed to allocate secondary command buffer!");
+        }
+        slot.commandBuffers.push_back(commandBuffer);
+    }
+
+    return slot.commandBuffers[slot.used++];
+}
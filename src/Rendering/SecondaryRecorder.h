@@ -0,0 +1,75 @@
+#ifndef SECONDARYRECORDER_H
+#define SECONDARYRECORDER_H
+
+#include <array>
+#include <functional>
+#include <vector>
+
+#include "Core/Device.h"
+
+namespace vov {
+    // Splits a pass's draws over the job system's workers, each slice is recorded into its own secondary command buffer
+    // and the primary executes them in order. Every slot has its own command pool per frame in flight,
+    // so a worker never shares a pool and the whole frame's pools are reset at once after its fence.
+    class SecondaryRecorder final {
+    public:
+        static constexpr uint32_t MAX_SLICES = 8;
+        // Below this many draws per slice the begin/end and the rebinds in every secondary cost more than they save
+        static constexpr size_t MIN_DRAWS_PER_SLICE = 64;
+
+        // What the secondaries inherit from the primary's vkCmdBeginRendering
+        struct Inheritance {
+            std::vector<VkFormat> colorFormats{};
+            VkFormat depthFormat{VK_FORMAT_UNDEFINED};
+        };
+
+        // Records [begin, end) of the pass's draws, called once per slice on a worker thread
+        using RecordFunction = std::function<void(VkCommandBuffer commandBuffer, size_t begin, size_t end, uint32_t slice)>;
+
+        SecondaryRecorder(Device& deviceRef, uint32_t framesInFlight);
+        ~SecondaryRecorder();
+
+        SecondaryRecorder(const SecondaryRecorder& other) = delete;
+        SecondaryRecorder(SecondaryRecorder&& other) noexcept = delete;
+        SecondaryRecorder& operator=(const SecondaryRecorder& other) = delete;
+        SecondaryRecorder& operator=(SecondaryRecorder&& other) noexcept = delete;
+
+        // Only after the frame's fence, resets every pool the frame recorded into
+        void BeginFrame(uint32_t frameIndex);
+
+        // 0 when drawCount is recorded inline, how many secondaries Record would use otherwise
+        [[nodiscard]] uint32_t GetSliceCount(size_t drawCount) const;
+        // What the pass has to begin rendering with for drawCount draws
+        [[nodiscard]] VkRenderingFlags GetRenderingFlags(size_t drawCount) const;
+
+        // Rendering has to have begun with GetRenderingFlags(drawCount), the secondaries are executed into primary
+        // before this returns. Nothing is inherited but the attachments, record has to set its own state.
+        void Record(VkCommandBuffer primary, uint32_t frameIndex, const Inheritance& inheritance, size_t drawCount, const RecordFunction& record);
+
+        [[nodiscard]] bool IsEnabled() const { return m_enabled; }
+        void SetEnabled(bool enabled) { m_enabled = enabled; }
+        [[nodiscard]] uint32_t GetThreadCount() const { return m_threadCount; }
+
+    private:
+        struct Slot {
+            VkCommandPool commandPool{VK_NULL_HANDLE};
+            std::vector<VkCommandBuffer> commandBuffers{};
+            uint32_t used{0};
+        };
+
+        struct FrameResources {
+            std::array<Slot, MAX_SLICES> slots{};
+        };
+
+        // Next free secondary of the slot this frame, allocates one when earlier passes used them all
+        VkCommandBuffer Acquire(Slot& slot);
+
+        Device& m_device;
+        uint32_t m_threadCount{1};
+        bool m_enabled{true};
+
+        std::vector<FrameResources> m_frames{};
+    };
+}
+
+#endif //SECONDARYRECORDER_H
@@ -0,0 +1,229 @@
+#include "ShaderReloader.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+#include "Utils/Chalk.h"
+
+namespace {
+    bool IsStage(const std::filesystem::path& file) {
+        const std::string extension = file.extension().string();
+        return extension == ".vert" || extension == ".frag" || extension == ".comp";
+    }
+}
+
+vov::ShaderReloader::~ShaderReloader() {
+    Stop();
+}
+
+void vov::ShaderReloader::Start(const std::filesystem::path& sourceDirectory, const std::filesystem::path& outputDirectory) {
+#ifdef VOVY_GLSL_VALIDATOR
+    if (IsRunning() || !std::filesystem::is_directory(sourceDirectory)) {
+        return;
+    }
+
+    m_sourceDirectory = sourceDirectory;
+    m_outputDirectory = outputDirectory;
+    // The first scan is the baseline, the SPIR-V from the build already matches it
+    (void)CollectChanged();
+
+    m_stopping = false;
+    m_thread = std::thread(&ShaderReloader::WatchLoop, this);
+    std::cout << "Watching " << Chalk::Cyan << m_sourceDirectory.string() << Chalk::Reset << " for shader changes" << std::endl;
+#else
+    (void)sourceDirectory;
+    (void)outputDirectory;
+#endif
+}
+
+void vov::ShaderReloader::Stop() {
+    if (!IsRunning()) {
+        return;
+    }
+    {
+        std::lock_guard lock(m_stopMutex);
+        m_stopping = true;
+    }
+    m_stopCondition.notify_all();
+    m_thread.join();
+}
+
+void vov::ShaderReloader::Register(const void* owner, Reloadable reloadable) {
+    std::lock_guard lock(m_mutex);
+    m_reloadables[owner] = std::move(reloadable);
+}
+
+void vov::ShaderReloader::Unregister(const void* owner) {
+    std::lock_guard lock(m_mutex);
+    m_reloadables.erase(owner);
+    std::erase(m_pending, owner);
+}
+
+uint32_t vov::ShaderReloader::ApplyPending(const std::function<void()>& waitIdle) {
+    std::lock_guard lock(m_mutex);
+    if (m_pending.empty()) {
+        return 0;
+    }
+
+    // The old pipelines can still be in flight
+    waitIdle();
+    for (const void* owner : m_pending) {
+        m_reloadables[owner].apply();
+    }
+
+    const auto swapped = static_cast<uint32_t>(m_pending.size());
+    m_pending.clear();
+    std::cout << "Reloaded " << Chalk::Green << swapped << Chalk::Reset << " pipelines" << std::endl;
+    return swapped;
+}
+
+uint64_t vov::ShaderReloader::Hash(const std::vector<char>& data) {
+    // FNV-1a, only has to tell two versions of one file apart
+    uint64_t hash = 14695981039346656037ull;
+    for (const char byte : data) {
+        hash ^= static_cast<uint8_t>(byte);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+void vov::ShaderReloader::WatchLoop() {
+    while (true) {
+        {
+            std::unique_lock lock(m_stopMutex);
+            if (m_stopCondition.wait_for(lock, POLL_INTERVAL, [this] { return m_stopping; })) {
+                return;
+            }
+        }
+
+        std::set<std::string> compiled{};
+        for (const std::filesystem::path& stage : CollectChanged()) {
+            const std::string spirvFile = stage.filename().string() + ".spv";
+            if (Compile(stage, m_outputDirectory / spirvFile)) {
+                compiled.insert(spirvFile);
+            }
+        }
+
+        if (!compiled.empty()) {
+            Rebuild(compiled);
+        }
+    }
+}
+
+std::set<std::filesystem::path> vov::ShaderReloader::CollectChanged() {
+    std::set<std::filesystem::path> changed{};
+    std::vector<std::filesystem::path> stages{};
+
+    std::error_code error{};
+    for (const auto& entry : std::filesystem::directory_iterator(m_sourceDirectory, error)) {
+        if (!entry.is_regular_file()) {
+            continue;
+        }
+
+        const std::filesystem::path& file = entry.path();
+        const auto writeTime = entry.last_write_time(error);
+        auto [it, inserted] = m_writeTimes.try_emplace(file, writeTime);
+        if (!inserted && it->second != writeTime) {
+            it->second = writeTime;
+            changed.insert(file.filename());
+        }
+
+        if (IsStage(file)) {
+            stages.push_back(file);
+        }
+    }
+
+    // Includes don't compile on their own, whatever pulls them in (directly or through another include) does
+    std::set<std::filesystem::path> toCompile{};
+    for (const std::filesystem::path& stage : stages) {
+        std::set<std::string> visited{};
+        std::vector<std::string> open{stage.filename().string()};
+        bool dirty = false;
+        while (!open.empty() && !dirty) {
+            const std::string file = open.back();
+            open.pop_back();
+            if (!visited.insert(file).second) {
+                continue;
+            }
+
+            dirty = changed.contains(file);
+            for (std::string& include : ParseIncludes(m_sourceDirectory / file)) {
+                open.push_back(std::move(include));
+            }
+        }
+
+        if (dirty) {
+            toCompile.insert(stage);
+        }
+    }
+    return toCompile;
+}
+
+std::vector<std::string> vov::ShaderReloader::ParseIncludes(const std::filesystem::path& file) {
+    std::vector<std::string> includes{};
+    std::ifstream in(file);
+    std::string line{};
+    while (std::getline(in, line)) {
+        const size_t directive = line.find("#include");
+        if (directive == std::string::npos) {
+            continue;
+        }
+
+        const size_t begin = line.find('"', directive);
+        const size_t end = begin == std::string::npos ? std::string::npos : line.find('"', begin + 1);
+        if (end != std::string::npos) {
+            includes.push_back(line.substr(begin + 1, end - begin - 1));
+        }
+    }
+    return includes;
+}
+
+bool vov::ShaderReloader::Compile(const std::filesystem::path& source, const std::filesystem::path& output) const {
+#ifdef VOVY_GLSL_VALIDATOR
+    // Next to the real one and renamed over it, a failed compile leaves the old SPIR-V alone
+    const std::filesystem::path tempOutput = output.string() + ".tmp";
+    std::string command = "\"" VOVY_GLSL_VALIDATOR "\" -V -g \"" + source.string() + "\" -o \"" + tempOutput.string() + "\"";
+#ifdef _WIN32
+    // cmd strips the outer quotes of the whole line
+    command = "\"" + command + "\"";
+#endif
+
+    std::cout << "Compiling " << Chalk::Yellow << source.filename().string() << Chalk::Reset << std::endl;
+    if (std::system(command.c_str()) != 0) {
+        std::cerr << Chalk::Red << "Failed to compile " << source.filename().string() << ", keeping the old one" << Chalk::Reset << std::endl;
+        std::error_code error{};
+        std::filesystem::remove(tempOutput, error);
+        return false;
+    }
+
+    std::error_code error{};
+    std::filesystem::create_directories(output.parent_path(), error);
+    std::filesystem::rename(tempOutput, output, error);
+    if (error) {
+        std::cerr << "Failed to replace " << output.string() << ": " << error.message() << std::endl;
+        return false;
+    }
+    return true;
+#else
+    (void)source;
+    (void)output;
+    return false;
+#endif
+}
+
+void vov::ShaderReloader::Rebuild(const std::set<std::string>& spirvFiles) {
+    std::lock_guard lock(m_mutex);
+    for (auto& [owner, reloadable] : m_reloadables) {
+        const bool uses = std::ranges::any_of(reloadable.spirvFiles, [&] (const std::string& file) { return spirvFiles.contains(file); });
+        if (!uses) {
+            continue;
+        }
+
+        // Still pending from an earlier change, prepare replaces what it built then
+        if (reloadable.prepare() && std::ranges::find(m_pending, owner) == m_pending.end()) {
+            m_pending.push_back(owner);
+        }
+    }
+}
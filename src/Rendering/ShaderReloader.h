@@ -0,0 +1,78 @@
+#ifndef SHADERRELOADER_H
+#define SHADERRELOADER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Utils/Singleton.h"
+
+namespace vov {
+    // Watches the GLSL sources, recompiles what changed (and everything including it) with glslangValidator on its
+    // own thread and builds the replacement pipelines right there. ApplyPending swaps them all in at once, call it at
+    // a frame boundary while nothing is recording
+    class ShaderReloader final : public Singleton<ShaderReloader> {
+    public:
+        struct Reloadable {
+            std::vector<std::string> spirvFiles{};     // file names, like "lightingPass.frag.spv"
+            // On the watcher thread, builds the new pipeline next to the old one. False when the SPIR-V is the same
+            // as what was built last
+            std::function<bool()> prepare{};
+            // At the frame boundary, only after prepare said yes
+            std::function<void()> apply{};
+        };
+
+        // Nothing happens without a glslangValidator found at configure time
+        void Start(const std::filesystem::path& sourceDirectory, const std::filesystem::path& outputDirectory);
+        void Stop();
+
+        [[nodiscard]] bool IsRunning() const { return m_thread.joinable(); }
+
+        // Keyed on the owner, Unregister blocks while its replacement is being built
+        void Register(const void* owner, Reloadable reloadable);
+        void Unregister(const void* owner);
+
+        // Returns how many pipelines were swapped, waitIdle is called first when there are any
+        uint32_t ApplyPending(const std::function<void()>& waitIdle);
+
+        [[nodiscard]] static uint64_t Hash(const std::vector<char>& data);
+
+    private:
+        friend class Singleton;
+        ShaderReloader() = default;
+        ~ShaderReloader() override;
+
+        void WatchLoop();
+        // Stages that have to be compiled again, the changed ones and those that include them
+        [[nodiscard]] std::set<std::filesystem::path> CollectChanged();
+        [[nodiscard]] static std::vector<std::string> ParseIncludes(const std::filesystem::path& file);
+        [[nodiscard]] bool Compile(const std::filesystem::path& source, const std::filesystem::path& output) const;
+        void Rebuild(const std::set<std::string>& spirvFiles);
+
+        static constexpr auto POLL_INTERVAL = std::chrono::milliseconds(300);
+
+        std::filesystem::path m_sourceDirectory{};
+        std::filesystem::path m_outputDirectory{};
+        std::map<std::filesystem::path, std::filesystem::file_time_type> m_writeTimes{};
+
+        std::thread m_thread{};
+        std::mutex m_stopMutex{};
+        std::condition_variable m_stopCondition{};
+        bool m_stopping{false};
+
+        // Held while a replacement is built, so its owner can't go away in the middle of it
+        std::mutex m_mutex{};
+        std::map<const void*, Reloadable> m_reloadables{};
+        std::vector<const void*> m_pending{};
+    };
+}
+
+#endif //SHADERRELOADER_H
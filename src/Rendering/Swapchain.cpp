@@ -7,13 +7,13 @@
 #include <utility>
 
 namespace vov {
-    Swapchain::Swapchain(Device& deviceRef, VkExtent2D windowExtent): m_device(deviceRef), m_windowExtent{windowExtent} {
+    Swapchain::Swapchain(Device& deviceRef, VkExtent2D windowExtent, bool vsync): m_device(deviceRef), m_windowExtent{windowExtent}, m_vsync{vsync} {
         createSwapChain();
         createDepthResources();
         createSyncObjects();
     }
 
-    Swapchain::Swapchain(Device& deviceRef, VkExtent2D windowExtent, std::shared_ptr<Swapchain> previous): m_device{deviceRef}, m_windowExtent{windowExtent}, m_oldSwapChain{std::move(previous)} {
+    Swapchain::Swapchain(Device& deviceRef, VkExtent2D windowExtent, std::shared_ptr<Swapchain> previous, bool vsync): m_device{deviceRef}, m_windowExtent{windowExtent}, m_vsync{vsync}, m_oldSwapChain{std::move(previous)} {
         init();
         m_oldSwapChain = nullptr;
     }
@@ -80,6 +80,15 @@ namespace vov {
         return result;
     }
 
+    void Swapchain::WaitForFrames() const {
+        vkWaitForFences(
+            m_device.device(),
+            static_cast<uint32_t>(m_inFlightFences.size()),
+            m_inFlightFences.data(),
+            VK_TRUE,
+            std::numeric_limits<uint64_t>::max());
+    }
+
     VkResult Swapchain::submitCommandBuffers(const VkCommandBuffer* buffers, const uint32_t* imageIndex) {
         if (m_imagesInFlight[*imageIndex] != VK_NULL_HANDLE) {
             vkWaitForFences(m_device.device(), 1, &m_imagesInFlight[*imageIndex], VK_TRUE, UINT64_MAX);
@@ -149,6 +158,11 @@ namespace vov {
         createInfo.imageExtent = extent;
         createInfo.imageArrayLayers = 1;
         createInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+        // Needed for frame captures, not every surface supports it though
+        m_canCapture = (swapChainSupport.capabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_SRC_BIT) != 0;
+        if (m_canCapture) {
+            createInfo.imageUsage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        }
 
         const QueueFamilyIndices indices = m_device.FindPhysicalQueueFamilies();
         const uint32_t queueFamilyIndices[] = {indices.graphicsFamily, indices.presentFamily};
@@ -181,7 +195,7 @@ namespace vov {
                 m_device,
                 extent,
                 surfaceFormat.format,
-                VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
+                createInfo.imageUsage,
                 VMA_MEMORY_USAGE_GPU_ONLY,
                 image);
             m_swapChainImages.push_back(std::move(vovImage));
@@ -246,6 +260,10 @@ namespace vov {
     }
 
     VkPresentModeKHR Swapchain::chooseSwapPresentMode(const std::vector<VkPresentModeKHR>& availablePresentModes) {
+        // Always supported
+        if (m_vsync) {
+            return VK_PRESENT_MODE_FIFO_KHR;
+        }
         for (const auto& availablePresentMode: availablePresentModes) {
             if (availablePresentMode == VK_PRESENT_MODE_MAILBOX_KHR) {
                 return availablePresentMode;
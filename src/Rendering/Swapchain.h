@@ -10,8 +10,9 @@ namespace vov {
     public:
         static constexpr int MAX_FRAMES_IN_FLIGHT = 2;
 
-        explicit Swapchain(Device& deviceRef, VkExtent2D windowExtent);
-        Swapchain(Device& deviceRef, VkExtent2D windowExtent, std::shared_ptr<Swapchain> previous);
+        // vsync picks FIFO, presentation then paces the frames. Otherwise mailbox when there is one
+        explicit Swapchain(Device& deviceRef, VkExtent2D windowExtent, bool vsync = false);
+        Swapchain(Device& deviceRef, VkExtent2D windowExtent, std::shared_ptr<Swapchain> previous, bool vsync = false);
 
         ~Swapchain();
 
@@ -25,12 +26,16 @@ namespace vov {
         [[nodiscard]] uint32_t GetWidth() const { return m_swapChainExtent.width; }
         [[nodiscard]] uint32_t GetHeight() const { return m_swapChainExtent.height; }
         [[nodiscard]] float ExtentAspectRatio() const;
+        [[nodiscard]] bool CanCapture() const { return m_canCapture; }
+        [[nodiscard]] bool IsVSync() const { return m_vsync; }
 
         [[nodiscard]] VkImageView GetImageView(int index) const {
             return m_swapChainImages[index]->GetImageView();
         }
 
         VkResult acquireNextImage(uint32_t* imageIndex) const;
+        // Blocks until the GPU is done with everything submitted through this swapchain
+        void WaitForFrames() const;
         VkResult submitCommandBuffers(const VkCommandBuffer* buffers, const uint32_t* imageIndex);
 
         [[nodiscard]] Image& GetImage(int index) const;
@@ -66,6 +71,8 @@ namespace vov {
         std::vector<VkFence> m_inFlightFences;
         std::vector<VkFence> m_imagesInFlight;
         size_t m_currentFrame = 0;
+        bool m_canCapture = false;
+        bool m_vsync = false;
 
         std::shared_ptr<Swapchain> m_oldSwapChain;
     };
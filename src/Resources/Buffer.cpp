@@ -52,6 +52,10 @@ namespace vov {
         vmaFlushAllocation(m_device.allocator(), m_allocation, 0, VK_WHOLE_SIZE);
     }
 
+    void Buffer::invalidate() const {
+        vmaInvalidateAllocation(m_device.allocator(), m_allocation, 0, VK_WHOLE_SIZE);
+    }
+
     void Buffer::SetName(const std::string& name) const {
         DebugLabel::NameBuffer(m_buffer, name);
         if (m_allocation) {
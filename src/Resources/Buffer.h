@@ -16,6 +16,7 @@ namespace vov {
         [[nodiscard]] VkDescriptorBufferInfo descriptorInfo(VkDeviceSize size = VK_WHOLE_SIZE, VkDeviceSize offset = 0) const;
 
         void flush() const;
+        void invalidate() const;
 
         [[nodiscard]] VkBuffer getBuffer() const { return m_buffer; }
         [[nodiscard]] VmaAllocation getAllocation() const { return m_allocation; }
@@ -1,140 +1,77 @@
 #include "GeoBuffer.h"
 
-#include "Buffer.h"
-#include "glm/vec4.hpp"
+vov::GeoBuffer::GeoBuffer(vov::Device& deviceRef, RenderGraph& graph): m_device{deviceRef}, m_graph{graph} {
+    // Octahedral, two channels are enough for a unit vector. Float when 16 bit snorm can't be rendered to
+    const VkFormat normalFormat = m_device.FindSupportedFormat(
+        {VK_FORMAT_R16G16_SNORM, VK_FORMAT_R16G16_SFLOAT},
+        VK_IMAGE_TILING_OPTIMAL,
+        VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT
+    );
 
-vov::GeoBuffer::GeoBuffer(vov::Device& deviceRef, VkExtent2D size): m_device{deviceRef}, m_extent{size}  {
-    CreateImages();
+    // Selection holds Mesh::GetSceneIndex + 1, 0 where nothing was drawn
+    m_formats = {VK_FORMAT_R8G8B8A8_SRGB, normalFormat, VK_FORMAT_R8G8_UNORM, VK_FORMAT_R32_UINT};
 }
 
-void vov::GeoBuffer::Resize(VkExtent2D size) {
-    DestroyImages();
-    m_extent = size;
-    CreateImages();
-}
+void vov::GeoBuffer::Declare(RenderGraph::PassBuilder& pass, bool writeSelection) {
+    constexpr VkImageUsageFlags usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    constexpr auto attachment = RenderGraph::Usage::COLOR_ATTACHMENT;
 
-void vov::GeoBuffer::TransitionWriting(VkCommandBuffer commandBuffer) {
-    m_RenderingAttachments.clear();
-    m_RenderingAttachments.reserve(m_allImages.size());
+    m_resources[ALBEDO] = pass.Create({"Albedo Buffer", m_formats[ALBEDO], usage}, attachment);
+    m_resources[NORMAL] = pass.Create({"Normal Buffer", m_formats[NORMAL], usage}, attachment);
+    m_resources[METALLIC_ROUGHNESS] = pass.Create({"MetallicRoughness Buffer", m_formats[METALLIC_ROUGHNESS], usage}, attachment);
 
-    for (Image*& image : m_allImages) {
-        image->TransitionImageLayout(commandBuffer,VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
-        AddRenderAttachment(*image);
+    m_selectionWritten = writeSelection;
+    if (writeSelection) {
+        // Nothing in the graph reads it, it lives as long as the pass keeps the rest alive
+        m_resources[SELECTION] = pass.Create({"Selection Buffer", m_formats[SELECTION], usage | VK_IMAGE_USAGE_TRANSFER_SRC_BIT}, attachment);
     }
 }
 
-void vov::GeoBuffer::TransitionSampling(VkCommandBuffer commandBuffer) {
-    for (Image*& image : m_allImages) {
-        image->TransitionImageLayout(commandBuffer, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+void vov::GeoBuffer::DeclareSampling(RenderGraph::PassBuilder& pass) const {
+    for (const Target target : {ALBEDO, NORMAL, METALLIC_ROUGHNESS}) {
+        pass.Read(m_resources[target], RenderGraph::Usage::FRAGMENT_SAMPLED);
     }
 }
 
-glm::vec3 vov::GeoBuffer::GetPixel(VkCommandBuffer commandBuffer,glm::ivec2 screenPos, glm::ivec2 viewportSize) {
-    const int32_t flippedY{ static_cast<int32_t>(viewportSize.y - screenPos.y) };
-    glm::vec2 pixelPos{ static_cast<float>(screenPos.x) / static_cast<float>(viewportSize.x), static_cast<float>(flippedY) / static_cast<float>(viewportSize.y) };
-
-    VkBufferImageCopy region{};
-    region.bufferOffset = 0;
-    region.bufferRowLength = 0;
-    region.bufferImageHeight = 0;
-    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    region.imageSubresource.mipLevel = 0;
-    region.imageSubresource.baseArrayLayer = 0;
-    region.imageSubresource.layerCount = 1;
-    region.imageOffset = { screenPos.x, flippedY, 0 };
-    region.imageExtent = { 1, 1, 1 };
-
-    Buffer stagingBuffer{
-        m_device,
-        sizeof(glm::vec4),
-        VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-        VMA_MEMORY_USAGE_GPU_TO_CPU
-    };
-
-    vkCmdCopyImageToBuffer(commandBuffer, m_selectionImage->getImage(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-                           stagingBuffer.getBuffer(), 1, &region);
-
-    stagingBuffer.map();
-    const auto* color = static_cast<uint8_t*>(stagingBuffer.GetRawData()); // Assuming VK_FORMAT_R8G8B8A8_UNORM
-    glm::vec4 pixelData{};
-
-    pixelData = glm::vec4(color[0], color[1], color[2], color[3]);
-    stagingBuffer.unmap();
-
-    return {pixelData.r, pixelData.g, pixelData.b};
-}
-
-void vov::GeoBuffer::DestroyImages() {
-    m_albedo.reset();
-    m_normal.reset();
-    m_worldPos.reset();
-    m_metalicRoughness.reset();
-
-    m_allImages.clear();
-    m_RenderingAttachments.clear();
+std::vector<VkRenderingAttachmentInfo> vov::GeoBuffer::GetRenderingAttachments() const {
+    std::vector<VkRenderingAttachmentInfo> attachments{};
+    attachments.reserve(TARGET_COUNT);
+
+    for (uint32_t target = 0; target < TARGET_COUNT; ++target) {
+        VkRenderingAttachmentInfo attachmentInfo{};
+        attachmentInfo.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+        attachmentInfo.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        attachmentInfo.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+        attachmentInfo.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+        attachmentInfo.clearValue.color = { {0.f, 0.f, 0.f, 1.0f} };
+        if (target == SELECTION) {
+            attachmentInfo.clearValue.color.uint32[0] = 0;
+        }
+        if (target != SELECTION || m_selectionWritten) {
+            attachmentInfo.imageView = m_graph.GetImage(m_resources[target]).GetImageView();
+        }
+
+        attachments.emplace_back(attachmentInfo);
+    }
+    return attachments;
 }
 
-void vov::GeoBuffer::CreateImages() {
-    m_albedo = std::make_unique<Image>(
-        m_device,
-        m_extent,
-        VK_FORMAT_R32G32B32A32_SFLOAT,
-        VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-        VMA_MEMORY_USAGE_AUTO
-    );
-    m_albedo->SetName("Albedo Buffer");
-
-    m_normal = std::make_unique<Image>(
-        m_device,
-        m_extent,
-        VK_FORMAT_R8G8B8A8_UNORM,
-        VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-        VMA_MEMORY_USAGE_AUTO
-    );
-    m_normal->SetName("Normal Buffer");
-
-    m_worldPos = std::make_unique<Image>(
-        m_device,
-        m_extent,
-        VK_FORMAT_R32G32B32A32_SFLOAT,
-        VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-        VMA_MEMORY_USAGE_AUTO
-    );
-    m_worldPos->SetName("WorldPos Buffer");
-
-    m_metalicRoughness = std::make_unique<Image>(
-        m_device,
-        m_extent,
-        VK_FORMAT_R32G32B32A32_SFLOAT,
-        VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-        VMA_MEMORY_USAGE_AUTO
-    );
-    m_metalicRoughness->SetName("MetallicRoughness Buffer");
+void vov::GeoBuffer::ReadSelectionPixel(ReadbackRing& readback, VkCommandBuffer commandBuffer, uint32_t frameIndex, glm::ivec2 pixel, ReadbackRing::Callback callback) {
+    if (!m_selectionWritten) {
+        return;
+    }
 
-    m_selectionImage = std::make_unique<Image>(
-        m_device,
-        m_extent,
-        VK_FORMAT_R8G8B8A8_UNORM,
-        VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
-        VMA_MEMORY_USAGE_AUTO
-    );
-    m_selectionImage->SetName("Selection Buffer");
+    const VkExtent2D extent = GetExtent();
+    if (pixel.x < 0 || pixel.y < 0 || pixel.x >= static_cast<int>(extent.width) || pixel.y >= static_cast<int>(extent.height)) {
+        return;
+    }
 
-    m_allImages.push_back(m_albedo.get());
-    m_allImages.push_back(m_normal.get());
-    m_allImages.push_back(m_worldPos.get());
-    m_allImages.push_back(m_metalicRoughness.get());
-    m_allImages.push_back(m_selectionImage.get());
-}
+    // Back to where it was after, that barrier chains the copy onto the stages the render graph waits on next
+    Image& selection = GetSelection();
+    const VkImageLayout previousLayout = selection.GetCurrentLayout();
+    selection.TransitionImageLayout(commandBuffer, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
 
-void vov::GeoBuffer::AddRenderAttachment(const Image& image) {
-    VkRenderingAttachmentInfo attachmentInfo{};
-    attachmentInfo.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
-    attachmentInfo.imageView = image.GetImageView();
-    attachmentInfo.imageLayout = image.GetCurrentLayout();
-    attachmentInfo.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-    attachmentInfo.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-    attachmentInfo.clearValue.color = { {0.f, 0.f, 0.f, 1.0f} };
+    readback.ReadImage(commandBuffer, frameIndex, selection, {pixel.x, pixel.y}, {1, 1}, std::move(callback));
 
-    m_RenderingAttachments.emplace_back(attachmentInfo);
+    selection.TransitionImageLayout(commandBuffer, previousLayout);
 }
@@ -1,60 +1,59 @@
 #ifndef GEOBUFFER_H
 #define GEOBUFFER_H
-#include <memory>
+#include <array>
 
 #include "Image.h"
+#include "ReadbackRing.h"
 #include "Core/Device.h"
-#include "glm/vec3.hpp"
+#include "Rendering/RenderGraph.h"
+#include "glm/vec2.hpp"
 
 namespace vov {
+    // The G-buffer's targets, transient images of the render graph. Alive from the geometry pass to the lighting pass
     class GeoBuffer final {
     public:
-        explicit GeoBuffer(vov::Device& deviceRef, VkExtent2D size);
-        void Resize(VkExtent2D size);
+        GeoBuffer(vov::Device& deviceRef, RenderGraph& graph);
 
-        void TransitionWriting(VkCommandBuffer commandBuffer);
-        void TransitionSampling(VkCommandBuffer commandBuffer);
+        // Creates the targets as the pass's attachments, again every frame. Without selection that target isn't
+        // created and its attachment gets no view, the IDs are dropped instead of written out
+        void Declare(RenderGraph::PassBuilder& pass, bool writeSelection);
+        // Albedo, normal and metallic roughness, the selection IDs only matter to picking
+        void DeclareSampling(RenderGraph::PassBuilder& pass) const;
 
-        [[nodiscard]] Image& GetAlbedo() const { return *m_albedo; }
-        [[nodiscard]] Image& GetNormal() const { return *m_normal; }
-        [[nodiscard]] Image& GetWorldPos() const { return *m_worldPos; }
-        [[nodiscard]] Image& GetSpecular() const { return *m_metalicRoughness; }
-        [[nodiscard]] Image& GetSelection() const { return *m_selectionImage; }
+        // sRGB albedo, octahedral normal, metallic in r and roughness in g. Positions come from the depth buffer.
+        // Only once the graph is compiled
+        [[nodiscard]] Image& GetAlbedo() const { return m_graph.GetImage(m_resources[ALBEDO]); }
+        [[nodiscard]] Image& GetNormal() const { return m_graph.GetImage(m_resources[NORMAL]); }
+        [[nodiscard]] Image& GetSpecular() const { return m_graph.GetImage(m_resources[METALLIC_ROUGHNESS]); }
+        [[nodiscard]] Image& GetSelection() const { return m_graph.GetImage(m_resources[SELECTION]); }
+        [[nodiscard]] bool IsSelectionWritten() const { return m_selectionWritten; }
 
-        [[nodiscard]] VkExtent2D GetExtent() const { return m_extent; }
+        [[nodiscard]] VkExtent2D GetExtent() const { return GetAlbedo().GetExtent(); }
 
-        [[nodiscard]] std::vector<VkFormat> GetFormats() const { return {m_albedo->GetFormat(), m_normal->GetFormat(), m_worldPos->GetFormat(), m_metalicRoughness->GetFormat(), m_selectionImage->GetFormat()}; }
-        [[nodiscard]] std::vector<VkRenderingAttachmentInfo>& GetRenderingAttachments() { return m_RenderingAttachments; }
-        [[nodiscard]] int GetRenderAttachmentCount() const { return static_cast<int>(m_RenderingAttachments.size()); }
+        // Fixed at creation, the pipeline is built against them
+        [[nodiscard]] std::vector<VkFormat> GetFormats() const { return {m_formats.begin(), m_formats.end()}; }
+        [[nodiscard]] std::vector<VkRenderingAttachmentInfo> GetRenderingAttachments() const;
 
-        glm::vec3 GetPixel(struct ::VkCommandBuffer_T* commandBuffer, glm::ivec2 screenPos, glm::ivec2 viewportSize);
-
-        void TransitionSelectionImageToTransferSrc(VkCommandBuffer commandBuffer) {;
-            m_selectionImage->TransitionImageLayout(commandBuffer, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
-        }
-
-        void TransitionSelectionImageToColorAttachment(VkCommandBuffer commandBuffer) {
-            m_selectionImage->TransitionImageLayout(commandBuffer, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
-        }
+        // Queues a copy of one selection pixel (image space, top left origin), the callback fires a few frames later.
+        // Nothing happens when selection wasn't written this frame
+        void ReadSelectionPixel(ReadbackRing& readback, VkCommandBuffer commandBuffer, uint32_t frameIndex, glm::ivec2 pixel, ReadbackRing::Callback callback);
 
     private:
-        Device& m_device;
-
-        std::unique_ptr<Image> m_albedo;
-        std::unique_ptr<Image> m_normal;
-        std::unique_ptr<Image> m_worldPos;
-        std::unique_ptr<Image> m_metalicRoughness;
-        std::unique_ptr<Image> m_selectionImage;
+        // Also the attachment order
+        enum Target {
+            ALBEDO,
+            NORMAL,
+            METALLIC_ROUGHNESS,
+            SELECTION,
+            TARGET_COUNT
+        };
 
-        std::vector<Image*> m_allImages{};
-
-        VkExtent2D m_extent{};
-
-        void DestroyImages();
-        void CreateImages();
+        Device& m_device;
+        RenderGraph& m_graph;
+        std::array<VkFormat, TARGET_COUNT> m_formats{};
 
-        void AddRenderAttachment(const Image& image);
-        std::vector<VkRenderingAttachmentInfo> m_RenderingAttachments{};
+        std::array<RenderGraph::Resource, TARGET_COUNT> m_resources{};
+        bool m_selectionWritten{false};
     };
 }
 
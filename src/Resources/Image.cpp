@@ -4,6 +4,7 @@
 
 
 #define STB_IMAGE_IMPLEMENTATION
+#include <algorithm>
 #include <iostream>
 #include <stdexcept>
 
@@ -13,6 +14,12 @@
 
 #include <gli/gli.hpp>
 
+namespace {
+    constexpr VkAccessFlags2 WRITE_ACCESS = VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT |
+                                            VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT | VK_ACCESS_2_SHADER_WRITE_BIT |
+                                            VK_ACCESS_2_TRANSFER_WRITE_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT;
+}
+
 namespace vov {
     Image::Image(Device& device, VkExtent2D size, VkFormat format, VkImageUsageFlags usage, VmaMemoryUsage memoryUsage, bool createView, bool createSampler, VkFilter filter)
         : m_device(device), m_image(VK_NULL_HANDLE), m_allocation(VK_NULL_HANDLE),
@@ -29,63 +36,36 @@ namespace vov {
     }
 
     Image::Image(Device& device, const std::string& filename, VkFormat format, VkImageUsageFlags usage, VmaMemoryUsage memoryUsage, VkFilter filter)
-        : m_device(device), m_image(VK_NULL_HANDLE), m_allocation(VK_NULL_HANDLE), m_imageView(VK_NULL_HANDLE), m_filename{filename}, m_format{format} {
-        uint8_t* pixels = nullptr;
-        VkDeviceSize imageSize{};
-        int texWidth, texHeight, texChannels;
-        bool usingStb = true;
-        gli::texture texture;
+        : Image(device, filename, LoadFile(filename), format, usage, memoryUsage, filter) {
+    }
 
-        const std::string fileExtension = filename.substr(filename.find_last_of('.') + 1);
-        if (fileExtension == "dds") {
-            texture = gli::load(filename);
-            if (texture.empty()) {
-                std::cerr << "Failed to load DDS texture image!" << std::endl;
-                pixels = stbi_load("resources/TextureNotFound.png", &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
-            } else {
-                texWidth = static_cast<int>(texture.extent().x);
-                texHeight = static_cast<int>(texture.extent().y);
-
-                pixels = static_cast<uint8_t*>(texture.data());
-                // format = VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
-                format = gliFormatToVkFormat(texture.format());
-                imageSize = static_cast<VkDeviceSize>(texture.size());
-                // m_mipLevels = static_cast<uint32_t>(texture.levels());
-                m_mipLevels = 1;
-                m_extent = VkExtent2D{static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight)};
-                usingStb = false;
-            }
-        } else {
-            pixels = stbi_load(filename.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
-            if (!pixels) {
-                std::cerr << "Failed to load texture image!" << std::endl;
-                pixels = stbi_load("resources/TextureNotFound.png", &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
-            }
-            // m_mipLevels = static_cast<uint32_t>(std::floor(std::log2(std::max(texWidth, texHeight)))) + 1;
-            m_mipLevels = 1;
-            m_extent = VkExtent2D{static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight)};
-            imageSize = texWidth * texHeight * 4;
+    Image::Image(Device& device, const std::string& filename, const FileData& data, VkFormat format, VkImageUsageFlags usage, VmaMemoryUsage memoryUsage, VkFilter filter)
+        : m_device(device), m_image(VK_NULL_HANDLE), m_allocation(VK_NULL_HANDLE), m_imageView(VK_NULL_HANDLE), m_filename{filename}, m_format{format} {
+        if (!data.usingStb) {
+            format = data.format;
         }
+        // m_mipLevels = static_cast<uint32_t>(std::floor(std::log2(std::max(texWidth, texHeight)))) + 1;
+        m_mipLevels = 1;
+        m_extent = data.extent;
 
         // Create a staging buffer
-        const Buffer stagingBuffer(device, imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_ONLY);
+        const Buffer stagingBuffer(device, data.size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_ONLY);
 
         //TODO: should prob actually use the VMA auto mapper, o well :p
-        stagingBuffer.copyTo(pixels, imageSize);
-
-        if (usingStb) {
-            stbi_image_free(pixels);
-        }
+        stagingBuffer.copyTo(data.pixels, data.size);
 
         createImage(m_extent, m_mipLevels, format, usage | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT, memoryUsage);
         createImageView(format);
 
         device.TransitionImageLayout(m_image, format, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, m_mipLevels);
-        device.copyBufferToImage(stagingBuffer.getBuffer(), m_image, texWidth, texHeight);
-        if (usingStb) {
-            generateMipmaps(format, texWidth, texHeight);
+        device.copyBufferToImage(stagingBuffer.getBuffer(), m_image, m_extent.width, m_extent.height);
+        SetCurrentState(VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT);
+        if (data.usingStb) {
+            generateMipmaps(format, m_extent.width, m_extent.height);
         } else {
             device.TransitionImageLayout(m_image, format, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, m_mipLevels);
+            // Waited on, nothing left to sync against
+            SetCurrentState(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE);
         }
 
         createImageSampler(filter, VK_SAMPLER_ADDRESS_MODE_REPEAT);
@@ -93,9 +73,44 @@ namespace vov {
         SetName(filename);
     }
 
+    Image::FileData Image::LoadFile(const std::string& filename) {
+        FileData data{};
+        int texWidth, texHeight, texChannels;
+        uint8_t* pixels = nullptr;
+
+        const std::string fileExtension = filename.substr(filename.find_last_of('.') + 1);
+        if (fileExtension == "dds") {
+            data.texture = gli::load(filename);
+            if (data.texture.empty()) {
+                std::cerr << "Failed to load DDS texture image!" << std::endl;
+                pixels = stbi_load("resources/TextureNotFound.png", &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
+            } else {
+                data.pixels = static_cast<const uint8_t*>(data.texture.data());
+                data.format = gliFormatToVkFormat(data.texture.format());
+                data.size = static_cast<VkDeviceSize>(data.texture.size());
+                data.extent = VkExtent2D{static_cast<uint32_t>(data.texture.extent().x), static_cast<uint32_t>(data.texture.extent().y)};
+                data.usingStb = false;
+                return data;
+            }
+        } else {
+            pixels = stbi_load(filename.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
+            if (!pixels) {
+                std::cerr << "Failed to load texture image!" << std::endl;
+                pixels = stbi_load("resources/TextureNotFound.png", &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
+            }
+        }
+
+        data.stbPixels = {pixels, stbi_image_free};
+        data.pixels = pixels;
+        data.size = static_cast<VkDeviceSize>(texWidth) * texHeight * 4;
+        data.extent = VkExtent2D{static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight)};
+        return data;
+    }
+
     Image::Image(Device& device, VkExtent2D size, VkFormat format, VkImageUsageFlags usage, VmaMemoryUsage memoryUsage, VkImage existingImage)
         : m_device(device), m_image(existingImage), m_allocation(VK_NULL_HANDLE),
           m_imageView(VK_NULL_HANDLE), m_mipLevels(1), m_extent{size}, m_format(format) {
+        m_states.resize(1);
         createImageView(format);
         m_isSwapchainImage = true; // Mark this image as a swapchain image
     }
@@ -116,75 +131,112 @@ namespace vov {
     }
 
 
+    void Image::SetCurrentState(VkImageLayout layout, VkPipelineStageFlags2 stages, VkAccessFlags2 access) {
+        for (SubresourceState& state : m_states) {
+            state.layout = layout;
+            state.writeStages = stages;
+            state.writeAccess = access & WRITE_ACCESS;
+            state.readStages = VK_PIPELINE_STAGE_2_NONE;
+            state.visibleStages = stages;
+            state.visibleAccess = access;
+        }
+    }
+
+    void Image::Barrier(std::vector<VkImageMemoryBarrier2>& barriers, VkImageLayout newLayout, VkPipelineStageFlags2 stages, VkAccessFlags2 access,
+                        uint32_t baseMipLevel, uint32_t mipLevelCount) {
+        const uint32_t mipLevels = static_cast<uint32_t>(m_states.size());
+        const uint32_t endMipLevel = mipLevelCount == VK_REMAINING_MIP_LEVELS ? mipLevels : std::min(baseMipLevel + mipLevelCount, mipLevels);
+        const bool write = (access & WRITE_ACCESS) != 0;
+
+        // Mips next to each other that need the same barrier share one
+        VkImageMemoryBarrier2* previous{nullptr};
+        for (uint32_t mip = baseMipLevel; mip < endMipLevel; ++mip) {
+            SubresourceState& state = m_states[mip];
+            const bool layoutChange = newLayout != state.layout;
+
+            VkPipelineStageFlags2 srcStages{VK_PIPELINE_STAGE_2_NONE};
+            VkAccessFlags2 srcAccess{VK_ACCESS_2_NONE};
+            if (write || layoutChange) {
+                // Reads since the last write can't see what this is about to do, they have to be done too
+                srcStages = state.writeStages | state.readStages;
+                srcAccess = state.writeAccess;
+            } else if ((stages & ~state.visibleStages) != 0 || (access & ~state.visibleAccess) != 0) {
+                srcStages = state.writeStages;
+                srcAccess = state.writeAccess;
+            }
+
+            const bool barrier = layoutChange || srcStages != VK_PIPELINE_STAGE_2_NONE;
+            if (barrier) {
+                VkImageMemoryBarrier2 imageBarrier{};
+                imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+                imageBarrier.srcStageMask = srcStages;
+                imageBarrier.srcAccessMask = srcAccess;
+                imageBarrier.dstStageMask = stages;
+                imageBarrier.dstAccessMask = access;
+                imageBarrier.oldLayout = state.layout;
+                imageBarrier.newLayout = newLayout;
+                imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+                imageBarrier.image = m_image;
+                imageBarrier.subresourceRange = {getImageAspect(m_format), mip, 1, 0, 1};
+
+                if (previous != nullptr && previous->subresourceRange.baseMipLevel + previous->subresourceRange.levelCount == mip &&
+                    previous->srcStageMask == srcStages && previous->srcAccessMask == srcAccess && previous->oldLayout == state.layout) {
+                    ++previous->subresourceRange.levelCount;
+                } else {
+                    previous = &barriers.emplace_back(imageBarrier);
+                }
+            } else {
+                previous = nullptr;
+            }
+
+            if (write) {
+                state.writeStages = stages;
+                state.writeAccess = access & WRITE_ACCESS;
+                state.readStages = VK_PIPELINE_STAGE_2_NONE;
+                state.visibleStages = stages;
+                state.visibleAccess = access;
+            } else if (layoutChange) {
+                // The transition is a write of its own, later reads chain onto it
+                state.writeStages = stages;
+                state.writeAccess = VK_ACCESS_2_NONE;
+                state.readStages = stages;
+                state.visibleStages = stages;
+                state.visibleAccess = access;
+            } else {
+                state.readStages |= stages;
+                if (barrier) {
+                    state.visibleStages |= stages;
+                    state.visibleAccess |= access;
+                }
+            }
+            state.layout = newLayout;
+        }
+    }
+
+    void Image::RecordBarriers(VkCommandBuffer commandBuffer, const std::vector<VkImageMemoryBarrier2>& barriers) {
+        if (barriers.empty()) {
+            return;
+        }
+
+        VkDependencyInfo dependencyInfo{};
+        dependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+        dependencyInfo.imageMemoryBarrierCount = static_cast<uint32_t>(barriers.size());
+        dependencyInfo.pImageMemoryBarriers = barriers.data();
+        vkCmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+    }
+
     void Image::TransitionImageLayout(VkCommandBuffer commandBuffer, VkImageLayout newLayout) {
-        VkImageMemoryBarrier barrier{};
-        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-        barrier.oldLayout = m_imageLayout;
-        barrier.newLayout = newLayout;
-        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        barrier.image = m_image;
-
-        barrier.subresourceRange.aspectMask = 0;
-        if (HasDepth()) {
-            barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
-            if (HasStencil()) barrier.subresourceRange.aspectMask |= VK_IMAGE_ASPECT_STENCIL_BIT;
-        } else barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-
-        barrier.subresourceRange.baseMipLevel = 0;
-        barrier.subresourceRange.levelCount = m_mipLevels;
-        barrier.subresourceRange.baseArrayLayer = 0;
-        barrier.subresourceRange.layerCount = 1;
-        barrier.srcAccessMask = 0;
-        barrier.dstAccessMask = 0;
-
-        vkCmdPipelineBarrier(
-            commandBuffer,
-            VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
-            VK_PIPELINE_STAGE_TRANSFER_BIT,
-            0,
-            0, nullptr,
-            0, nullptr,
-            1, &barrier
-        );
-
-        m_imageLayout = newLayout;
+        VkPipelineStageFlags2 stages{};
+        VkAccessFlags2 access{};
+        GetLayoutUsage(newLayout, stages, access);
+        TransitionImageLayout(commandBuffer, newLayout, stages, access);
     }
 
-    void Image::TransitionImageLayout(VkCommandBuffer commandBuffer, VkImageLayout newLayout,
-                                      VkPipelineStageFlags srcStageMask, VkPipelineStageFlags dstStageMask) {
-        VkImageMemoryBarrier barrier{};
-        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-        barrier.oldLayout = m_imageLayout;
-        barrier.newLayout = newLayout;
-        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        barrier.image = m_image;
-
-        barrier.subresourceRange.aspectMask = 0;
-        if (HasDepth()) {
-            barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
-            if (HasStencil()) barrier.subresourceRange.aspectMask |= VK_IMAGE_ASPECT_STENCIL_BIT;
-        } else barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-
-        barrier.subresourceRange.baseMipLevel = 0;
-        barrier.subresourceRange.levelCount = m_mipLevels;
-        barrier.subresourceRange.baseArrayLayer = 0;
-        barrier.subresourceRange.layerCount = 1;
-        barrier.srcAccessMask = 0;
-        barrier.dstAccessMask = 0;
-
-        vkCmdPipelineBarrier(
-            commandBuffer,
-            srcStageMask, // Use provided source stage mask
-            dstStageMask, // Use provided destination stage mask
-            0,
-            0, nullptr,
-            0, nullptr,
-            1, &barrier
-        );
-
-        m_imageLayout = newLayout;
+    void Image::TransitionImageLayout(VkCommandBuffer commandBuffer, VkImageLayout newLayout, VkPipelineStageFlags2 dstStages, VkAccessFlags2 dstAccess) {
+        std::vector<VkImageMemoryBarrier2> barriers{};
+        Barrier(barriers, newLayout, dstStages, dstAccess);
+        RecordBarriers(commandBuffer, barriers);
     }
 
     void Image::SetName(const std::string& name) {
@@ -220,6 +272,7 @@ namespace vov {
         if (vmaCreateImage(m_device.allocator(), &imageInfo, &allocInfo, &m_image, &m_allocation, nullptr) != VK_SUCCESS) {
             throw std::runtime_error("Failed to create image with VMA!");
         }
+        m_states.assign(miplevels, {});
     }
 
     void Image::createImageView(VkFormat format) {
@@ -230,9 +283,8 @@ namespace vov {
         m_sampler = std::make_unique<Sampler>(m_device, filter, addressMode, m_mipLevels);
     }
 
-    void Image::generateMipmaps(VkFormat format, uint32_t width, uint32_t height) const {
+    void Image::generateMipmaps(VkFormat format, uint32_t width, uint32_t height) {
         const VkFormatProperties properties = m_device.GetFormatProperties(format);
-        VkImageAspectFlags aspect = getImageAspect(format);
 
         if (!(properties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT)) {
             throw std::runtime_error("Texture image format does not support linear blitting!");
@@ -243,38 +295,13 @@ namespace vov {
         auto mipWidth = static_cast<int32_t>(width);
         auto mipHeight = static_cast<int32_t>(height);
 
+        std::vector<VkImageMemoryBarrier2> barriers{};
         for (uint32_t i = 1; i < m_mipLevels; i++) {
-            // Transition previous mip level to SRC_OPTIMAL
-            VkImageMemoryBarrier barrier{};
-            barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-            barrier.image = m_image;
-            barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-            barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-            barrier.subresourceRange.aspectMask = aspect;
-            barrier.subresourceRange.baseMipLevel = i - 1;
-            barrier.subresourceRange.levelCount = 1;
-            barrier.subresourceRange.baseArrayLayer = 0;
-            barrier.subresourceRange.layerCount = 1;
-
-            barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-            barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-            barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-            barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-
-            vkCmdPipelineBarrier(commandBuffer,
-                                 VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
-                                 0, 0, nullptr, 0, nullptr, 1, &barrier);
-
-            // Transition next mip level to DST_OPTIMAL
-            barrier.subresourceRange.baseMipLevel = i;
-            barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-            barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-            barrier.srcAccessMask = 0;
-            barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-
-            vkCmdPipelineBarrier(commandBuffer,
-                                 VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
-                                 0, 0, nullptr, 0, nullptr, 1, &barrier);
+            // Previous level becomes the source, this one the destination, in one go
+            barriers.clear();
+            Barrier(barriers, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_READ_BIT, i - 1, 1);
+            Barrier(barriers, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, i, 1);
+            RecordBarriers(commandBuffer, barriers);
 
             // Blit
             VkImageBlit blit{};
@@ -302,44 +329,53 @@ namespace vov {
                            1, &blit,
                            VK_FILTER_LINEAR);
 
-            // Transition previous level to SHADER_READ_ONLY_OPTIMAL
-            barrier.subresourceRange.baseMipLevel = i - 1;
-            barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-            barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-            barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-            barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-            vkCmdPipelineBarrier(commandBuffer,
-                                 VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-                                 0, 0, nullptr, 0, nullptr, 1, &barrier);
-
             mipWidth = std::max(mipWidth / 2, 1);
             mipHeight = std::max(mipHeight / 2, 1);
         }
-        //
-        // // Transition last mip level to SHADER_READ_ONLY_OPTIMAL
-        VkImageMemoryBarrier lastBarrier{};
-        lastBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-        lastBarrier.image = m_image;
-        lastBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        lastBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        lastBarrier.subresourceRange.aspectMask = aspect;
-        lastBarrier.subresourceRange.baseMipLevel = m_mipLevels - 1;
-        lastBarrier.subresourceRange.levelCount = 1;
-        lastBarrier.subresourceRange.baseArrayLayer = 0;
-        lastBarrier.subresourceRange.layerCount = 1;
-
-        lastBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-        lastBarrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-        lastBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-        lastBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-        vkCmdPipelineBarrier(commandBuffer,
-                             VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-                             0, 0, nullptr, 0, nullptr, 1, &lastBarrier);
-
-        // m_device.TransitionImageLayout(m_image, format, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, m_mipLevels);
+
+        // Every level to SHADER_READ_ONLY_OPTIMAL, the sources and the last destination split into two barriers at most
+        barriers.clear();
+        Barrier(barriers, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT);
+        RecordBarriers(commandBuffer, barriers);
+
         m_device.endSingleTimeCommands(commandBuffer);
+        SetCurrentState(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE);
+    }
+
+    void Image::GetLayoutUsage(VkImageLayout layout, VkPipelineStageFlags2& stages, VkAccessFlags2& access) {
+        switch (layout) {
+            case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL:
+                stages = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+                access = VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT;
+                break;
+            case VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL:
+            case VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL:
+                stages = VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT;
+                access = VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+                break;
+            case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
+            case VK_IMAGE_LAYOUT_DEPTH_READ_ONLY_OPTIMAL:
+                stages = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+                access = VK_ACCESS_2_SHADER_SAMPLED_READ_BIT;
+                break;
+            case VK_IMAGE_LAYOUT_GENERAL:
+                stages = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+                access = VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
+                break;
+            case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:
+                stages = VK_PIPELINE_STAGE_2_TRANSFER_BIT;
+                access = VK_ACCESS_2_TRANSFER_READ_BIT;
+                break;
+            case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:
+                stages = VK_PIPELINE_STAGE_2_TRANSFER_BIT;
+                access = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+                break;
+            default:
+                // Present and the like, the semaphore after it does the waiting
+                stages = VK_PIPELINE_STAGE_2_NONE;
+                access = VK_ACCESS_2_NONE;
+                break;
+        }
     }
 
     //Thanks ChatGPT
@@ -2,6 +2,7 @@
 #define VIMAGE_H
 
 #include <memory>
+#include <vector>
 
 #include "Core/Device.h"
 #include "Image/ImageView.h"
@@ -15,6 +16,17 @@ namespace vov {
 
     class Image {
     public:
+        // Decoded texture file, still on the CPU. LoadFile is thread safe, only the upload needs the device's queue
+        struct FileData {
+            gli::texture texture{};
+            std::unique_ptr<uint8_t, void(*)(void*)> stbPixels{nullptr, nullptr};
+            const uint8_t* pixels{nullptr};
+            VkDeviceSize size{0};
+            VkExtent2D extent{};
+            VkFormat format{VK_FORMAT_UNDEFINED}; // Only for dds, it brings its own format
+            bool usingStb{true};
+        };
+
         explicit Image(
             Device& device,
             VkExtent2D size,
@@ -26,6 +38,7 @@ namespace vov {
             VkFilter filter = VK_FILTER_LINEAR
         );
         Image(Device& device, const std::string& filename, VkFormat format, VkImageUsageFlags usage, VmaMemoryUsage memoryUsage, VkFilter filter = VK_FILTER_LINEAR);
+        Image(Device& device, const std::string& filename, const FileData& data, VkFormat format, VkImageUsageFlags usage, VmaMemoryUsage memoryUsage, VkFilter filter = VK_FILTER_LINEAR);
 
         //Used for swapchain only
         Image(Device& device, VkExtent2D size, VkFormat format, VkImageUsageFlags usage, VmaMemoryUsage memoryUsage, VkImage existingImage);
@@ -36,15 +49,37 @@ namespace vov {
         [[nodiscard]] VmaAllocation getAllocation() const { return m_allocation; }
         [[nodiscard]] VkDescriptorImageInfo descriptorInfo() const;
 
-		[[nodiscard]] VkImageLayout GetCurrentLayout() const { return m_imageLayout; }
+        // Tracked per mip level, what the next barrier on it has to wait for
+        struct SubresourceState {
+            VkImageLayout layout{VK_IMAGE_LAYOUT_UNDEFINED};
+            VkPipelineStageFlags2 writeStages{VK_PIPELINE_STAGE_2_NONE};
+            VkAccessFlags2 writeAccess{VK_ACCESS_2_NONE};
+            VkPipelineStageFlags2 readStages{VK_PIPELINE_STAGE_2_NONE};    // read since the last write
+            VkPipelineStageFlags2 visibleStages{VK_PIPELINE_STAGE_2_NONE}; // already waited on the last write
+            VkAccessFlags2 visibleAccess{VK_ACCESS_2_NONE};
+        };
+
+		[[nodiscard]] VkImageLayout GetCurrentLayout(uint32_t mipLevel = 0) const { return m_states[mipLevel].layout; }
+        [[nodiscard]] const SubresourceState& GetState(uint32_t mipLevel = 0) const { return m_states[mipLevel]; }
+        // For barriers recorded somewhere else, the whole image was last used like this
+        void SetCurrentState(VkImageLayout layout, VkPipelineStageFlags2 stages, VkAccessFlags2 access);
+
+        // Appends the barriers the mips need before being used like this, nothing when they are already fine.
+        // Assumes they get recorded, batch them with RecordBarriers
+        void Barrier(std::vector<VkImageMemoryBarrier2>& barriers, VkImageLayout newLayout, VkPipelineStageFlags2 stages, VkAccessFlags2 access,
+                     uint32_t baseMipLevel = 0, uint32_t mipLevelCount = VK_REMAINING_MIP_LEVELS);
+        static void RecordBarriers(VkCommandBuffer commandBuffer, const std::vector<VkImageMemoryBarrier2>& barriers);
 
         [[nodiscard]] const std::string& getFilename() const { return m_filename; }
 
+        // Stages and access follow from the layout, the source side from what the image was last used for
         void TransitionImageLayout(VkCommandBuffer commandBuffer, VkImageLayout newLayout);
-        void TransitionImageLayout(VkCommandBuffer commandBuffer, VkImageLayout newLayout, VkPipelineStageFlags srcStageMask, VkPipelineStageFlags dstStageMask);
+        void TransitionImageLayout(VkCommandBuffer commandBuffer, VkImageLayout newLayout, VkPipelineStageFlags2 dstStages, VkAccessFlags2 dstAccess);
 
         void SetName(const std::string& name);
 
+        [[nodiscard]] static FileData LoadFile(const std::string& filename);
+
         [[nodiscard]] uint32_t getMipLevels() const { return m_mipLevels; }
         [[nodiscard]] VkSampler getSampler() const { return m_sampler->getHandle(); }
         [[nodiscard]] VkExtent2D GetExtent() const { return m_extent; }
@@ -80,10 +115,11 @@ namespace vov {
         void createImage(VkExtent2D size, uint32_t miplevels, VkFormat format, VkImageUsageFlags usage, VmaMemoryUsage memoryUsage);
         void createImageView(VkFormat format);
         void createImageSampler(VkFilter filter, VkSamplerAddressMode addressMode);
-        void generateMipmaps(VkFormat format, uint32_t width, uint32_t height) const;
+        void generateMipmaps(VkFormat format, uint32_t width, uint32_t height);
 
         static VkImageAspectFlags getImageAspect(VkFormat format);
-        VkFormat gliFormatToVkFormat(gli::format format);
+        static void GetLayoutUsage(VkImageLayout layout, VkPipelineStageFlags2& stages, VkAccessFlags2& access);
+        static VkFormat gliFormatToVkFormat(gli::format format);
 
 
         Device& m_device;
@@ -99,7 +135,7 @@ namespace vov {
 
         std::string m_filename; //For checking duplicates
 
-        VkImageLayout m_imageLayout{VK_IMAGE_LAYOUT_UNDEFINED};
+        std::vector<SubresourceState> m_states{};
 
         VkFormat m_format{VK_FORMAT_UNDEFINED};
 
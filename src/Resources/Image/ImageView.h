@@ -5,7 +5,7 @@
 namespace vov {
     class ImageView {
     public:
-        ImageView(Device& device, VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels = 1);
+        ImageView(Device& device, VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels = 1, uint32_t baseMipLevel = 0);
         ~ImageView();
 
         [[nodiscard]] VkImageView getHandle() const { return m_view; }
@@ -0,0 +1,143 @@
+#include "MaterialTable.h"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <stdexcept>
+
+#include "Image.h"
+#include "Descriptors/DescriptorWriter.h"
+#include "Utils/ResourceManager.h"
+
+namespace vov {
+    void MaterialTable::Init(Device& deviceRef) {
+        m_device = &deviceRef;
+
+        m_descriptorPool = DescriptorPool::Builder(deviceRef)
+            .SetName("Material Table Descriptor Pool")
+            .setPoolFlags(VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT)
+            .setMaxSets(1)
+            .addPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1)
+            .addPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, MAX_TEXTURES)
+            .build();
+
+        // Slots nothing uses yet can be written while frames that bind the set are in flight
+        m_setLayout = DescriptorSetLayout::Builder(deviceRef)
+            .addBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_FRAGMENT_BIT)
+            .addBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT, MAX_TEXTURES,
+                VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT)
+            .build();
+
+        if (!m_descriptorPool->allocateDescriptor(m_setLayout->getDescriptorSetLayout(), m_descriptorSet)) {
+            throw std::runtime_error("failed to allocate material table descriptor set!");
+        }
+
+        GpuMaterial defaultMaterial{};
+        defaultMaterial.albedoTexture = AddTexture(*ResourceManager::GetInstance().LoadDummyImage(deviceRef));
+        AddMaterial(defaultMaterial);
+    }
+
+    void MaterialTable::Clear() {
+        m_textureIndices.clear();
+        m_textureCount = 0;
+        m_materials.clear();
+        m_materialIndices.clear();
+        m_uploadedCount = 0;
+        m_batchDepth = 0;
+        m_materialBuffer.reset();
+        m_materialCapacity = 0;
+        m_descriptorSet = VK_NULL_HANDLE;
+        m_setLayout.reset();
+        m_descriptorPool.reset();
+        m_device = nullptr;
+    }
+
+    uint32_t MaterialTable::AddTexture(const Image& image) {
+        if (const auto it = m_textureIndices.find(&image); it != m_textureIndices.end()) {
+            return it->second;
+        }
+        if (m_textureCount == MAX_TEXTURES) {
+            throw std::runtime_error("material table is out of texture slots!");
+        }
+
+        const uint32_t index = m_textureCount++;
+        const auto imageInfo = image.descriptorInfo();
+        DescriptorWriter(*m_setLayout, *m_descriptorPool)
+            .writeImage(1, index, &imageInfo)
+            .overwrite(m_descriptorSet);
+
+        m_textureIndices.emplace(&image, index);
+        return index;
+    }
+
+    uint32_t MaterialTable::AddMaterial(const GpuMaterial& material) {
+        if (const auto it = m_materialIndices.find(material); it != m_materialIndices.end()) {
+            return it->second;
+        }
+
+        const auto index = static_cast<uint32_t>(m_materials.size());
+        m_materials.push_back(material);
+        m_materialIndices.emplace(material, index);
+
+        if (m_batchDepth == 0) {
+            Upload();
+        }
+        return index;
+    }
+
+    void MaterialTable::BeginBatch() {
+        ++m_batchDepth;
+    }
+
+    void MaterialTable::EndBatch() {
+        assert(m_batchDepth > 0 && "EndBatch without BeginBatch");
+        if (--m_batchDepth == 0) {
+            Upload();
+        }
+    }
+
+    size_t MaterialTable::GpuMaterialHash::operator()(const GpuMaterial& material) const {
+        size_t hash = 0;
+        for (const uint32_t value : {material.albedoTexture, material.normalTexture, material.specularTexture, material.bumpTexture, material.flags}) {
+            hash ^= std::hash<uint32_t>{}(value) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+        }
+        return hash;
+    }
+
+    void MaterialTable::Upload() {
+        const auto count = static_cast<uint32_t>(m_materials.size());
+        if (count == m_uploadedCount) {
+            return;
+        }
+
+        // A new buffer gets everything, otherwise only the entries past the ones in flight, nothing reads those yet
+        if (count > m_materialCapacity) {
+            // The set is bound by every frame in flight, swapping the buffer has to wait for them
+            if (m_materialBuffer) {
+                vkDeviceWaitIdle(m_device->device());
+            }
+
+            m_materialCapacity = std::bit_ceil(std::max(count, MIN_MATERIAL_CAPACITY));
+            m_materialBuffer = std::make_unique<Buffer>(*m_device, sizeof(GpuMaterial) * m_materialCapacity,
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+            m_materialBuffer->SetName("Material Table");
+            m_uploadedCount = 0;
+
+            const auto bufferInfo = m_materialBuffer->descriptorInfo();
+            DescriptorWriter(*m_setLayout, *m_descriptorPool)
+                .writeBuffer(0, &bufferInfo)
+                .overwrite(m_descriptorSet);
+        }
+
+        const uint32_t size = sizeof(GpuMaterial) * (count - m_uploadedCount);
+        const auto stagingBuffer = std::make_unique<Buffer>(
+            *m_device, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_ONLY
+        );
+        stagingBuffer->map();
+        stagingBuffer->copyTo(m_materials.data() + m_uploadedCount, size);
+        stagingBuffer->unmap();
+
+        m_device->copyBuffer(stagingBuffer.get(), m_materialBuffer.get(), size, sizeof(GpuMaterial) * m_uploadedCount);
+        m_uploadedCount = count;
+    }
+}
@@ -0,0 +1,102 @@
+#ifndef MATERIALTABLE_H
+#define MATERIALTABLE_H
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "Buffer.h"
+#include "Core/Device.h"
+#include "Descriptors/DescriptorPool.h"
+#include "Descriptors/DescriptorSetLayout.h"
+#include "Utils/Singleton.h"
+
+namespace vov {
+    class Image;
+
+    // Every material texture in one sampler2D array and every material in one device local storage buffer, one set
+    // bound once per pass. Draws only carry a material index, see deferred.frag. Filled while scenes load, only while
+    // the render thread is idle
+    class MaterialTable final : public Singleton<MaterialTable> {
+    public:
+        // Matches deferred.frag, the texture fields index the texture array
+        struct GpuMaterial {
+            uint32_t albedoTexture{0};
+            uint32_t normalTexture{0};
+            uint32_t specularTexture{0};
+            uint32_t bumpTexture{0};
+            uint32_t flags{0};          // Mesh::MaterialFlags
+            uint32_t _pad[3]{};
+
+            bool operator==(const GpuMaterial& other) const = default;
+        };
+
+        // Far below what desktop GPUs allow for update after bind arrays
+        static constexpr uint32_t MAX_TEXTURES = 4096;
+        // Material 0 and texture 0 are the magenta dummy, meshes without a material end up there
+        static constexpr uint32_t DEFAULT_MATERIAL = 0;
+        // Grows in powers of two past this
+        static constexpr uint32_t MIN_MATERIAL_CAPACITY = 256;
+
+        // Before anything loads a mesh
+        void Init(Device& deviceRef);
+        // By the device, before it goes
+        void Clear();
+
+        // Same image, same index
+        uint32_t AddTexture(const Image& image);
+        // Same material, same index. The index is valid right away, the entry only reaches the GPU at EndBatch
+        // or straight away outside of a batch
+        uint32_t AddMaterial(const GpuMaterial& material);
+
+        // Everything added in between goes up in one staging copy, with at most one grow. Nests
+        void BeginBatch();
+        void EndBatch();
+
+        // BeginBatch for its lifetime, a load that throws halfway still ends the batch and uploads what it queued
+        class BatchScope {
+        public:
+            BatchScope() { GetInstance().BeginBatch(); }
+            ~BatchScope() { GetInstance().EndBatch(); }
+
+            BatchScope(const BatchScope& other) = delete;
+            BatchScope& operator=(const BatchScope& other) = delete;
+        };
+
+        // Binding 0 the materials, binding 1 the textures
+        [[nodiscard]] const DescriptorSetLayout& GetSetLayout() const { return *m_setLayout; }
+        [[nodiscard]] VkDescriptorSet GetDescriptorSet() const { return m_descriptorSet; }
+        [[nodiscard]] uint32_t GetTextureCount() const { return m_textureCount; }
+        [[nodiscard]] uint32_t GetMaterialCount() const { return static_cast<uint32_t>(m_materials.size()); }
+
+    private:
+        friend class Singleton;
+        MaterialTable() = default;
+
+        struct GpuMaterialHash {
+            size_t operator()(const GpuMaterial& material) const;
+        };
+
+        // Copies every material added since the last upload
+        void Upload();
+
+        Device* m_device{nullptr};
+
+        std::unique_ptr<DescriptorPool> m_descriptorPool{};
+        std::unique_ptr<DescriptorSetLayout> m_setLayout{};
+        VkDescriptorSet m_descriptorSet{VK_NULL_HANDLE};
+
+        std::unordered_map<const Image*, uint32_t> m_textureIndices{};
+        uint32_t m_textureCount{0};
+
+        std::vector<GpuMaterial> m_materials{};
+        std::unordered_map<GpuMaterial, uint32_t, GpuMaterialHash> m_materialIndices{};
+        uint32_t m_uploadedCount{0};
+        uint32_t m_batchDepth{0};
+
+        std::unique_ptr<Buffer> m_materialBuffer{};
+        uint32_t m_materialCapacity{0};
+    };
+}
+
+#endif //MATERIALTABLE_H
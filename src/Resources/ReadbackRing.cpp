@@ -0,0 +1,143 @@
+#include "ReadbackRing.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+vov::ReadbackRing::ReadbackRing(Device& deviceRef, uint32_t framesInFlight, VkDeviceSize initialSize): m_device{deviceRef} {
+    m_slots.resize(framesInFlight);
+    for (uint32_t i = 0; i < framesInFlight; ++i) {
+        m_slots[i].buffers.push_back(CreateBuffer(initialSize, i));
+    }
+}
+
+void vov::ReadbackRing::BeginFrame(uint32_t frameIndex) {
+    Deliver(m_slots[frameIndex]);
+}
+
+void vov::ReadbackRing::EndFrame(VkCommandBuffer commandBuffer, uint32_t frameIndex) {
+    if (m_slots[frameIndex].requests.empty()) {
+        return;
+    }
+
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+
+    vkCmdPipelineBarrier(
+        commandBuffer,
+        VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_HOST_BIT,
+        0,
+        1, &barrier,
+        0, nullptr,
+        0, nullptr
+    );
+}
+
+void vov::ReadbackRing::ReadImage(VkCommandBuffer commandBuffer, uint32_t frameIndex, const Image& image, VkOffset2D offset, VkExtent2D extent, Callback callback) {
+    const VkDeviceSize size = GetFormatSize(image.GetFormat()) * extent.width * extent.height;
+
+    uint32_t bufferIndex;
+    const VkDeviceSize bufferOffset = Allocate(frameIndex, size, bufferIndex);
+
+    VkBufferImageCopy region{};
+    region.bufferOffset = bufferOffset;
+    region.bufferRowLength = 0;
+    region.bufferImageHeight = 0;
+    region.imageSubresource.aspectMask = image.HasDepth() ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.mipLevel = 0;
+    region.imageSubresource.baseArrayLayer = 0;
+    region.imageSubresource.layerCount = 1;
+    region.imageOffset = {offset.x, offset.y, 0};
+    region.imageExtent = {extent.width, extent.height, 1};
+
+    Slot& slot = m_slots[frameIndex];
+    vkCmdCopyImageToBuffer(commandBuffer, image.getImage(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                           slot.buffers[bufferIndex]->getBuffer(), 1, &region);
+
+    slot.requests.push_back({bufferIndex, bufferOffset, {nullptr, size, extent, image.GetFormat()}, std::move(callback)});
+}
+
+void vov::ReadbackRing::DeliverAll() {
+    for (auto& slot : m_slots) {
+        Deliver(slot);
+    }
+}
+
+VkDeviceSize vov::ReadbackRing::GetFormatSize(VkFormat format) {
+    switch (format) {
+        case VK_FORMAT_R8G8_UNORM:
+            return 2;
+        case VK_FORMAT_R8G8B8A8_UNORM:
+        case VK_FORMAT_R8G8B8A8_SRGB:
+        case VK_FORMAT_B8G8R8A8_UNORM:
+        case VK_FORMAT_B8G8R8A8_SRGB:
+        case VK_FORMAT_R16G16_SFLOAT:
+        case VK_FORMAT_R16G16_UNORM:
+        case VK_FORMAT_R16G16_SNORM:
+        case VK_FORMAT_R32_SFLOAT:
+        case VK_FORMAT_R32_UINT:
+        case VK_FORMAT_D32_SFLOAT:
+            return 4;
+        case VK_FORMAT_R16G16B16A16_SFLOAT:
+            return 8;
+        case VK_FORMAT_R32G32B32A32_SFLOAT:
+            return 16;
+        default:
+            throw std::runtime_error("Readback not supported for this format!");
+    }
+}
+
+VkDeviceSize vov::ReadbackRing::Allocate(uint32_t frameIndex, VkDeviceSize size, uint32_t& outBufferIndex) {
+    // 16 covers the texel size of every format above, which vkCmdCopyImageToBuffer requires for bufferOffset
+    constexpr VkDeviceSize ALIGNMENT = 16;
+
+    Slot& slot = m_slots[frameIndex];
+    VkDeviceSize offset = (slot.head + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+
+    if (offset + size > slot.buffers.back()->GetSize()) {
+        // Copies already recorded this frame point at the old buffer, so it stays alive until the slot is delivered
+        const VkDeviceSize newSize = std::max<VkDeviceSize>(slot.buffers.back()->GetSize() * 2, size);
+        slot.buffers.push_back(CreateBuffer(newSize, frameIndex));
+        offset = 0;
+    }
+
+    slot.head = offset + size;
+    outBufferIndex = static_cast<uint32_t>(slot.buffers.size() - 1);
+    return offset;
+}
+
+std::unique_ptr<vov::Buffer> vov::ReadbackRing::CreateBuffer(VkDeviceSize size, uint32_t frameIndex) const {
+    auto buffer = std::make_unique<Buffer>(m_device, size, VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_TO_CPU, true);
+    buffer->map();
+    buffer->SetName("Readback Buffer " + std::to_string(frameIndex));
+    return buffer;
+}
+
+void vov::ReadbackRing::Deliver(Slot& slot) {
+    if (slot.requests.empty()) {
+        return;
+    }
+
+    for (const auto& buffer : slot.buffers) {
+        buffer->invalidate();
+    }
+
+    for (const auto& request : slot.requests) {
+        Result result = request.result;
+        result.data = static_cast<const uint8_t*>(slot.buffers[request.bufferIndex]->GetRawData()) + request.offset;
+        if (request.callback) {
+            request.callback(result);
+        }
+    }
+
+    slot.requests.clear();
+    slot.head = 0;
+
+    // Only the newest (biggest) buffer is worth keeping around
+    if (slot.buffers.size() > 1) {
+        slot.buffers.erase(slot.buffers.begin(), slot.buffers.end() - 1);
+    }
+}
@@ -0,0 +1,69 @@
+#ifndef READBACKRING_H
+#define READBACKRING_H
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "Buffer.h"
+#include "Image.h"
+#include "Core/Device.h"
+
+namespace vov {
+    // GPU -> CPU readbacks without stalling.
+    // Every frame in flight owns a persistently mapped buffer, copies get recorded into it and the callbacks fire
+    // once that frame slot comes around again (so its fence has been waited on).
+    class ReadbackRing {
+    public:
+        struct Result {
+            const void* data{};                 // only valid during the callback
+            VkDeviceSize size{};
+            VkExtent2D extent{};
+            VkFormat format{VK_FORMAT_UNDEFINED};
+        };
+
+        using Callback = std::function<void(const Result&)>;
+
+        ReadbackRing(Device& deviceRef, uint32_t framesInFlight, VkDeviceSize initialSize = 64 * 1024);
+
+        ReadbackRing(const ReadbackRing&) = delete;
+        ReadbackRing& operator=(const ReadbackRing&) = delete;
+
+        // Call right after the fence of frameIndex was waited on, delivers what was requested the last time this slot was used
+        void BeginFrame(uint32_t frameIndex);
+        // Makes this frame's copies visible to the host, call before the command buffer gets submitted
+        void EndFrame(VkCommandBuffer commandBuffer, uint32_t frameIndex);
+
+        // The image has to be in VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
+        void ReadImage(VkCommandBuffer commandBuffer, uint32_t frameIndex, const Image& image, VkOffset2D offset, VkExtent2D extent, Callback callback);
+
+        // Only safe once the device is idle, fires every callback that is still pending
+        void DeliverAll();
+
+        static VkDeviceSize GetFormatSize(VkFormat format);
+
+    private:
+        struct Request {
+            uint32_t bufferIndex{};
+            VkDeviceSize offset{};
+            Result result{};
+            Callback callback{};
+        };
+
+        struct Slot {
+            // Last one is the active buffer, older ones stay alive until the copies recorded into them are delivered
+            std::vector<std::unique_ptr<Buffer>> buffers{};
+            VkDeviceSize head{};
+            std::vector<Request> requests{};
+        };
+
+        VkDeviceSize Allocate(uint32_t frameIndex, VkDeviceSize size, uint32_t& outBufferIndex);
+        std::unique_ptr<Buffer> CreateBuffer(VkDeviceSize size, uint32_t frameIndex) const;
+        void Deliver(Slot& slot);
+
+        Device& m_device;
+        std::vector<Slot> m_slots{};
+    };
+}
+
+#endif //READBACKRING_H
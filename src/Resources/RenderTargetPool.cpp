@@ -0,0 +1,97 @@
+#include "RenderTargetPool.h"
+
+#include <algorithm>
+
+vov::RenderTargetPool::RenderTargetPool(Device& deviceRef, VkExtent2D extent): m_device{deviceRef}, m_extent{extent} {
+    VkPhysicalDeviceMemoryProperties memoryProperties{};
+    vkGetPhysicalDeviceMemoryProperties(m_device.getPhysicalDevice(), &memoryProperties);
+    for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; ++i) {
+        if (memoryProperties.memoryTypes[i].propertyFlags & VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT) {
+            m_lazyMemory = true;
+        }
+    }
+}
+
+void vov::RenderTargetPool::BeginFrame() {
+    for (Slot& slot : m_slots) {
+        slot.users.clear();
+    }
+    m_targetCount = 0;
+}
+
+vov::Image& vov::RenderTargetPool::Acquire(const Description& description, uint32_t firstPass, uint32_t lastPass) {
+    ++m_targetCount;
+
+    // Requests come in by first pass, so the last user of a slot is the one that ends latest
+    const auto slot = std::ranges::find_if(m_slots, [&] (const Slot& candidate) {
+        return candidate.format == description.format && candidate.usage == description.usage && candidate.filter == description.filter &&
+               (candidate.users.empty() || candidate.users.back().lastPass < firstPass);
+    });
+
+    if (slot != m_slots.end()) {
+        slot->users.push_back({description.name, firstPass, lastPass});
+        return *slot->image;
+    }
+
+    Slot& created = m_slots.emplace_back();
+    created.format = description.format;
+    created.usage = description.usage;
+    created.filter = description.filter;
+    created.users.push_back({description.name, firstPass, lastPass});
+    CreateImage(created);
+    return *created.image;
+}
+
+void vov::RenderTargetPool::EndFrame() {
+    for (Slot& slot : m_slots) {
+        if (slot.users.empty()) {
+            continue;
+        }
+
+        std::string name{};
+        for (const User& user : slot.users) {
+            name += name.empty() ? user.name : " / " + user.name;
+        }
+        // Only on a change, the frame shape rarely does
+        if (name != slot.name) {
+            slot.name = std::move(name);
+            slot.image->SetName(slot.name);
+        }
+    }
+}
+
+void vov::RenderTargetPool::Resize(VkExtent2D extent) {
+    m_extent = extent;
+    for (Slot& slot : m_slots) {
+        CreateImage(slot);
+    }
+}
+
+VkDeviceSize vov::RenderTargetPool::GetMemorySize() const {
+    VkDeviceSize size{0};
+    for (const Slot& slot : m_slots) {
+        VmaAllocationInfo allocationInfo{};
+        vmaGetAllocationInfo(m_device.allocator(), slot.image->getAllocation(), &allocationInfo);
+        size += allocationInfo.size;
+    }
+    return size;
+}
+
+void vov::RenderTargetPool::CreateImage(Slot& slot) const {
+    constexpr VkImageUsageFlags attachmentUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT;
+    const bool transient = m_lazyMemory && (slot.usage & ~attachmentUsage) == 0;
+
+    slot.image = std::make_unique<Image>(
+        m_device,
+        m_extent,
+        slot.format,
+        transient ? slot.usage | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT : slot.usage,
+        transient ? VMA_MEMORY_USAGE_GPU_LAZILY_ALLOCATED : VMA_MEMORY_USAGE_GPU_ONLY,
+        true,
+        true,
+        slot.filter
+    );
+    if (!slot.name.empty()) {
+        slot.image->SetName(slot.name);
+    }
+}
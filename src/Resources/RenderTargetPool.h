@@ -0,0 +1,78 @@
+#ifndef RENDERTARGETPOOL_H
+#define RENDERTARGETPOOL_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Image.h"
+#include "Core/Device.h"
+
+namespace vov {
+    // Screen sized images behind the render graph's transient targets, handed out again every frame.
+    // A request shares an image with an earlier one of the same format and usage when their passes don't overlap,
+    // the images themselves stay around between frames so the same frame shape keeps getting the same ones.
+    class RenderTargetPool final {
+    public:
+        struct Description {
+            std::string name{};
+            VkFormat format{VK_FORMAT_UNDEFINED};
+            VkImageUsageFlags usage{0};
+            VkFilter filter{VK_FILTER_LINEAR};
+        };
+
+        RenderTargetPool(Device& deviceRef, VkExtent2D extent);
+        ~RenderTargetPool() = default;
+
+        RenderTargetPool(const RenderTargetPool& other) = delete;
+        RenderTargetPool(RenderTargetPool&& other) noexcept = delete;
+        RenderTargetPool& operator=(const RenderTargetPool& other) = delete;
+        RenderTargetPool& operator=(RenderTargetPool&& other) noexcept = delete;
+
+        // Every image is free again, requests have to come in by first pass
+        void BeginFrame();
+        // Used from pass firstPass up to and including lastPass of this frame
+        [[nodiscard]] Image& Acquire(const Description& description, uint32_t firstPass, uint32_t lastPass);
+        // Names the images after whoever got them this frame
+        void EndFrame();
+
+        // Only with the GPU idle
+        void Resize(VkExtent2D extent);
+
+        [[nodiscard]] VkExtent2D GetExtent() const { return m_extent; }
+        // Requests of the last frame
+        [[nodiscard]] size_t GetTargetCount() const { return m_targetCount; }
+        [[nodiscard]] size_t GetImageCount() const { return m_slots.size(); }
+        [[nodiscard]] VkDeviceSize GetMemorySize() const;
+        // Attachment only targets get lazily allocated memory, tile based GPUs never have to back them
+        [[nodiscard]] bool HasLazyMemory() const { return m_lazyMemory; }
+
+    private:
+        struct User {
+            std::string name{};
+            uint32_t firstPass{0};
+            uint32_t lastPass{0};
+        };
+
+        struct Slot {
+            VkFormat format{VK_FORMAT_UNDEFINED};
+            VkImageUsageFlags usage{0};
+            VkFilter filter{VK_FILTER_LINEAR};
+            std::vector<User> users{};
+            std::string name{};
+            std::unique_ptr<Image> image{};
+        };
+
+        void CreateImage(Slot& slot) const;
+
+        Device& m_device;
+        VkExtent2D m_extent{};
+        bool m_lazyMemory{false};
+
+        // Images that sat out a frame are kept, lines come and go with whatever is being drawn
+        std::vector<Slot> m_slots{};
+        size_t m_targetCount{0};
+    };
+}
+
+#endif //RENDERTARGETPOOL_H
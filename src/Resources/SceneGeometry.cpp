@@ -0,0 +1,129 @@
+#include "SceneGeometry.h"
+
+#include <cstring>
+#include <numeric>
+#include <string>
+
+#include "Scene/Mesh.h"
+#include "Scene/Scene.h"
+
+void vov::SceneGeometry::Build(Scene& scene) {
+    if (m_vertexBuffer) {
+        vkDeviceWaitIdle(m_device.device());
+    }
+
+    m_vertexBuffer.reset();
+    m_indexBuffer.reset();
+    m_meshInfoBuffer.reset();
+
+    m_scene = &scene;
+    m_meshVersion = scene.GetMeshVersion();
+
+    m_meshes.assign(scene.GetMeshCount(), nullptr);
+    for (const auto& gameObject : scene.getGameObjects()) {
+        if (gameObject->model) {
+            for (const auto& mesh : gameObject->model->getMeshes()) {
+                m_meshes[mesh->GetSceneIndex()] = mesh.get();
+            }
+        }
+    }
+
+    if (m_meshes.empty()) {
+        return;
+    }
+
+    std::vector<MeshInfo> meshInfos(m_meshes.size());
+    // Non indexed meshes get 0..n-1 so everything can go through the same indexed draw
+    std::vector<uint32_t> generatedIndices{};
+    std::vector<VkDeviceSize> generatedOffsets(m_meshes.size(), 0);
+
+    uint32_t vertexCount = 0;
+    uint32_t indexCount = 0;
+    for (size_t i = 0; i < m_meshes.size(); ++i) {
+        const Mesh* mesh = m_meshes[i];
+
+        MeshInfo& info = meshInfos[i];
+        info.boundsMin = glm::vec4(mesh->GetBoundingBox().min, 1.f);
+        info.boundsMax = glm::vec4(mesh->GetBoundingBox().max, 1.f);
+        info.firstIndex = indexCount;
+        info.indexCount = mesh->GetDrawCount();
+        info.vertexOffset = static_cast<int32_t>(vertexCount);
+        info.materialIndex = mesh->GetMaterialIndex();
+
+        if (!mesh->IsIndexed()) {
+            generatedOffsets[i] = generatedIndices.size() * sizeof(uint32_t);
+            generatedIndices.resize(generatedIndices.size() + mesh->getVertexCount());
+            std::iota(generatedIndices.end() - mesh->getVertexCount(), generatedIndices.end(), 0u);
+        }
+
+        vertexCount += mesh->getVertexCount();
+        indexCount += mesh->GetDrawCount();
+    }
+
+    if (indexCount == 0) {
+        m_meshes.clear();
+        return;
+    }
+
+    m_vertexBuffer = std::make_unique<Buffer>(m_device, sizeof(Mesh::Vertex) * vertexCount, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+    m_vertexBuffer->SetName("Scene Vertex Buffer: " + scene.getName());
+    m_indexBuffer = std::make_unique<Buffer>(m_device, sizeof(uint32_t) * indexCount, VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+    m_indexBuffer->SetName("Scene Index Buffer: " + scene.getName());
+    m_meshInfoBuffer = std::make_unique<Buffer>(m_device, sizeof(MeshInfo) * meshInfos.size(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
+    m_meshInfoBuffer->SetName("Scene Mesh Info Buffer: " + scene.getName());
+
+    // Mesh infos first, generated indices after
+    const VkDeviceSize meshInfoSize = sizeof(MeshInfo) * meshInfos.size();
+    const VkDeviceSize generatedSize = sizeof(uint32_t) * generatedIndices.size();
+    Buffer stagingBuffer(m_device, meshInfoSize + generatedSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_ONLY);
+    stagingBuffer.map();
+    std::memcpy(stagingBuffer.GetRawData(), meshInfos.data(), meshInfoSize);
+    if (generatedSize > 0) {
+        std::memcpy(static_cast<uint8_t*>(stagingBuffer.GetRawData()) + meshInfoSize, generatedIndices.data(), generatedSize);
+    }
+    stagingBuffer.unmap();
+
+    const VkCommandBuffer commandBuffer = m_device.beginSingleTimeCommands();
+
+    for (size_t i = 0; i < m_meshes.size(); ++i) {
+        const Mesh* mesh = m_meshes[i];
+        const MeshInfo& info = meshInfos[i];
+        if (info.indexCount == 0) {
+            continue;
+        }
+
+        VkBufferCopy vertexCopy{};
+        vertexCopy.srcOffset = 0;
+        vertexCopy.dstOffset = sizeof(Mesh::Vertex) * static_cast<VkDeviceSize>(info.vertexOffset);
+        vertexCopy.size = sizeof(Mesh::Vertex) * mesh->getVertexCount();
+        vkCmdCopyBuffer(commandBuffer, mesh->GetVertexBuffer()->getBuffer(), m_vertexBuffer->getBuffer(), 1, &vertexCopy);
+
+        VkBufferCopy indexCopy{};
+        indexCopy.dstOffset = sizeof(uint32_t) * static_cast<VkDeviceSize>(info.firstIndex);
+        indexCopy.size = sizeof(uint32_t) * info.indexCount;
+        if (mesh->IsIndexed()) {
+            indexCopy.srcOffset = 0;
+            vkCmdCopyBuffer(commandBuffer, mesh->GetIndexBuffer()->getBuffer(), m_indexBuffer->getBuffer(), 1, &indexCopy);
+        } else {
+            indexCopy.srcOffset = meshInfoSize + generatedOffsets[i];
+            vkCmdCopyBuffer(commandBuffer, stagingBuffer.getBuffer(), m_indexBuffer->getBuffer(), 1, &indexCopy);
+        }
+    }
+
+    VkBufferCopy meshInfoCopy{};
+    meshInfoCopy.size = meshInfoSize;
+    vkCmdCopyBuffer(commandBuffer, stagingBuffer.getBuffer(), m_meshInfoBuffer->getBuffer(), 1, &meshInfoCopy);
+
+    m_device.endSingleTimeCommands(commandBuffer);
+}
+
+bool vov::SceneGeometry::IsBuiltFor(const Scene& scene) const {
+    return m_scene == &scene && m_meshVersion == scene.GetMeshVersion();
+}
+
+void vov::SceneGeometry::Bind(VkCommandBuffer commandBuffer) const {
+    const VkBuffer buffers[] = {m_vertexBuffer->getBuffer()};
+    const VkDeviceSize offsets[] = {0};
+    vkCmdBindVertexBuffers(commandBuffer, 0, 1, buffers, offsets);
+    vkCmdBindIndexBuffer(commandBuffer, m_indexBuffer->getBuffer(), 0, VK_INDEX_TYPE_UINT32);
+}
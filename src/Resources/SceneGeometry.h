@@ -0,0 +1,61 @@
+#ifndef SCENEGEOMETRY_H
+#define SCENEGEOMETRY_H
+
+#include <memory>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Buffer.h"
+#include "Core/Device.h"
+
+namespace vov {
+    class Mesh;
+    class Scene;
+
+    // Every mesh of a scene in one vertex and one index buffer, so a whole pass can be a single indirect draw.
+    // Meshes keep their own buffers, this is a copy made on the GPU.
+    class SceneGeometry {
+    public:
+        // Matches indirectCull.comp, indexed by Mesh::GetSceneIndex
+        struct MeshInfo {
+            glm::vec4 boundsMin;   // Local space
+            glm::vec4 boundsMax;
+            uint32_t firstIndex;
+            uint32_t indexCount;
+            int32_t vertexOffset;
+            uint32_t materialIndex; // Into MaterialTable
+        };
+
+        explicit SceneGeometry(Device& deviceRef): m_device{deviceRef} {}
+
+        SceneGeometry(const SceneGeometry& other) = delete;
+        SceneGeometry(SceneGeometry&& other) noexcept = delete;
+        SceneGeometry& operator=(const SceneGeometry& other) = delete;
+        SceneGeometry& operator=(SceneGeometry&& other) noexcept = delete;
+
+        // Waits for the device when there is an older build to replace, only meant for scene switches
+        void Build(Scene& scene);
+        [[nodiscard]] bool IsBuiltFor(const Scene& scene) const;
+
+        void Bind(VkCommandBuffer commandBuffer) const;
+
+        [[nodiscard]] uint32_t GetMeshCount() const { return static_cast<uint32_t>(m_meshes.size()); }
+        [[nodiscard]] const std::vector<Mesh*>& GetMeshes() const { return m_meshes; }
+        [[nodiscard]] VkDescriptorBufferInfo GetMeshInfoDescriptor() const { return m_meshInfoBuffer->descriptorInfo(); }
+
+    private:
+        Device& m_device;
+
+        const Scene* m_scene{nullptr};
+        uint32_t m_meshVersion{0};
+
+        std::vector<Mesh*> m_meshes{};
+
+        std::unique_ptr<Buffer> m_vertexBuffer{};
+        std::unique_ptr<Buffer> m_indexBuffer{};
+        std::unique_ptr<Buffer> m_meshInfoBuffer{};
+    };
+}
+
+#endif //SCENEGEOMETRY_H
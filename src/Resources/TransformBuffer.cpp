@@ -0,0 +1,57 @@
+#include "TransformBuffer.h"
+
+#include <bit>
+#include <cstring>
+#include <string>
+
+#include "Descriptors/DescriptorWriter.h"
+
+vov::TransformBuffer::TransformBuffer(Device& deviceRef, uint32_t framesInFlight): m_device{deviceRef} {
+    m_descriptorPool = DescriptorPool::Builder(m_device)
+        .SetName("Transform Buffer Descriptor Pool")
+        .setMaxSets(framesInFlight)
+        .addPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, framesInFlight)
+        .build();
+
+    m_descriptorSetLayout = DescriptorSetLayout::Builder(m_device)
+        .addBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_COMPUTE_BIT)
+        .build();
+
+    m_frames.resize(framesInFlight);
+    for (uint32_t i = 0; i < framesInFlight; ++i) {
+        m_descriptorPool->allocateDescriptor(m_descriptorSetLayout->getDescriptorSetLayout(), m_frames[i].descriptorSet);
+        EnsureCapacity(i, 1024);
+    }
+}
+
+vov::TransformBuffer::~TransformBuffer() {
+    m_frames.clear();
+    m_descriptorPool.reset();
+    m_descriptorSetLayout.reset();
+}
+
+void vov::TransformBuffer::Update(uint32_t frameIndex, const std::vector<glm::mat4>& worldMatrices) {
+    EnsureCapacity(frameIndex, static_cast<uint32_t>(worldMatrices.size()));
+
+    FrameResources& frame = m_frames[frameIndex];
+    std::memcpy(frame.buffer->GetRawData(), worldMatrices.data(), sizeof(glm::mat4) * worldMatrices.size());
+    frame.buffer->flush();
+}
+
+void vov::TransformBuffer::EnsureCapacity(uint32_t frameIndex, uint32_t meshCount) {
+    FrameResources& frame = m_frames[frameIndex];
+    if (meshCount <= frame.capacity) {
+        return;
+    }
+
+    // Only this frame's fence guards the old buffer, which BeginFrame already waited on
+    frame.capacity = std::bit_ceil(meshCount);
+    frame.buffer = std::make_unique<Buffer>(m_device, sizeof(glm::mat4) * frame.capacity, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VMA_MEMORY_USAGE_CPU_TO_GPU, true);
+    frame.buffer->map();
+    frame.buffer->SetName("World Matrices " + std::to_string(frameIndex));
+
+    const auto bufferInfo = frame.buffer->descriptorInfo();
+    DescriptorWriter(*m_descriptorSetLayout, *m_descriptorPool)
+        .writeBuffer(0, &bufferInfo)
+        .overwrite(frame.descriptorSet);
+}
@@ -0,0 +1,54 @@
+#ifndef TRANSFORMBUFFER_H
+#define TRANSFORMBUFFER_H
+
+#include <memory>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Buffer.h"
+#include "Core/Device.h"
+#include "Descriptors/DescriptorPool.h"
+#include "Descriptors/DescriptorSetLayout.h"
+
+namespace vov {
+    // World matrix of every scene mesh, written once per frame and shared by every pass that draws meshes.
+    // Indexed by Mesh::GetSceneIndex, draws pass that as firstInstance so shaders read worldMatrices[gl_InstanceIndex].
+    class TransformBuffer final {
+    public:
+        TransformBuffer(Device& deviceRef, uint32_t framesInFlight);
+        ~TransformBuffer();
+
+        TransformBuffer(const TransformBuffer& other) = delete;
+        TransformBuffer(TransformBuffer&& other) noexcept = delete;
+        TransformBuffer& operator=(const TransformBuffer& other) = delete;
+        TransformBuffer& operator=(TransformBuffer&& other) noexcept = delete;
+
+        // Only after the frame's fence, the buffer is persistently mapped and not double buffered within a frame.
+        // worldMatrices is indexed by Mesh::GetSceneIndex, see RenderSnapshot::Capture
+        void Update(uint32_t frameIndex, const std::vector<glm::mat4>& worldMatrices);
+
+        // One storage buffer at binding 0, visible to vertex and compute
+        [[nodiscard]] DescriptorSetLayout& GetDescriptorSetLayout() const { return *m_descriptorSetLayout; }
+        [[nodiscard]] VkDescriptorSet GetDescriptorSet(uint32_t frameIndex) const { return m_frames[frameIndex].descriptorSet; }
+        [[nodiscard]] VkDescriptorBufferInfo GetDescriptorInfo(uint32_t frameIndex) const { return m_frames[frameIndex].buffer->descriptorInfo(); }
+
+    private:
+        struct FrameResources {
+            std::unique_ptr<Buffer> buffer{};
+            uint32_t capacity{0};
+            VkDescriptorSet descriptorSet{VK_NULL_HANDLE};
+        };
+
+        void EnsureCapacity(uint32_t frameIndex, uint32_t meshCount);
+
+        Device& m_device;
+
+        std::unique_ptr<DescriptorPool> m_descriptorPool{};
+        std::unique_ptr<DescriptorSetLayout> m_descriptorSetLayout{};
+
+        std::vector<FrameResources> m_frames{};
+    };
+}
+
+#endif //TRANSFORMBUFFER_H
@@ -2,6 +2,7 @@
 
 #include "Resources/Buffer.h"
 
+#include <algorithm>
 #include <chrono>
 #include <filesystem>
 #include <iostream>
@@ -9,7 +10,7 @@
 
 #include <assimp/scene.h>
 
-#include "Descriptors/DescriptorWriter.h"
+#include "Resources/MaterialTable.h"
 #include "Utils/ResourceManager.h"
 
 namespace vov {
@@ -42,6 +43,7 @@ namespace vov {
         }
         m_indexCount = static_cast<uint32_t>(indices.size());
         m_vertexCount = static_cast<uint32_t>(vertices.size());
+        buildBVH(vertices, indices);
     }
 
     Mesh::Mesh(Device& device, const Builder& builder): m_device{device} {
@@ -54,10 +56,17 @@ namespace vov {
         m_vertexCount = static_cast<uint32_t>(builder.vertices.size());
         m_transform.SetName(builder.name);
         m_boundingBox = builder.boundingBox;
+        buildBVH(builder.vertices, builder.indices);
 
         // std::string texturePath = builder.modelPath + builder.texturePath;
         // std::cout << "Loading texture: " << texturePath << std::endl;
-        loadTexture(builder.material, builder.descriptorSetLayout, builder.descriptorPool);
+        loadTexture(builder.material);
+    }
+
+    void Mesh::buildBVH(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices) {
+        std::vector<glm::vec3> positions(vertices.size());
+        std::ranges::transform(vertices, positions.begin(), [] (const Vertex& vertex) { return vertex.position; });
+        m_bvh.Build(std::move(positions), indices);
     }
 
     void Mesh::bind(VkCommandBuffer commandBuffer) const {
@@ -72,9 +81,17 @@ namespace vov {
 
     void Mesh::draw(VkCommandBuffer commandBuffer) const {
         if (m_usingIndexBuffer) {
-            vkCmdDrawIndexed(commandBuffer, m_indexCount, 1, 0, 0, 0);
+            vkCmdDrawIndexed(commandBuffer, m_indexCount, 1, 0, 0, m_sceneIndex);
+        } else {
+            vkCmdDraw(commandBuffer, m_vertexCount, 1, 0, m_sceneIndex);
+        }
+    }
+
+    void Mesh::drawIndirect(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset) const {
+        if (m_usingIndexBuffer) {
+            vkCmdDrawIndexedIndirect(commandBuffer, buffer, offset, 1, sizeof(VkDrawIndexedIndirectCommand));
         } else {
-            vkCmdDraw(commandBuffer, m_vertexCount, 1, 0, 0);
+            vkCmdDrawIndirect(commandBuffer, buffer, offset, 1, sizeof(VkDrawIndirectCommand));
         }
     }
 
@@ -97,7 +114,7 @@ namespace vov {
 
         m_vertexBuffer = std::make_unique<Buffer>(
             m_device, bufferSize,
-            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
             VMA_MEMORY_USAGE_GPU_ONLY
         );
         m_vertexBuffer->SetName("Vertex Buffer: " + m_transform.GetName());
@@ -119,7 +136,7 @@ namespace vov {
 
         m_indexBuffer = std::make_unique<Buffer>(
             m_device, bufferSize,
-            VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
             VMA_MEMORY_USAGE_GPU_ONLY
         );
         m_indexBuffer->SetName("Index Buffer: " + m_transform.GetName());
@@ -127,59 +144,38 @@ namespace vov {
         m_device.copyBuffer(stagingBuffer.get(), m_indexBuffer.get(), bufferSize);
     }
 
-    void Mesh::loadTexture(const Material& textureInfo, DescriptorSetLayout* descriptorSetLayout, DescriptorPool* descriptorPool) {
-        m_albedoTexture =   ResourceManager::GetInstance().LoadImage(m_device, textureInfo.basePath + textureInfo.albedoPath, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
-        m_normalTexture =   ResourceManager::GetInstance().LoadImage(m_device, textureInfo.basePath + textureInfo.normalPath, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
-        m_specularTexture = ResourceManager::GetInstance().LoadImage(m_device, textureInfo.basePath + textureInfo.specularPath, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
-        m_bumpTexture =     ResourceManager::GetInstance().LoadImage(m_device, textureInfo.basePath + textureInfo.bumpPath, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT, VMA_MEMORY_USAGE_GPU_ONLY);
-
-        //Order is
-        //Albedo
-        //Normal
-        //Spec
-        //Bump
+    std::vector<ResourceManager::ImageRequest> Mesh::GetTextureRequests(const Material& material) {
+        return {
+            {material.basePath + material.albedoPath, VK_FORMAT_R8G8B8A8_SRGB},
+            {material.basePath + material.normalPath, VK_FORMAT_R8G8B8A8_UNORM},
+            {material.basePath + material.specularPath, VK_FORMAT_R8G8B8A8_UNORM},
+            {material.basePath + material.bumpPath, VK_FORMAT_R8G8B8A8_SRGB}
+        };
+    }
 
-        const auto albedoInfo = m_albedoTexture->descriptorInfo();
-        const auto normalInfo = m_normalTexture->descriptorInfo();
-        const auto specularInfo = m_specularTexture->descriptorInfo();
-        const auto bumpInfo = m_bumpTexture->descriptorInfo();
+    void Mesh::loadTexture(const Material& textureInfo) {
+        const auto textures = GetTextureRequests(textureInfo);
+        m_albedoTexture =   ResourceManager::GetInstance().LoadImage(m_device, textures[0].filename, textures[0].format, TEXTURE_USAGE, VMA_MEMORY_USAGE_GPU_ONLY);
+        m_normalTexture =   ResourceManager::GetInstance().LoadImage(m_device, textures[1].filename, textures[1].format, TEXTURE_USAGE, VMA_MEMORY_USAGE_GPU_ONLY);
+        m_specularTexture = ResourceManager::GetInstance().LoadImage(m_device, textures[2].filename, textures[2].format, TEXTURE_USAGE, VMA_MEMORY_USAGE_GPU_ONLY);
+        m_bumpTexture =     ResourceManager::GetInstance().LoadImage(m_device, textures[3].filename, textures[3].format, TEXTURE_USAGE, VMA_MEMORY_USAGE_GPU_ONLY);
 
         auto is_file = [](const std::string& path) {
             return !path.empty();
         };
 
-        Mesh::TextureBindingInfo info{};
-        info.hasAlbedo = is_file(textureInfo.albedoPath);
-        info.hasNormal = is_file(textureInfo.normalPath);
-        info.hasSpecular = is_file(textureInfo.specularPath);
-        info.hasBump = is_file(textureInfo.bumpPath);
-
-
-        const auto stagingBuffer = std::make_unique<Buffer>(
-            m_device, sizeof(Mesh::TextureBindingInfo), VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_MEMORY_USAGE_CPU_ONLY
-        );
-
-        stagingBuffer->map();
-        stagingBuffer->copyTo(&info, sizeof(Mesh::TextureBindingInfo));
-        stagingBuffer->unmap();
-
-        m_textureBindingInfoBuffer = std::make_unique<Buffer>(
-            m_device,
-            sizeof(Mesh::TextureBindingInfo),
-            VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-            VMA_MEMORY_USAGE_GPU_ONLY
-        );
-        m_textureBindingInfoBuffer->SetName("Texture Binding Info Buffer: " + m_transform.GetName());
-
-        m_device.copyBuffer(stagingBuffer.get(), m_textureBindingInfoBuffer.get(), sizeof(Mesh::TextureBindingInfo));
-
-        const auto bufferDescription = m_textureBindingInfoBuffer->descriptorInfo();
-        DescriptorWriter(*descriptorSetLayout, *descriptorPool)
-                .writeBuffer(0, &bufferDescription)
-                .writeImage(1, &albedoInfo)
-                .writeImage(2, &normalInfo)
-                .writeImage(3, &specularInfo)
-                .writeImage(4, &bumpInfo)
-                .build(m_descriptorSet);
+        m_materialFlags = (is_file(textureInfo.albedoPath) ? MATERIAL_HAS_ALBEDO : 0u) |
+                          (is_file(textureInfo.normalPath) ? MATERIAL_HAS_NORMAL : 0u) |
+                          (is_file(textureInfo.specularPath) ? MATERIAL_HAS_SPECULAR : 0u) |
+                          (is_file(textureInfo.bumpPath) ? MATERIAL_HAS_BUMP : 0u);
+
+        MaterialTable& materials = MaterialTable::GetInstance();
+        MaterialTable::GpuMaterial material{};
+        material.albedoTexture = materials.AddTexture(*m_albedoTexture);
+        material.normalTexture = materials.AddTexture(*m_normalTexture);
+        material.specularTexture = materials.AddTexture(*m_specularTexture);
+        material.bumpTexture = materials.AddTexture(*m_bumpTexture);
+        material.flags = m_materialFlags;
+        m_materialIndex = materials.AddMaterial(material);
     }
 }
@@ -8,13 +8,13 @@
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 #include <glm/glm.hpp>
 
+#include "MeshBVH.h"
 #include "Transform.h"
 #include "Core/Device.h"
-#include "Descriptors/DescriptorPool.h"
-#include "Descriptors/DescriptorSetLayout.h"
 #include "Resources/Buffer.h"
 #include "Resources/Image.h"
 #include "Utils/AABB.h"
+#include "Utils/ResourceManager.h"
 
 namespace vov {
     class Mesh {
@@ -49,18 +49,16 @@ namespace vov {
 
             Material material{};
             AABB boundingBox{};
-
-            //TODO: ask if this is properly done
-            DescriptorSetLayout* descriptorSetLayout{};
-            DescriptorPool* descriptorPool{};
         };
 
-        struct TextureBindingInfo {
-            int hasAlbedo{true};
-            int hasNormal{false};
-            int hasSpecular{false};
-            int hasBump{false};
+        // Bit i is constant_id i of deferred.frag, see GeometryPass
+        enum MaterialFlags : uint32_t {
+            MATERIAL_HAS_ALBEDO = 1 << 0,
+            MATERIAL_HAS_NORMAL = 1 << 1,
+            MATERIAL_HAS_SPECULAR = 1 << 2,
+            MATERIAL_HAS_BUMP = 1 << 3
         };
+        static constexpr uint32_t MATERIAL_FLAG_COUNT = 4;
 
         Mesh(Device& device, const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices);
         Mesh(Device& device, const Builder& builder);
@@ -74,22 +72,42 @@ namespace vov {
         [[nodiscard]] uint32_t getIndexCount() const { return m_indexCount; }
 
         void bind(VkCommandBuffer commandBuffer) const;
+        // firstInstance is the scene index, shaders find the world matrix in TransformBuffer with it
         void draw(VkCommandBuffer commandBuffer) const;
+        // Single draw whose arguments live on the GPU, a VkDrawIndexedIndirectCommand (VkDrawIndirectCommand without an index buffer)
+        void drawIndirect(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset) const;
+        [[nodiscard]] uint32_t GetDrawCount() const { return m_usingIndexBuffer ? m_indexCount : m_vertexCount; }
+
+        // Source of SceneGeometry's merged buffers, index buffer is null for non indexed meshes
+        [[nodiscard]] bool IsIndexed() const { return m_usingIndexBuffer; }
+        [[nodiscard]] const Buffer* GetVertexBuffer() const { return m_vertexBuffer.get(); }
+        [[nodiscard]] const Buffer* GetIndexBuffer() const { return m_usingIndexBuffer ? m_indexBuffer.get() : nullptr; }
 
         static std::unique_ptr<Mesh> createModelFromFile(
             Device& device, const std::string& filepath);
 
+        // Albedo, normal, specular and bump, what loadTexture asks the ResourceManager for
+        [[nodiscard]] static std::vector<ResourceManager::ImageRequest> GetTextureRequests(const Material& material);
+        static constexpr VkImageUsageFlags TEXTURE_USAGE = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+
         Transform& getTransform() { return m_transform; }
         [[nodiscard]] const AABB& GetBoundingBox() const { return m_boundingBox; }
+        [[nodiscard]] const MeshBVH& GetBVH() const { return m_bvh; }
 
-        [[nodiscard]] VkDescriptorSet getDescriptorSet() const {
-            return m_descriptorSet;
-        }
+        // Stable index within the scene, set when the scene BVH gets rebuilt
+        [[nodiscard]] uint32_t GetSceneIndex() const { return m_sceneIndex; }
+        void SetSceneIndex(uint32_t index) { m_sceneIndex = index; }
+
+        // MaterialFlags of the textures the mesh has
+        [[nodiscard]] uint32_t GetMaterialFlags() const { return m_materialFlags; }
+        // Index into the MaterialTable
+        [[nodiscard]] uint32_t GetMaterialIndex() const { return m_materialIndex; }
 
     private:
         void createVertexBuffer(const std::vector<Vertex>& vertices);
         void createIndexBuffer(const std::vector<uint32_t>& indices);
-        void loadTexture(const Material& textureInfo, DescriptorSetLayout* descriptorSetLayout, DescriptorPool* descriptorPool);
+        void buildBVH(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices);
+        void loadTexture(const Material& textureInfo);
 
         Device& m_device;
         uint32_t m_vertexCount;
@@ -104,12 +122,13 @@ namespace vov {
         Image* m_normalTexture{};
         Image* m_specularTexture{};
 
-        std::unique_ptr<Buffer> m_textureBindingInfoBuffer{};
+        uint32_t m_materialFlags{0};
+        uint32_t m_materialIndex{0};
 
         Transform m_transform;
         AABB m_boundingBox{}; // Add this member
-
-        VkDescriptorSet m_descriptorSet{VK_NULL_HANDLE};
+        MeshBVH m_bvh{};
+        uint32_t m_sceneIndex{0};
     };
 }
 
@@ -0,0 +1,199 @@
+#include "MeshBVH.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace {
+    bool IntersectRayBox(const glm::vec3& origin, const glm::vec3& invDir, const vov::AABB& box, float maxDistance, float& outDistance) {
+        const glm::vec3 t0 = (box.min - origin) * invDir;
+        const glm::vec3 t1 = (box.max - origin) * invDir;
+        const glm::vec3 tSmall = glm::min(t0, t1);
+        const glm::vec3 tBig = glm::max(t0, t1);
+
+        const float tMin = glm::max(glm::max(tSmall.x, tSmall.y), glm::max(tSmall.z, 0.f));
+        const float tMax = glm::min(glm::min(tBig.x, tBig.y), glm::min(tBig.z, maxDistance));
+
+        outDistance = tMin;
+        return tMin <= tMax;
+    }
+
+    // Moller-Trumbore, double sided so picking works on both faces
+    bool IntersectRayTriangle(const glm::vec3& origin, const glm::vec3& direction,
+                              const glm::vec3& v0, const glm::vec3& v1, const glm::vec3& v2,
+                              float& outDistance, glm::vec2& outBarycentrics) {
+        const glm::vec3 edge1 = v1 - v0;
+        const glm::vec3 edge2 = v2 - v0;
+        const glm::vec3 p = glm::cross(direction, edge2);
+        const float det = glm::dot(edge1, p);
+        if (det == 0.f) {
+            return false;
+        }
+
+        const float invDet = 1.f / det;
+        const glm::vec3 s = origin - v0;
+        const float u = glm::dot(s, p) * invDet;
+        if (u < 0.f || u > 1.f) {
+            return false;
+        }
+
+        const glm::vec3 q = glm::cross(s, edge1);
+        const float v = glm::dot(direction, q) * invDet;
+        if (v < 0.f || u + v > 1.f) {
+            return false;
+        }
+
+        outDistance = glm::dot(edge2, q) * invDet;
+        outBarycentrics = {u, v};
+        return outDistance > 0.f;
+    }
+}
+
+void vov::MeshBVH::Build(std::vector<glm::vec3> positions, const std::vector<uint32_t>& indices) {
+    m_nodes.clear();
+    m_indices.clear();
+    m_triangleIds.clear();
+    m_positions = std::move(positions);
+
+    const auto triangleCount = static_cast<uint32_t>(indices.empty() ? m_positions.size() / 3 : indices.size() / 3);
+    if (triangleCount == 0) {
+        return;
+    }
+
+    auto vertexIndex = [&] (uint32_t triangle, uint32_t corner) {
+        return indices.empty() ? triangle * 3 + corner : indices[triangle * 3 + corner];
+    };
+
+    std::vector<AABB> bounds(triangleCount);
+    std::vector<glm::vec3> centroids(triangleCount);
+    for (uint32_t i = 0; i < triangleCount; ++i) {
+        const glm::vec3& v0 = m_positions[vertexIndex(i, 0)];
+        const glm::vec3& v1 = m_positions[vertexIndex(i, 1)];
+        const glm::vec3& v2 = m_positions[vertexIndex(i, 2)];
+        bounds[i] = {glm::min(v0, glm::min(v1, v2)), glm::max(v0, glm::max(v1, v2))};
+        centroids[i] = (v0 + v1 + v2) / 3.f;
+    }
+
+    std::vector<uint32_t> order(triangleCount);
+    std::iota(order.begin(), order.end(), 0u);
+
+    m_nodes.reserve(static_cast<size_t>(triangleCount) * 2);
+    m_nodes.push_back({{}, 0, triangleCount, 0});
+
+    std::vector<uint32_t> stack{0};
+    while (!stack.empty()) {
+        const uint32_t nodeIndex = stack.back();
+        stack.pop_back();
+
+        const uint32_t first = m_nodes[nodeIndex].first;
+        const uint32_t count = m_nodes[nodeIndex].count;
+
+        AABB nodeBounds{glm::vec3(FLT_MAX), glm::vec3(-FLT_MAX)};
+        AABB centroidBounds{glm::vec3(FLT_MAX), glm::vec3(-FLT_MAX)};
+        for (uint32_t i = first; i < first + count; ++i) {
+            nodeBounds.min = glm::min(nodeBounds.min, bounds[order[i]].min);
+            nodeBounds.max = glm::max(nodeBounds.max, bounds[order[i]].max);
+            centroidBounds.min = glm::min(centroidBounds.min, centroids[order[i]]);
+            centroidBounds.max = glm::max(centroidBounds.max, centroids[order[i]]);
+        }
+        m_nodes[nodeIndex].bounds = nodeBounds;
+
+        if (count <= MAX_LEAF_TRIANGLES) {
+            continue;
+        }
+
+        // Split the longest centroid axis in the middle, meshes are static so build speed matters more than SAH here
+        const glm::vec3 extent = centroidBounds.max - centroidBounds.min;
+        int axis = 0;
+        if (extent.y > extent.x) axis = 1;
+        if (extent.z > extent[axis]) axis = 2;
+        const float splitPos = centroidBounds.min[axis] + extent[axis] * 0.5f;
+
+        const auto middle = std::partition(order.begin() + first, order.begin() + first + count, [&] (uint32_t triangle) {
+            return centroids[triangle][axis] < splitPos;
+        });
+        auto mid = static_cast<uint32_t>(middle - order.begin());
+
+        if (mid == first || mid == first + count) {
+            mid = first + count / 2;
+        }
+
+        const auto left = static_cast<uint32_t>(m_nodes.size());
+        m_nodes.push_back({{}, first, mid - first, 0});
+        m_nodes.push_back({{}, mid, first + count - mid, 0});
+        m_nodes[nodeIndex].left = left;
+
+        stack.push_back(left);
+        stack.push_back(left + 1);
+    }
+
+    m_indices.resize(static_cast<size_t>(triangleCount) * 3);
+    m_triangleIds = std::move(order);
+    for (uint32_t i = 0; i < triangleCount; ++i) {
+        for (uint32_t corner = 0; corner < 3; ++corner) {
+            m_indices[i * 3 + corner] = vertexIndex(m_triangleIds[i], corner);
+        }
+    }
+}
+
+bool vov::MeshBVH::Raycast(const glm::vec3& origin, const glm::vec3& direction, TriangleHit& outHit, float maxDistance) const {
+    if (m_nodes.empty()) {
+        return false;
+    }
+
+    const glm::vec3 invDir = 1.0f / direction;
+    float bestDistance = maxDistance;
+    bool hit = false;
+
+    std::vector<uint32_t> stack{0};
+    while (!stack.empty()) {
+        const Node& node = m_nodes[stack.back()];
+        stack.pop_back();
+
+        float distance;
+        if (!IntersectRayBox(origin, invDir, node.bounds, bestDistance, distance)) {
+            continue;
+        }
+
+        if (node.IsLeaf()) {
+            for (uint32_t i = node.first; i < node.first + node.count; ++i) {
+                glm::vec2 barycentrics;
+                if (IntersectRayTriangle(origin, direction,
+                                         m_positions[m_indices[i * 3 + 0]],
+                                         m_positions[m_indices[i * 3 + 1]],
+                                         m_positions[m_indices[i * 3 + 2]],
+                                         distance, barycentrics) && distance < bestDistance) {
+                    bestDistance = distance;
+                    outHit.triangle = m_triangleIds[i];
+                    outHit.distance = distance;
+                    outHit.barycentrics = barycentrics;
+                    hit = true;
+                }
+            }
+            continue;
+        }
+
+        float leftDistance;
+        float rightDistance;
+        const bool hitLeft = IntersectRayBox(origin, invDir, m_nodes[node.left].bounds, bestDistance, leftDistance);
+        const bool hitRight = IntersectRayBox(origin, invDir, m_nodes[node.left + 1].bounds, bestDistance, rightDistance);
+
+        if (hitLeft && hitRight) {
+            if (leftDistance <= rightDistance) {
+                stack.push_back(node.left + 1);
+                stack.push_back(node.left);
+            } else {
+                stack.push_back(node.left);
+                stack.push_back(node.left + 1);
+            }
+        } else if (hitLeft) {
+            stack.push_back(node.left);
+        } else if (hitRight) {
+            stack.push_back(node.left + 1);
+        }
+    }
+
+    if (hit) {
+        outHit.position = origin + direction * outHit.distance;
+    }
+    return hit;
+}
@@ -0,0 +1,56 @@
+#ifndef MESHBVH_H
+#define MESHBVH_H
+
+#include <cfloat>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Utils/AABB.h"
+
+namespace vov {
+    // Triangle BVH in mesh local space, used for CPU ray picking.
+    // Keeps its own copy of the positions since the vertex buffer lives on the GPU.
+    class MeshBVH {
+    public:
+        struct Node {
+            AABB bounds{};
+            uint32_t first{};   // first triangle of this subtree
+            uint32_t count{};   // number of triangles in this subtree
+            uint32_t left{};    // left child, right child is left + 1, 0 for leaves
+
+            [[nodiscard]] bool IsLeaf() const { return left == 0; }
+        };
+
+        struct TriangleHit {
+            uint32_t triangle{};        // index of the triangle in the original index buffer (firstIndex / 3)
+            float distance{};           // in units of the ray direction
+            glm::vec3 position{};       // mesh local space
+            glm::vec2 barycentrics{};
+        };
+
+        // Indices can be empty for non indexed meshes, every 3 positions are a triangle then
+        void Build(std::vector<glm::vec3> positions, const std::vector<uint32_t>& indices);
+
+        bool Raycast(const glm::vec3& origin, const glm::vec3& direction, TriangleHit& outHit, float maxDistance = FLT_MAX) const;
+
+        [[nodiscard]] bool IsEmpty() const { return m_nodes.empty(); }
+        [[nodiscard]] uint32_t GetTriangleCount() const { return static_cast<uint32_t>(m_triangleIds.size()); }
+        [[nodiscard]] const std::vector<glm::vec3>& GetPositions() const { return m_positions; }
+
+        // Triangles in BVH order, 3 indices each, matching GetTriangleId
+        [[nodiscard]] const std::vector<uint32_t>& GetIndices() const { return m_indices; }
+        [[nodiscard]] uint32_t GetTriangleId(uint32_t bvhTriangle) const { return m_triangleIds[bvhTriangle]; }
+
+    private:
+        static constexpr uint32_t MAX_LEAF_TRIANGLES = 4;
+
+        std::vector<Node> m_nodes{};
+        std::vector<glm::vec3> m_positions{};
+        std::vector<uint32_t> m_indices{};
+        std::vector<uint32_t> m_triangleIds{};
+    };
+}
+
+#endif //MESHBVH_H
@@ -1,14 +1,15 @@
 #include "Model.h"
 
-#include <execution>
+#include <algorithm>
 #include <iostream>
+#include <iterator>
 #include <assimp/Importer.hpp>
 #include <assimp/postprocess.h>
 #include <assimp/scene.h>
 #include <glm/gtc/type_ptr.hpp>
 
 #include "GameObject.h"
-#include "Descriptors/DescriptorWriter.h"
+#include "Resources/MaterialTable.h"
 #include "Utils/LineManager.h"
 #include "Utils/Timer.h"
 
@@ -234,29 +235,15 @@ namespace vov {
         m_builders.erase(std::ranges::remove_if(m_builders,
                                                 [] (const Mesh::Builder& builder) { return builder.vertices.empty(); }).begin(), m_builders.end());
 
-
-        m_descriptorPool = DescriptorPool::Builder(m_device)
-                .setMaxSets(static_cast<uint32_t>(m_builders.size()))
-                .addPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, static_cast<uint32_t>(m_builders.size()))
-                .addPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, static_cast<uint32_t>(m_builders.size()) * 4)
-                .build();
-
-        m_descriptorSetLayout = DescriptorSetLayout::Builder(m_device)
-                .addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT)
-                .addBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT) // Albedo
-                .addBinding(2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT) // Normal
-                .addBinding(3, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT) // Specular
-                .addBinding(4, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT) // Bump
-                .build();
-
-        //TODO: fix the above to just have 1 DescriptorSetLayout and not one here and in VApp.cpp
-        //Stupid stupid fix
-
-        for (auto& builder: m_builders) {
-            builder.descriptorSetLayout = m_descriptorSetLayout.get();
-            builder.descriptorPool = m_descriptorPool.get();
+        // Textures decode in parallel up front, the meshes then only find them loaded
+        std::vector<ResourceManager::ImageRequest> textures{};
+        for (const auto& builder: m_builders) {
+            std::ranges::move(Mesh::GetTextureRequests(builder.material), std::back_inserter(textures));
         }
+        ResourceManager::GetInstance().PreloadImages(m_device, textures, Mesh::TEXTURE_USAGE, VMA_MEMORY_USAGE_GPU_ONLY);
 
+        // Meshes sharing a material share its entry, the whole model's materials go up in one copy
+        MaterialTable::BatchScope materialBatch{};
         for (const auto& builder: m_builders) {
             auto mesh = std::make_unique<Mesh>(m_device, builder);
             mesh->getTransform().SetWorldMatrix(builder.transform); // Apply transform
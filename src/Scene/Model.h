@@ -4,7 +4,6 @@
 #include <vector>
 
 #include "assimp/scene.h"
-#include "Descriptors/DescriptorPool.h"
 #include "Scene/Mesh.h"
 #include "Utils/AABB.h"
 
@@ -44,8 +43,6 @@ namespace vov {
         AABB m_boundingBox{};
 
         std::vector<Mesh::Builder> m_builders;
-        std::unique_ptr<DescriptorPool> m_descriptorPool;
-        std::unique_ptr<DescriptorSetLayout> m_descriptorSetLayout;
     };
 }
 
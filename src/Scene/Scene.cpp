@@ -6,6 +6,7 @@ namespace vov {
 
     void Scene::addGameObject(std::unique_ptr<GameObject> gameObject) {
         m_gameObjects.push_back(std::move(gameObject));
+        m_bvhDirty = true;
     }
 
     void Scene::addLineSegment(const LineSegment& lineSegment) {
@@ -48,6 +49,27 @@ namespace vov {
         return sceneAABB;
     }
 
+    void Scene::UpdateBVH() {
+        if (!m_bvhDirty) {
+            m_bvh.Refit();
+            return;
+        }
+
+        m_meshes.clear();
+        for (const auto& gameObject : m_gameObjects) {
+            if (gameObject->model) {
+                for (const auto& mesh : gameObject->model->getMeshes()) {
+                    mesh->SetSceneIndex(static_cast<uint32_t>(m_meshes.size()));
+                    m_meshes.push_back(mesh.get());
+                }
+            }
+        }
+
+        m_bvh.Build(m_meshes);
+        ++m_meshVersion;
+        m_bvhDirty = false;
+    }
+
     void Scene::clearLineSegments() {
         m_lineSegments.clear();
     }
@@ -67,6 +89,9 @@ namespace vov {
 
     void Scene::SceneUnLoad() {
         m_gameObjects.clear();
+        m_meshes.clear();
+        m_bvh.Clear();
+        m_bvhDirty = true;
         m_lineSegments.clear();
         m_bezierCurves.clear();
         m_isLoaded = false;
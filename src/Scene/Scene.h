@@ -8,6 +8,7 @@
 #include "Lights/PointLight.h"
 #include "Rendering/RenderSystems/LineRenderSystem.h"
 #include "Scene/GameObject.h"
+#include "Scene/SceneBVH.h"
 
 namespace vov {
     class Scene {
@@ -22,6 +23,15 @@ namespace vov {
 
         AABB CalculateSceneAABB() const;
 
+        // Rebuilds the BVH after objects were added, otherwise just refits it for meshes that moved
+        void UpdateBVH();
+        [[nodiscard]] const SceneBVH& GetBVH() const { return m_bvh; }
+        // Meshes numbered by the last rebuild, see Mesh::GetSceneIndex
+        [[nodiscard]] uint32_t GetMeshCount() const { return static_cast<uint32_t>(m_meshes.size()); }
+        [[nodiscard]] Mesh* GetMesh(uint32_t sceneIndex) const { return m_meshes[sceneIndex]; }
+        // Bumped on every rebuild, anything built per mesh (like SceneGeometry) is stale when this changes
+        [[nodiscard]] uint32_t GetMeshVersion() const { return m_meshVersion; }
+
         std::vector<std::unique_ptr<GameObject>>& getGameObjects() { return m_gameObjects; }
         std::vector<LineSegment>& getLineSegments() { return m_lineSegments; }
         std::vector<BezierCurve>& getBezierCurves() { return m_bezierCurves; }
@@ -64,6 +74,11 @@ namespace vov {
 
         DirectionalLight m_directionalLight{};
 
+        SceneBVH m_bvh{};
+        bool m_bvhDirty{true};
+        std::vector<Mesh*> m_meshes{};  // by Mesh::GetSceneIndex
+        uint32_t m_meshVersion{0};
+
         std::function<void(Scene*)> m_loadFunction;
 
         float m_enviromentIntensity = 1.0f;
@@ -0,0 +1,455 @@
+#include "SceneBVH.h"
+
+#include <array>
+#include <algorithm>
+#include <numeric>
+
+#include "Mesh.h"
+
+namespace {
+    vov::AABB EmptyBox() {
+        return {glm::vec3(FLT_MAX), glm::vec3(-FLT_MAX)};
+    }
+
+    void Grow(vov::AABB& box, const vov::AABB& other) {
+        box.min = glm::min(box.min, other.min);
+        box.max = glm::max(box.max, other.max);
+    }
+
+    void Grow(vov::AABB& box, const glm::vec3& point) {
+        box.min = glm::min(box.min, point);
+        box.max = glm::max(box.max, point);
+    }
+
+    float SurfaceArea(const vov::AABB& box) {
+        if (box.min.x > box.max.x) {
+            return 0.f;
+        }
+        const glm::vec3 extent = box.max - box.min;
+        return 2.f * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+    }
+
+    bool IntersectRayBox(const glm::vec3& origin, const glm::vec3& invDir, const vov::AABB& box, float maxDistance, float& outDistance) {
+        const glm::vec3 t0 = (box.min - origin) * invDir;
+        const glm::vec3 t1 = (box.max - origin) * invDir;
+        const glm::vec3 tSmall = glm::min(t0, t1);
+        const glm::vec3 tBig = glm::max(t0, t1);
+
+        const float tMin = glm::max(glm::max(tSmall.x, tSmall.y), glm::max(tSmall.z, 0.f));
+        const float tMax = glm::min(glm::min(tBig.x, tBig.y), glm::min(tBig.z, maxDistance));
+
+        outDistance = tMin;
+        return tMin <= tMax;
+    }
+
+    bool SphereOverlapsBox(const glm::vec3& center, float radius, const vov::AABB& box) {
+        const glm::vec3 closest = glm::clamp(center, box.min, box.max);
+        const glm::vec3 delta = closest - center;
+        return glm::dot(delta, delta) <= radius * radius;
+    }
+
+    bool BoxOverlapsBox(const vov::AABB& a, const vov::AABB& b) {
+        return a.min.x <= b.max.x && a.max.x >= b.min.x &&
+               a.min.y <= b.max.y && a.max.y >= b.min.y &&
+               a.min.z <= b.max.z && a.max.z >= b.min.z;
+    }
+
+    template<typename OverlapFunc>
+    void QueryOverlap(const vov::SceneBVH& bvh, OverlapFunc&& overlaps, std::vector<vov::Mesh*>& outMeshes) {
+        const auto& nodes = bvh.GetNodes();
+        if (nodes.empty()) {
+            return;
+        }
+
+        const auto& items = bvh.GetItems();
+        const auto& itemBounds = bvh.GetItemBounds();
+
+        std::vector<uint32_t> stack{0};
+        while (!stack.empty()) {
+            const auto& node = nodes[stack.back()];
+            stack.pop_back();
+
+            if (!overlaps(node.bounds)) {
+                continue;
+            }
+
+            if (node.IsLeaf()) {
+                for (uint32_t i = node.first; i < node.first + node.count; ++i) {
+                    if (overlaps(itemBounds.Get(i))) {
+                        outMeshes.push_back(items[i]);
+                    }
+                }
+            } else {
+                stack.push_back(node.left + 1);
+                stack.push_back(node.left);
+            }
+        }
+    }
+}
+
+void vov::SceneBVH::Build(const std::vector<Mesh*>& meshes) {
+    Clear();
+    if (meshes.empty()) {
+        return;
+    }
+
+    const auto count = static_cast<uint32_t>(meshes.size());
+
+    std::vector<AABB> bounds(count);
+    std::vector<glm::vec3> centroids(count);
+    std::vector<uint32_t> versions(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        Transform& transform = meshes[i]->getTransform();
+        bounds[i] = TransformAABB(meshes[i]->GetBoundingBox(), transform.GetWorldMatrix());
+        versions[i] = transform.GetMatrixVersion();
+        centroids[i] = bounds[i].GetCenter();
+    }
+
+    std::vector<uint32_t> order(count);
+    std::iota(order.begin(), order.end(), 0u);
+
+    // A binary tree with n leaves never has more than 2n - 1 nodes, so this never reallocates
+    m_nodes.reserve(static_cast<size_t>(count) * 2);
+    m_nodes.push_back({{}, 0, count, 0});
+
+    std::vector<uint32_t> stack{0};
+    while (!stack.empty()) {
+        const uint32_t nodeIndex = stack.back();
+        stack.pop_back();
+
+        Subdivide(nodeIndex, order, bounds, centroids);
+        if (!m_nodes[nodeIndex].IsLeaf()) {
+            stack.push_back(m_nodes[nodeIndex].left);
+            stack.push_back(m_nodes[nodeIndex].left + 1);
+        }
+    }
+
+    m_items.resize(count);
+    m_itemBounds.Resize(count);
+    m_itemVersions.resize(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        m_items[i] = meshes[order[i]];
+        m_itemBounds.Set(i, bounds[order[i]]);
+        m_itemVersions[i] = versions[order[i]];
+    }
+}
+
+void vov::SceneBVH::Clear() {
+    m_nodes.clear();
+    m_items.clear();
+    m_itemBounds.Clear();
+    m_itemVersions.clear();
+}
+
+void vov::SceneBVH::Subdivide(uint32_t nodeIndex, std::vector<uint32_t>& order, const std::vector<AABB>& bounds, const std::vector<glm::vec3>& centroids) {
+    const uint32_t first = m_nodes[nodeIndex].first;
+    const uint32_t count = m_nodes[nodeIndex].count;
+
+    AABB nodeBounds = EmptyBox();
+    AABB centroidBounds = EmptyBox();
+    for (uint32_t i = first; i < first + count; ++i) {
+        Grow(nodeBounds, bounds[order[i]]);
+        Grow(centroidBounds, centroids[order[i]]);
+    }
+    m_nodes[nodeIndex].bounds = nodeBounds;
+
+    if (count <= 1) {
+        return;
+    }
+
+    struct Bin {
+        AABB bounds = EmptyBox();
+        uint32_t count{};
+    };
+
+    float bestCost = FLT_MAX;
+    int bestAxis = -1;
+    uint32_t bestSplit = 0;
+
+    for (int axis = 0; axis < 3; ++axis) {
+        const float axisMin = centroidBounds.min[axis];
+        const float axisMax = centroidBounds.max[axis];
+        if (axisMax - axisMin <= 1e-6f) {
+            continue;
+        }
+
+        std::array<Bin, SAH_BINS> bins{};
+        const float scale = static_cast<float>(SAH_BINS) / (axisMax - axisMin);
+        for (uint32_t i = first; i < first + count; ++i) {
+            const uint32_t item = order[i];
+            const auto binIndex = std::min(SAH_BINS - 1, static_cast<uint32_t>((centroids[item][axis] - axisMin) * scale));
+            bins[binIndex].count++;
+            Grow(bins[binIndex].bounds, bounds[item]);
+        }
+
+        // Sweep from both sides to get the cost of splitting after every bin
+        std::array<float, SAH_BINS - 1> leftArea{};
+        std::array<float, SAH_BINS - 1> rightArea{};
+        std::array<uint32_t, SAH_BINS - 1> leftCount{};
+        std::array<uint32_t, SAH_BINS - 1> rightCount{};
+
+        AABB leftBox = EmptyBox();
+        AABB rightBox = EmptyBox();
+        uint32_t leftSum = 0;
+        uint32_t rightSum = 0;
+        for (uint32_t i = 0; i < SAH_BINS - 1; ++i) {
+            leftSum += bins[i].count;
+            Grow(leftBox, bins[i].bounds);
+            leftCount[i] = leftSum;
+            leftArea[i] = SurfaceArea(leftBox);
+
+            rightSum += bins[SAH_BINS - 1 - i].count;
+            Grow(rightBox, bins[SAH_BINS - 1 - i].bounds);
+            rightCount[SAH_BINS - 2 - i] = rightSum;
+            rightArea[SAH_BINS - 2 - i] = SurfaceArea(rightBox);
+        }
+
+        for (uint32_t i = 0; i < SAH_BINS - 1; ++i) {
+            if (leftCount[i] == 0 || rightCount[i] == 0) {
+                continue;
+            }
+            const float cost = static_cast<float>(leftCount[i]) * leftArea[i] + static_cast<float>(rightCount[i]) * rightArea[i];
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestAxis = axis;
+                bestSplit = i + 1;
+            }
+        }
+    }
+
+    // Keep small nodes as leaves when splitting doesn't pay off, big ones get split regardless
+    const float nodeArea = SurfaceArea(nodeBounds);
+    const float leafCost = static_cast<float>(count) * nodeArea;
+    if (bestCost + SAH_TRAVERSAL_COST * nodeArea >= leafCost && count <= MAX_LEAF_ITEMS) {
+        return;
+    }
+
+    uint32_t mid = first;
+    if (bestAxis != -1) {
+        const float axisMin = centroidBounds.min[bestAxis];
+        const float scale = static_cast<float>(SAH_BINS) / (centroidBounds.max[bestAxis] - axisMin);
+        const auto middle = std::partition(order.begin() + first, order.begin() + first + count, [&] (uint32_t item) {
+            const auto binIndex = std::min(SAH_BINS - 1, static_cast<uint32_t>((centroids[item][bestAxis] - axisMin) * scale));
+            return binIndex < bestSplit;
+        });
+        mid = static_cast<uint32_t>(middle - order.begin());
+    }
+
+    // All centroids in the same spot, just cut the range in half
+    if (mid == first || mid == first + count) {
+        mid = first + count / 2;
+    }
+
+    const auto left = static_cast<uint32_t>(m_nodes.size());
+    m_nodes.push_back({{}, first, mid - first, 0});
+    m_nodes.push_back({{}, mid, first + count - mid, 0});
+    m_nodes[nodeIndex].left = left;
+}
+
+bool vov::SceneBVH::Refit() {
+    bool changed = false;
+    for (size_t i = 0; i < m_items.size(); ++i) {
+        Transform& transform = m_items[i]->getTransform();
+        const glm::mat4& world = transform.GetWorldMatrix();
+        if (transform.GetMatrixVersion() != m_itemVersions[i]) {
+            m_itemVersions[i] = transform.GetMatrixVersion();
+            m_itemBounds.Set(i, TransformAABB(m_items[i]->GetBoundingBox(), world));
+            changed = true;
+        }
+    }
+
+    if (changed) {
+        RefitNodes();
+    }
+    return changed;
+}
+
+void vov::SceneBVH::RefitNodes() {
+    // Children always come after their parent, so walking backwards updates bottom up
+    for (size_t i = m_nodes.size(); i-- > 0;) {
+        Node& node = m_nodes[i];
+        node.bounds = EmptyBox();
+        if (node.IsLeaf()) {
+            for (uint32_t item = node.first; item < node.first + node.count; ++item) {
+                Grow(node.bounds, m_itemBounds.Get(item));
+            }
+        } else {
+            Grow(node.bounds, m_nodes[node.left].bounds);
+            Grow(node.bounds, m_nodes[node.left + 1].bounds);
+        }
+    }
+}
+
+void vov::SceneBVH::QueryFrustum(const Camera::Frustum& frustum, std::vector<Mesh*>& outMeshes) const {
+    if (m_nodes.empty()) {
+        return;
+    }
+
+    // planeMask has a bit set for every plane the node still straddles, planes a parent is fully inside of get skipped
+    struct StackEntry {
+        uint32_t node;
+        uint32_t planeMask;
+    };
+
+    std::vector<StackEntry> stack{{0, 0x3F}};
+    std::vector<uint32_t> visibleItems{};
+
+    while (!stack.empty()) {
+        const StackEntry entry = stack.back();
+        stack.pop_back();
+
+        const Node& node = m_nodes[entry.node];
+        uint32_t planeMask = entry.planeMask;
+        bool outside = false;
+
+        for (int i = 0; i < 6; ++i) {
+            if ((planeMask & (1u << i)) == 0) {
+                continue;
+            }
+
+            const glm::vec4& plane = frustum.planes[i];
+            glm::vec3 positive = node.bounds.min;
+            glm::vec3 negative = node.bounds.max;
+            if (plane.x >= 0) { positive.x = node.bounds.max.x; negative.x = node.bounds.min.x; }
+            if (plane.y >= 0) { positive.y = node.bounds.max.y; negative.y = node.bounds.min.y; }
+            if (plane.z >= 0) { positive.z = node.bounds.max.z; negative.z = node.bounds.min.z; }
+
+            const glm::vec3 normal{plane};
+            if (glm::dot(normal, positive) + plane.w < 0) {
+                outside = true;
+                break;
+            }
+            if (glm::dot(normal, negative) + plane.w >= 0) {
+                planeMask &= ~(1u << i);
+            }
+        }
+
+        if (outside) {
+            continue;
+        }
+
+        if (planeMask == 0) {
+            outMeshes.insert(outMeshes.end(), m_items.begin() + node.first, m_items.begin() + node.first + node.count);
+            continue;
+        }
+
+        if (node.IsLeaf()) {
+            visibleItems.clear();
+            FrustumCullIndices(frustum, m_itemBounds, node.first, node.count, visibleItems);
+            for (const uint32_t item : visibleItems) {
+                outMeshes.push_back(m_items[item]);
+            }
+            continue;
+        }
+
+        stack.push_back({node.left + 1, planeMask});
+        stack.push_back({node.left, planeMask});
+    }
+}
+
+void vov::SceneBVH::QuerySphere(const glm::vec3& center, float radius, std::vector<Mesh*>& outMeshes) const {
+    QueryOverlap(*this, [&] (const AABB& box) {
+        return SphereOverlapsBox(center, radius, box);
+    }, outMeshes);
+}
+
+void vov::SceneBVH::QueryBox(const AABB& box, std::vector<Mesh*>& outMeshes) const {
+    QueryOverlap(*this, [&] (const AABB& other) {
+        return BoxOverlapsBox(box, other);
+    }, outMeshes);
+}
+
+template<typename ItemHitFunc>
+bool vov::SceneBVH::RaycastImpl(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, RayHit& outHit, ItemHitFunc&& itemHit) const {
+    if (m_nodes.empty()) {
+        return false;
+    }
+
+    const glm::vec3 invDir = 1.0f / direction;
+    float bestDistance = maxDistance;
+    bool hit = false;
+
+    std::vector<uint32_t> stack{0};
+    while (!stack.empty()) {
+        const Node& node = m_nodes[stack.back()];
+        stack.pop_back();
+
+        float distance;
+        if (!IntersectRayBox(origin, invDir, node.bounds, bestDistance, distance)) {
+            continue;
+        }
+
+        if (node.IsLeaf()) {
+            for (uint32_t i = node.first; i < node.first + node.count; ++i) {
+                if (IntersectRayBox(origin, invDir, m_itemBounds.Get(i), bestDistance, distance) && itemHit(i, distance, bestDistance, outHit)) {
+                    hit = true;
+                }
+            }
+            continue;
+        }
+
+        // Visit the closer child first so the far one usually gets rejected by bestDistance
+        float leftDistance;
+        float rightDistance;
+        const bool hitLeft = IntersectRayBox(origin, invDir, m_nodes[node.left].bounds, bestDistance, leftDistance);
+        const bool hitRight = IntersectRayBox(origin, invDir, m_nodes[node.left + 1].bounds, bestDistance, rightDistance);
+
+        if (hitLeft && hitRight) {
+            if (leftDistance <= rightDistance) {
+                stack.push_back(node.left + 1);
+                stack.push_back(node.left);
+            } else {
+                stack.push_back(node.left);
+                stack.push_back(node.left + 1);
+            }
+        } else if (hitLeft) {
+            stack.push_back(node.left);
+        } else if (hitRight) {
+            stack.push_back(node.left + 1);
+        }
+    }
+
+    return hit;
+}
+
+bool vov::SceneBVH::Raycast(const glm::vec3& origin, const glm::vec3& direction, RayHit& outHit, float maxDistance) const {
+    return RaycastImpl(origin, direction, maxDistance, outHit, [&] (uint32_t item, float, float& bestDistance, RayHit& hit) {
+        Mesh* mesh = m_items[item];
+        const MeshBVH& meshBVH = mesh->GetBVH();
+        if (meshBVH.IsEmpty()) {
+            return false;
+        }
+
+        // The world matrix is affine, so the local ray keeps the same t as the world one
+        const glm::mat4 invWorld = glm::inverse(mesh->getTransform().GetWorldMatrix());
+        const glm::vec3 localOrigin = glm::vec3(invWorld * glm::vec4(origin, 1.0f));
+        const glm::vec3 localDirection = glm::vec3(invWorld * glm::vec4(direction, 0.0f));
+
+        MeshBVH::TriangleHit triangleHit{};
+        if (!meshBVH.Raycast(localOrigin, localDirection, triangleHit, bestDistance)) {
+            return false;
+        }
+
+        bestDistance = triangleHit.distance;
+        hit.mesh = mesh;
+        hit.triangle = triangleHit.triangle;
+        hit.distance = triangleHit.distance;
+        hit.position = origin + direction * triangleHit.distance;
+        return true;
+    });
+}
+
+bool vov::SceneBVH::RaycastBounds(const glm::vec3& origin, const glm::vec3& direction, RayHit& outHit, float maxDistance) const {
+    return RaycastImpl(origin, direction, maxDistance, outHit, [&] (uint32_t item, float boxDistance, float& bestDistance, RayHit& hit) {
+        if (hit.mesh != nullptr && boxDistance >= bestDistance) {
+            return false;
+        }
+
+        bestDistance = boxDistance;
+        hit.mesh = m_items[item];
+        hit.triangle = 0;
+        hit.distance = boxDistance;
+        hit.position = origin + direction * boxDistance;
+        return true;
+    });
+}
@@ -0,0 +1,79 @@
+#ifndef SCENEBVH_H
+#define SCENEBVH_H
+
+#include <cfloat>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Utils/AABB.h"
+#include "Utils/Camera.h"
+#include "Utils/FrustumCulling.h"
+
+namespace vov {
+    class Mesh;
+
+    // BVH over the world space bounds of every mesh in a scene.
+    // Built with binned SAH, refit when mesh transforms change.
+    class SceneBVH {
+    public:
+        struct Node {
+            AABB bounds{};
+            uint32_t first{};   // first item of this subtree, items of a subtree are always contiguous
+            uint32_t count{};   // number of items in this subtree
+            uint32_t left{};    // left child, right child is left + 1, 0 for leaves
+
+            [[nodiscard]] bool IsLeaf() const { return left == 0; }
+        };
+
+        struct RayHit {
+            Mesh* mesh{nullptr};
+            uint32_t triangle{};    // only filled in by Raycast, see MeshBVH::TriangleHit
+            glm::vec3 position{};   // world space
+            float distance{};
+        };
+
+        void Build(const std::vector<Mesh*>& meshes);
+        void Clear();
+
+        // Recomputes the bounds of meshes whose transform changed and refits the tree, returns true if anything moved
+        bool Refit();
+
+        void QueryFrustum(const Camera::Frustum& frustum, std::vector<Mesh*>& outMeshes) const;
+        void QuerySphere(const glm::vec3& center, float radius, std::vector<Mesh*>& outMeshes) const;
+        void QueryBox(const AABB& box, std::vector<Mesh*>& outMeshes) const;
+
+        // Nearest triangle hit, goes through the per mesh triangle BVH for every mesh whose bounds are hit
+        bool Raycast(const glm::vec3& origin, const glm::vec3& direction, RayHit& outHit, float maxDistance = FLT_MAX) const;
+        // Nearest mesh whose bounds are hit by the ray
+        bool RaycastBounds(const glm::vec3& origin, const glm::vec3& direction, RayHit& outHit, float maxDistance = FLT_MAX) const;
+
+        [[nodiscard]] bool IsEmpty() const { return m_nodes.empty(); }
+        [[nodiscard]] const std::vector<Node>& GetNodes() const { return m_nodes; }
+        [[nodiscard]] const std::vector<Mesh*>& GetItems() const { return m_items; }
+        [[nodiscard]] const AABBSoA& GetItemBounds() const { return m_itemBounds; }
+
+    private:
+        static constexpr uint32_t MAX_LEAF_ITEMS = 8;
+        static constexpr uint32_t SAH_BINS = 12;
+        // Cost of visiting a node relative to testing one item, keeps leaves from ending up with a single mesh
+        static constexpr float SAH_TRAVERSAL_COST = 2.0f;
+
+        void Subdivide(uint32_t nodeIndex, std::vector<uint32_t>& order, const std::vector<AABB>& bounds, const std::vector<glm::vec3>& centroids);
+        void RefitNodes();
+
+        // Walks the tree near to far, itemHit(itemIndex, bestDistance, hit) narrows bestDistance when it hits something
+        template<typename ItemHitFunc>
+        bool RaycastImpl(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, RayHit& outHit, ItemHitFunc&& itemHit) const;
+
+        std::vector<Node> m_nodes{};
+
+        // Items are stored in leaf order so a leaf range can go straight into the SIMD culling kernel
+        std::vector<Mesh*> m_items{};
+        AABBSoA m_itemBounds{};
+        std::vector<uint32_t> m_itemVersions{};
+    };
+}
+
+#endif //SCENEBVH_H
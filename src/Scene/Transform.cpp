@@ -232,6 +232,7 @@ namespace vov {
 
         m_WorldMatrix = trans * rot * scale;
         m_MatrixDirty = false;
+        m_MatrixVersion++;
     }
 
     void Transform::SetPositionDirty() {
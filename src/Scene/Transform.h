@@ -1,6 +1,7 @@
 #ifndef TRANSFORM_H
 #define TRANSFORM_H
 
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <glm/glm.hpp>
@@ -34,6 +35,8 @@ namespace vov {
         const glm::vec3& GetWorldScale();
         const glm::quat& GetWorldRotation();
         const glm::mat4& GetWorldMatrix();
+        // Bumped every time the world matrix gets recalculated, only up to date after GetWorldMatrix()
+        [[nodiscard]] uint32_t GetMatrixVersion() const { return m_MatrixVersion; }
 
         [[nodiscard]] const glm::vec3& GetLocalPosition() const { return m_LocalPosition; }
         [[nodiscard]] const glm::quat& GetLocalRotation() const { return m_LocalRotation; }
@@ -95,6 +98,7 @@ namespace vov {
         glm::vec3 m_WorldScale{1, 1, 1};
 
         glm::mat4 m_WorldMatrix{};
+        uint32_t m_MatrixVersion{0};
 
         Transform* m_Parent{};
         std::vector<Transform*> m_Children{};
@@ -1,6 +1,7 @@
 #include "AppGui.h"
 #include "Rendering/RenderSystems/ImguiRenderSystem.h"
 #include "Scene/Lights/PointLight.h"
+#include "Utils/DeltaTime.h"
 #include <glm/gtc/type_ptr.hpp>
 #include <fstream>
 #include <iostream>
@@ -8,11 +9,18 @@
 AppGui::AppGui(vov::ImguiRenderSystem* imguiRenderSystem, vov::Scene*& scene, vov::Camera* camera)
     : m_imguiRenderSystem(imguiRenderSystem), m_scene(scene), m_camera(camera) {}
 
-void AppGui::Render(double avgFps, int windowWidth, int windowHeight, vov::Transform*& selectedTransform,  vov::DebugView& currentDebugMode, const std::vector<vov::Scene*>& scenes) {
+AppGui::~AppGui() {
+    // The hook points at this, it has to go before we do
+    if (m_traceJobs) {
+        vov::JobSystem::GetInstance().SetTraceHook({});
+    }
+}
+
+void AppGui::Render(double avgFps, int windowWidth, int windowHeight, vov::Transform*& selectedTransform, bool& gpuPicking, vov::DebugView& currentDebugMode, const std::vector<vov::Scene*>& scenes, vov::SoftwareOcclusion& occlusion, vov::GpuCullPass& gpuCulling, vov::IndirectCullPass& indirectCulling, const QueueStats& queueStats, vov::DepthPrePass& depthPrePass, vov::SecondaryRecorder& recorder, vov::FramePipeline& framePipeline, vov::FramePacer& framePacer) {
     RenderMainMenuBar();
     RenderSceneLight();
-    RenderStats(avgFps, windowWidth, windowHeight);
-    RenderControls();
+    RenderStats(avgFps, windowWidth, windowHeight, occlusion, gpuCulling, indirectCulling, queueStats, depthPrePass, recorder, framePipeline, framePacer);
+    RenderControls(gpuPicking);
     RenderPointLights(selectedTransform);
     RenderCameraSettings();
     RenderDebugModes(currentDebugMode);
@@ -49,17 +57,160 @@ void AppGui::RenderSceneLight() {
     ImGui::End();
 }
 
-void AppGui::RenderStats(double avgFps, int windowWidth, int windowHeight) {
+void AppGui::RenderStats(double avgFps, int windowWidth, int windowHeight, vov::SoftwareOcclusion& occlusion, vov::GpuCullPass& gpuCulling, vov::IndirectCullPass& indirectCulling, const QueueStats& queueStats, vov::DepthPrePass& depthPrePass, vov::SecondaryRecorder& recorder, vov::FramePipeline& framePipeline, vov::FramePacer& framePacer) {
     ImGui::Begin("Stats");
     ImGui::Text("Avg FPS: %.1f", avgFps);
     ImGui::Text("Window Size: %d x %d", windowWidth, windowHeight);
+
+    ImGui::SeparatorText("Occlusion culling");
+    bool enabled = occlusion.IsEnabled();
+    if (ImGui::Checkbox("Enabled", &enabled)) {
+        occlusion.SetEnabled(enabled);
+    }
+    const auto& stats = occlusion.GetStats();
+    ImGui::Text("Occluders: %u (%u triangles)", stats.occluders, stats.occluderTriangles);
+    ImGui::Text("Culled: %u / %u", stats.culled, stats.tested);
+    ImGui::Text("Rasterize: %.2f ms, Test: %.2f ms", stats.rasterizeMs, stats.testMs);
+
+    ImGui::SeparatorText("GPU occlusion culling (HiZ)");
+    bool gpuEnabled = gpuCulling.IsEnabled();
+    if (ImGui::Checkbox("Enabled##GpuCulling", &gpuEnabled)) {
+        gpuCulling.SetEnabled(gpuEnabled);
+    }
+
+    ImGui::SeparatorText("GPU driven depth/shadow");
+    ImGui::BeginDisabled(!indirectCulling.IsSupported());
+    bool indirectEnabled = indirectCulling.IsEnabled();
+    if (ImGui::Checkbox("Enabled##IndirectCulling", &indirectEnabled)) {
+        indirectCulling.SetEnabled(indirectEnabled);
+    }
+    ImGui::EndDisabled();
+    if (!indirectCulling.IsSupported()) {
+        ImGui::Text("Needs multiDrawIndirect and drawIndirectCount");
+    } else if (indirectEnabled && gpuCulling.IsEnabled()) {
+        ImGui::Text("Overrides HiZ culling for the depth pre pass");
+    }
+
+    ImGui::SeparatorText("Depth pre pass");
+    auto& prepass = depthPrePass.GetOccluderSettings();
+    ImGui::Checkbox("Select occluders", &prepass.selectOccluders);
+    ImGui::SliderFloat("Min coverage", &prepass.minScreenCoverage, 0.f, 0.2f, "%.3f");
+    ImGui::DragScalar("Max triangles", ImGuiDataType_U32, &prepass.maxTriangles, 1000.f);
+    ImGui::Checkbox("Auto disable", &prepass.autoDisable);
+    ImGui::SliderFloat("Min total coverage", &prepass.minTotalCoverage, 0.f, 2.f);
+    ImGui::SliderFloat("Max triangle ratio", &prepass.maxTriangleRatio, 0.f, 1.f);
+    const auto& prepassStats = depthPrePass.GetOccluderStats();
+    ImGui::Text("%s", prepassStats.active ? "Active" : "Skipped, not paying for itself");
+    ImGui::Text("Occluders: %u / %u (%u / %u triangles)", prepassStats.occluders, prepassStats.visible, prepassStats.occluderTriangles, prepassStats.visibleTriangles);
+    ImGui::Text("Coverage: %.2f", prepassStats.coverage);
+
+    RenderFramePacing(framePacer);
+    RenderFramePipeline(framePipeline);
+    RenderJobSystem();
+
+    ImGui::SeparatorText("Render queues");
+    bool parallelEnabled = recorder.IsEnabled();
+    if (ImGui::Checkbox("Parallel recording", &parallelEnabled)) {
+        recorder.SetEnabled(parallelEnabled);
+    }
+    ImGui::Text("Threads: %u, split from %zu draws", recorder.GetThreadCount(), vov::SecondaryRecorder::MIN_DRAWS_PER_SLICE * 2);
+    for (const auto& [name, queue] : queueStats) {
+        ImGui::Text("%s: %u draws, %u secondaries", name.c_str(), queue.draws, queue.secondaries);
+        ImGui::Text("  Binds: %u pipeline, %u set, %u vertex, %u index", queue.pipelineBinds, queue.descriptorSetBinds, queue.vertexBufferBinds, queue.indexBufferBinds);
+        ImGui::Text("  Skipped: %u", queue.skipped);
+    }
     ImGui::End();
 }
 
-void AppGui::RenderControls() {
+void AppGui::RenderFramePacing(vov::FramePacer& framePacer) {
+    ImGui::SeparatorText("Frame pacing");
+
+    int mode = static_cast<int>(framePacer.GetMode());
+    ImGui::RadioButton("Uncapped", &mode, static_cast<int>(vov::FramePacer::Mode::UNCAPPED));
+    ImGui::SameLine();
+    ImGui::RadioButton("Target rate", &mode, static_cast<int>(vov::FramePacer::Mode::TARGET_RATE));
+    ImGui::SameLine();
+    ImGui::RadioButton("VSync", &mode, static_cast<int>(vov::FramePacer::Mode::PRESENT));
+    framePacer.SetMode(static_cast<vov::FramePacer::Mode>(mode));
+
+    if (framePacer.GetMode() == vov::FramePacer::Mode::TARGET_RATE) {
+        float targetRate = static_cast<float>(framePacer.GetTargetRate());
+        if (ImGui::SliderFloat("Target FPS", &targetRate, 10.f, 500.f, "%.0f")) {
+            framePacer.SetTargetRate(targetRate);
+        }
+        ImGui::Text("Spin margin: %.2f ms", framePacer.GetSpinMargin());
+    }
+
+    bool lowLatency = framePacer.IsLowLatency();
+    if (ImGui::Checkbox("Low latency", &lowLatency)) {
+        framePacer.SetLowLatency(lowLatency);
+    }
+
+    const auto percentiles = [] (const char* label, const vov::FramePacer::Percentiles& times) {
+        ImGui::Text("%s: %.2f / %.2f / %.2f ms, max %.2f", label, times.p50, times.p95, times.p99, times.max);
+    };
+    ImGui::TextDisabled("p50 / p95 / p99");
+    percentiles("Frame", framePacer.GetFrameTimes());
+    percentiles("GPU", framePacer.GetGpuTimes());
+    if (framePacer.IsLowLatency()) {
+        percentiles("Latency", framePacer.GetLatencies());
+    }
+
+    auto& deltaTime = vov::DeltaTime::GetInstance();
+    ImGui::Text("Simulation: %.0f Hz fixed, blend %.2f", 1.0 / deltaTime.GetFixedDeltaTime(), deltaTime.GetInterpolationAlpha());
+}
+
+void AppGui::RenderFramePipeline(vov::FramePipeline& framePipeline) {
+    ImGui::SeparatorText("Frame pipeline");
+    // The GUI only runs while the render thread is idle, so this is safe to flip
+    bool pipelined = framePipeline.IsEnabled();
+    if (ImGui::Checkbox("Render thread", &pipelined)) {
+        framePipeline.SetEnabled(pipelined);
+    }
+    const vov::FramePipeline::Timings& timings = framePipeline.GetTimings();
+    ImGui::Text("Simulate: %.2f ms, wait: %.2f ms, render: %.2f ms", timings.simulate, timings.wait, timings.render);
+}
+
+void AppGui::RenderJobSystem() {
+    ImGui::SeparatorText("Job system");
+    auto& jobSystem = vov::JobSystem::GetInstance();
+    ImGui::Text("Workers: %u", jobSystem.GetWorkerCount());
+
+    // Only toggled from here, between frames nothing is scheduled
+    if (ImGui::Checkbox("Trace jobs", &m_traceJobs)) {
+        m_tracedJobs = 0;
+        m_tracedJobNs = 0;
+        if (m_traceJobs) {
+            jobSystem.SetTraceHook([this] (const vov::JobSystem::TraceEvent& event) {
+                m_tracedJobs.fetch_add(1, std::memory_order_relaxed);
+                m_tracedJobNs.fetch_add(static_cast<uint64_t>(event.endNs - event.beginNs), std::memory_order_relaxed);
+            });
+        } else {
+            jobSystem.SetTraceHook({});
+        }
+    }
+    if (m_traceJobs) {
+        const uint64_t jobs = m_tracedJobs.load(std::memory_order_relaxed);
+        const double busyMs = static_cast<double>(m_tracedJobNs.load(std::memory_order_relaxed)) / 1e6;
+        ImGui::Text("Jobs: %llu, busy: %.1f ms", static_cast<unsigned long long>(jobs), busyMs);
+    }
+
+    if (ImGui::Button("Benchmark scheduling")) {
+        m_jobBenchmark = jobSystem.Benchmark(100000);
+    }
+    if (m_jobBenchmark.jobs > 0) {
+        ImGui::Text("%u empty jobs, per job:", m_jobBenchmark.jobs);
+        ImGui::Text("  Schedule: %.0f ns, round trip: %.0f ns", m_jobBenchmark.scheduleNs, m_jobBenchmark.roundTripNs);
+        ImGui::Text("  Parallel for batch: %.0f ns", m_jobBenchmark.parallelForNs);
+    }
+}
+
+void AppGui::RenderControls(bool& gpuPicking) {
     ImGui::Begin("Controls");
     ImGui::Text("WASD: Move Camera");
     ImGui::Text("Press ` to lock/unlock cursor");
+    ImGui::Text("Left click: select mesh");
+    ImGui::Checkbox("GPU picking", &gpuPicking);
     ImGui::End();
 }
 
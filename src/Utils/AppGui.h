@@ -1,10 +1,23 @@
 #ifndef APPGUI_H
 #define APPGUI_H
 
+#include "Core/FramePacer.h"
+#include "Core/FramePipeline.h"
+#include "Core/JobSystem.h"
 #include "Scene/Scene.h"
 #include "Utils/Camera.h"
+#include "Utils/SoftwareOcclusion.h"
+#include "Rendering/Passes/DepthPrePass.h"
+#include "Rendering/Passes/GpuCullPass.h"
+#include "Rendering/Passes/IndirectCullPass.h"
+#include "Rendering/RenderQueue.h"
+#include "Rendering/SecondaryRecorder.h"
 #include <glm/glm.hpp>
+#include <atomic>
 #include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace vov {
     class ImguiRenderSystem;
@@ -12,25 +25,35 @@ namespace vov {
 
 class AppGui {
 public:
+    using QueueStats = std::vector<std::pair<std::string, vov::RenderQueue::Stats>>;
+
     AppGui(vov::ImguiRenderSystem* imguiRenderSystem, vov::Scene*& scene, vov::Camera* camera);
-    ~AppGui() = default;
+    ~AppGui();
 
-    void Render(double avgFps, int windowWidth, int windowHeight, vov::Transform*& selectedTransform, vov::DebugView& currentDebugMode, const std::vector<vov::Scene*>& scenes);
+    void Render(double avgFps, int windowWidth, int windowHeight, vov::Transform*& selectedTransform, bool& gpuPicking, vov::DebugView& currentDebugMode, const std::vector<vov::Scene*>& scenes, vov::SoftwareOcclusion& occlusion, vov::GpuCullPass& gpuCulling, vov::IndirectCullPass& indirectCulling, const QueueStats& queueStats, vov::DepthPrePass& depthPrePass, vov::SecondaryRecorder& recorder, vov::FramePipeline& framePipeline, vov::FramePacer& framePacer);
 
 private:
     void RenderMainMenuBar();
     void RenderSceneLight();
-    void RenderStats(double avgFps, int windowWidth, int windowHeight);
-    void RenderControls();
+    void RenderStats(double avgFps, int windowWidth, int windowHeight, vov::SoftwareOcclusion& occlusion, vov::GpuCullPass& gpuCulling, vov::IndirectCullPass& indirectCulling, const QueueStats& queueStats, vov::DepthPrePass& depthPrePass, vov::SecondaryRecorder& recorder, vov::FramePipeline& framePipeline, vov::FramePacer& framePacer);
+    void RenderControls(bool& gpuPicking);
     void RenderPointLights(vov::Transform*& selectedTransform);
     void RenderCameraSettings();
     void RenderDebugModes(vov::DebugView& currentDebugMode);
     void RenderSceneSelector(const std::vector<vov::Scene*>& scenes, vov::Scene*& currentScene);
-
+    void RenderFramePacing(vov::FramePacer& framePacer);
+    void RenderFramePipeline(vov::FramePipeline& framePipeline);
+    void RenderJobSystem();
 
     vov::ImguiRenderSystem* m_imguiRenderSystem;
     vov::Scene*& m_scene;
     vov::Camera* m_camera;
+
+    vov::JobSystem::BenchmarkResult m_jobBenchmark{};
+    // Filled by the job system's trace hook from the workers
+    bool m_traceJobs{false};
+    std::atomic<uint64_t> m_tracedJobs{0};
+    std::atomic<uint64_t> m_tracedJobNs{0};
 };
 
 #endif //APPGUI_H
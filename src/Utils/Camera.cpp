@@ -102,8 +102,6 @@ namespace vov {
             totalPitch += yOffset;
 
             totalPitch = glm::clamp(totalPitch, -glm::half_pi<float>() + 0.01f, glm::half_pi<float>() - 0.01f);
-
-            m_frustum.update(m_projectionMatrix * m_viewMatrix);
         }
 
         wasCursorLockedLastFrame = isLocked;
@@ -153,6 +151,26 @@ namespace vov {
 
         CalculateProjectionMatrix();
         CalculateViewMatrix();
+
+        m_frustum.update(m_projectionMatrix * m_viewMatrix);
+    }
+
+    Camera Camera::Interpolate(const Camera& from, const Camera& to, float alpha) {
+        Camera camera = to;
+        camera.m_position = glm::mix(from.m_position, to.m_position, alpha);
+
+        // Nearly opposite directions don't blend, the newer one is fine for a single frame
+        const glm::vec3 forward = glm::mix(from.m_forward, to.m_forward, alpha);
+        if (glm::length(forward) > 0.001f) {
+            camera.m_forward = glm::normalize(forward);
+            camera.m_right = glm::normalize(glm::cross(camera.m_forward, glm::vec3(0, 1, 0)));
+            camera.m_up = glm::normalize(glm::cross(camera.m_right, camera.m_forward));
+        }
+
+        camera.CalculateProjectionMatrix();
+        camera.CalculateViewMatrix();
+        camera.m_frustum.update(camera.m_projectionMatrix * camera.m_viewMatrix);
+        return camera;
     }
 
     void Camera::CalculateViewMatrix() {
@@ -172,6 +190,21 @@ namespace vov {
         m_projectionMatrix = glm::perspectiveRH_ZO(glm::radians(fovAngle), m_aspectRatio, m_zNear, m_zFar);
     }
 
+    void Camera::ScreenPointToRay(const glm::vec2& screenPos, const glm::vec2& screenSize, glm::vec3& outOrigin, glm::vec3& outDirection) const {
+        // The stored projection isn't y flipped, so screen top maps to ndc +1
+        const float ndcX = 2.0f * screenPos.x / screenSize.x - 1.0f;
+        const float ndcY = 1.0f - 2.0f * screenPos.y / screenSize.y;
+
+        const glm::mat4 invViewProj = glm::inverse(m_projectionMatrix * m_viewMatrix);
+        glm::vec4 nearPoint = invViewProj * glm::vec4(ndcX, ndcY, 0.0f, 1.0f);
+        glm::vec4 farPoint = invViewProj * glm::vec4(ndcX, ndcY, 1.0f, 1.0f);
+        nearPoint /= nearPoint.w;
+        farPoint /= farPoint.w;
+
+        outOrigin = glm::vec3(nearPoint);
+        outDirection = glm::normalize(glm::vec3(farPoint) - glm::vec3(nearPoint));
+    }
+
     void Camera::ClearTarget() {
         m_useTarget = false;
         m_forward = glm::normalize(m_target - m_position);
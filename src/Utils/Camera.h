@@ -94,6 +94,10 @@ namespace vov {
         explicit Camera(const glm::vec3& position, const glm::vec3& up);
         void Update(float deltaTime);
 
+        // to with its position and direction blended back towards from, matrices and frustum rebuilt.
+        // For rendering between two fixed updates, everything else is taken from to
+        [[nodiscard]] static Camera Interpolate(const Camera& from, const Camera& to, float alpha);
+
         void CalculateViewMatrix();
         void CalculateProjectionMatrix();
 
@@ -121,6 +125,9 @@ namespace vov {
 
         [[nodiscard]] const Frustum& GetFrustum() const { return m_frustum; }
 
+        // screenPos in pixels with the origin top left, outputs a world space ray
+        void ScreenPointToRay(const glm::vec2& screenPos, const glm::vec2& screenSize, glm::vec3& outOrigin, glm::vec3& outDirection) const;
+
         [[nodiscard]] glm::vec3 GetPosition() const { return m_position; }
         [[nodiscard]] glm::vec3 GetForward() const { return m_forward; }
         [[nodiscard]] glm::vec3 GetUp() const { return m_up; }
@@ -1,5 +1,7 @@
 #include "DeltaTime.h"
 
+#include <algorithm>
+
 namespace vov {
     double DeltaTime::GetFixedDeltaTime() const {
         return m_FixedDeltaTime;
@@ -9,16 +11,21 @@ namespace vov {
         return m_DeltaTime;
     }
 
-    std::chrono::nanoseconds DeltaTime::SleepDuration() const {
-        constexpr auto msPerFrame = std::chrono::milliseconds(static_cast<int>(1000.f / FPS));
-        const std::chrono::nanoseconds sleepTime = (m_PrevTime + msPerFrame - std::chrono::high_resolution_clock::now());
+    uint32_t DeltaTime::ConsumeFixedSteps() {
+        const auto steps = static_cast<uint32_t>(m_accumulator / m_FixedDeltaTime);
+        m_accumulator -= steps * m_FixedDeltaTime;
+        return steps;
+    }
 
-        return sleepTime;
+    float DeltaTime::GetInterpolationAlpha() const {
+        return static_cast<float>(std::clamp(m_accumulator / m_FixedDeltaTime, 0.0, 1.0));
     }
 
     void DeltaTime::Update() {
         const auto currentTime = std::chrono::high_resolution_clock::now();
         m_DeltaTime = std::chrono::duration<double>(currentTime - m_PrevTime).count();
         m_PrevTime = currentTime;
+
+        m_accumulator += std::min(m_DeltaTime, MAX_FRAME_TIME);
     }
 }
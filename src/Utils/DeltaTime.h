@@ -2,6 +2,7 @@
 #define DELTATIME_H
 
 #include <chrono>
+#include <cstdint>
 #include "Singleton.h"
 
 namespace vov {
@@ -15,7 +16,11 @@ namespace vov {
         [[nodiscard]] double GetFixedDeltaTime() const;
         [[nodiscard]] double GetDeltaTime() const;
 
-        [[nodiscard]] std::chrono::nanoseconds SleepDuration() const;
+        // Whole fixed steps the accumulated frame time covers, the caller runs that many simulation updates.
+        // A long hitch drops time past MAX_FRAME_TIME instead of trying to catch up on it
+        [[nodiscard]] uint32_t ConsumeFixedSteps();
+        // How far past the last fixed step the frame is, 0 to 1, for blending the last two simulation states
+        [[nodiscard]] float GetInterpolationAlpha() const;
 
         void Update();
 
@@ -24,9 +29,10 @@ namespace vov {
 
         DeltaTime() = default;
         static constexpr double m_FixedDeltaTime{1.0 / 60.0};
-        static constexpr double FPS{60};
+        static constexpr double MAX_FRAME_TIME{0.25};
         double m_DeltaTime{};
-        std::chrono::high_resolution_clock::time_point m_PrevTime;
+        double m_accumulator{};
+        std::chrono::high_resolution_clock::time_point m_PrevTime{std::chrono::high_resolution_clock::now()};
     };
 }
 
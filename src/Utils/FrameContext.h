@@ -1,11 +1,20 @@
 #ifndef FRAMECONTEXT_H
 #define FRAMECONTEXT_H
 
+#include <vector>
+
+#include <glm/glm.hpp>
+
 #include "Camera.h"
+#include "LineManager.h"
 #include "Core/Device.h"
+#include "Scene/Lights/DirectionalLight.h"
+#include "Scene/Lights/PointLight.h"
 
 namespace vov {
+    class Mesh;
     class Scene;
+    class SecondaryRecorder;
 
     enum class DebugView {
         NONE,
@@ -53,8 +62,15 @@ namespace vov {
         float frameTime{};
         VkCommandBuffer commandBuffer{};
         Camera& camera;
-        Scene& currentScene;
+        Scene& currentScene;                        // only for what doesn't change while a frame renders, meshes and their resources
+        const std::vector<Mesh*>& visibleMeshes;   // frustum and occlusion culled, from the camera's point of view
+        const std::vector<Mesh*>& shadowCasters;   // overlapping the directional light's shadow volume
+        const std::vector<glm::mat4>& worldMatrices;   // by Mesh::GetSceneIndex, never read the transforms themselves
+        DirectionalLight& directionalLight;
+        const std::vector<PointLight::PointLightData>& pointLights;
+        const std::vector<LineManager::Line>& lines;
         DebugView debugView = DebugView::NONE;
+        SecondaryRecorder* recorder{nullptr};      // null records every pass inline into commandBuffer
     };
 }
 
@@ -0,0 +1,177 @@
+#include "FrustumCulling.h"
+
+#include <bit>
+
+#if defined(__AVX2__)
+    #define VOV_CULL_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define VOV_CULL_SSE
+#endif
+
+#if defined(VOV_CULL_AVX2) || defined(VOV_CULL_SSE)
+#include <immintrin.h>
+#endif
+
+void vov::AABBSoA::Clear() {
+    minX.clear(); minY.clear(); minZ.clear();
+    maxX.clear(); maxY.clear(); maxZ.clear();
+}
+
+void vov::AABBSoA::Reserve(size_t count) {
+    minX.reserve(count); minY.reserve(count); minZ.reserve(count);
+    maxX.reserve(count); maxY.reserve(count); maxZ.reserve(count);
+}
+
+void vov::AABBSoA::Resize(size_t count) {
+    minX.resize(count); minY.resize(count); minZ.resize(count);
+    maxX.resize(count); maxY.resize(count); maxZ.resize(count);
+}
+
+void vov::AABBSoA::Add(const AABB& box) {
+    minX.push_back(box.min.x); minY.push_back(box.min.y); minZ.push_back(box.min.z);
+    maxX.push_back(box.max.x); maxY.push_back(box.max.y); maxZ.push_back(box.max.z);
+}
+
+void vov::AABBSoA::Set(size_t index, const AABB& box) {
+    minX[index] = box.min.x; minY[index] = box.min.y; minZ[index] = box.min.z;
+    maxX[index] = box.max.x; maxY[index] = box.max.y; maxZ[index] = box.max.z;
+}
+
+vov::AABB vov::AABBSoA::Get(size_t index) const {
+    return {
+        {minX[index], minY[index], minZ[index]},
+        {maxX[index], maxY[index], maxZ[index]}
+    };
+}
+
+namespace {
+    // Same p-vertex test as Frustum::isBoxVisible, but the min/max choice is done once per plane instead of per box
+    struct PreparedFrustum {
+        const float* px[6];
+        const float* py[6];
+        const float* pz[6];
+        float a[6];
+        float b[6];
+        float c[6];
+        float d[6];
+    };
+
+    PreparedFrustum PrepareFrustum(const vov::Camera::Frustum& frustum, const vov::AABBSoA& boxes) {
+        PreparedFrustum prepared{};
+        for (int i = 0; i < 6; ++i) {
+            const glm::vec4& plane = frustum.planes[i];
+            prepared.px[i] = plane.x >= 0 ? boxes.maxX.data() : boxes.minX.data();
+            prepared.py[i] = plane.y >= 0 ? boxes.maxY.data() : boxes.minY.data();
+            prepared.pz[i] = plane.z >= 0 ? boxes.maxZ.data() : boxes.minZ.data();
+            prepared.a[i] = plane.x;
+            prepared.b[i] = plane.y;
+            prepared.c[i] = plane.z;
+            prepared.d[i] = plane.w;
+        }
+        return prepared;
+    }
+
+    bool TestBox(const PreparedFrustum& p, size_t i) {
+        for (int plane = 0; plane < 6; ++plane) {
+            const float dist = p.a[plane] * p.px[plane][i] + p.b[plane] * p.py[plane][i] + p.c[plane] * p.pz[plane][i] + p.d[plane];
+            if (dist < 0.f) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+#if defined(VOV_CULL_AVX2)
+    constexpr size_t SIMD_WIDTH = 8;
+
+    // Returns one bit per box for boxes [i, i + 8)
+    uint32_t TestBlock(const PreparedFrustum& p, size_t i) {
+        const __m256 zero = _mm256_setzero_ps();
+        __m256 visible = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (int plane = 0; plane < 6; ++plane) {
+            const __m256 x = _mm256_loadu_ps(p.px[plane] + i);
+            const __m256 y = _mm256_loadu_ps(p.py[plane] + i);
+            const __m256 z = _mm256_loadu_ps(p.pz[plane] + i);
+
+            const __m256 dist = _mm256_add_ps(
+                _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(p.a[plane]), x), _mm256_mul_ps(_mm256_set1_ps(p.b[plane]), y)),
+                _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(p.c[plane]), z), _mm256_set1_ps(p.d[plane]))
+            );
+
+            // NLT instead of GE so NaN boxes stay visible, same as the scalar path
+            visible = _mm256_and_ps(visible, _mm256_cmp_ps(dist, zero, _CMP_NLT_UQ));
+            if (_mm256_movemask_ps(visible) == 0) {
+                return 0;
+            }
+        }
+        return static_cast<uint32_t>(_mm256_movemask_ps(visible));
+    }
+#elif defined(VOV_CULL_SSE)
+    constexpr size_t SIMD_WIDTH = 4;
+
+    // Returns one bit per box for boxes [i, i + 4)
+    uint32_t TestBlock(const PreparedFrustum& p, size_t i) {
+        const __m128 zero = _mm_setzero_ps();
+        __m128 visible = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (int plane = 0; plane < 6; ++plane) {
+            const __m128 x = _mm_loadu_ps(p.px[plane] + i);
+            const __m128 y = _mm_loadu_ps(p.py[plane] + i);
+            const __m128 z = _mm_loadu_ps(p.pz[plane] + i);
+
+            const __m128 dist = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(_mm_set1_ps(p.a[plane]), x), _mm_mul_ps(_mm_set1_ps(p.b[plane]), y)),
+                _mm_add_ps(_mm_mul_ps(_mm_set1_ps(p.c[plane]), z), _mm_set1_ps(p.d[plane]))
+            );
+
+            visible = _mm_and_ps(visible, _mm_cmpnlt_ps(dist, zero));
+            if (_mm_movemask_ps(visible) == 0) {
+                return 0;
+            }
+        }
+        return static_cast<uint32_t>(_mm_movemask_ps(visible));
+    }
+#else
+    constexpr size_t SIMD_WIDTH = 1;
+
+    uint32_t TestBlock(const PreparedFrustum& p, size_t i) {
+        return TestBox(p, i) ? 1u : 0u;
+    }
+#endif
+}
+
+size_t vov::FrustumCullIndices(const Camera::Frustum& frustum, const AABBSoA& boxes, size_t first, size_t count, std::vector<uint32_t>& outIndices) {
+    const size_t startSize = outIndices.size();
+    if (count == 0) {
+        return 0;
+    }
+
+    const PreparedFrustum prepared = PrepareFrustum(frustum, boxes);
+    const size_t end = first + count;
+
+    size_t i = first;
+    for (; i + SIMD_WIDTH <= end; i += SIMD_WIDTH) {
+        uint32_t bits = TestBlock(prepared, i);
+        while (bits != 0) {
+            outIndices.push_back(static_cast<uint32_t>(i + std::countr_zero(bits)));
+            bits &= bits - 1;
+        }
+    }
+    for (; i < end; ++i) {
+        if (TestBox(prepared, i)) {
+            outIndices.push_back(static_cast<uint32_t>(i));
+        }
+    }
+
+    return outIndices.size() - startSize;
+}
+
+size_t vov::FrustumCullIndicesScalar(const Camera::Frustum& frustum, const AABBSoA& boxes, size_t first, size_t count, std::vector<uint32_t>& outIndices) {
+    const size_t startSize = outIndices.size();
+    const PreparedFrustum prepared = PrepareFrustum(frustum, boxes);
+    for (size_t i = first; i < first + count; ++i) {
+        if (TestBox(prepared, i)) {
+            outIndices.push_back(static_cast<uint32_t>(i));
+        }
+    }
+    return outIndices.size() - startSize;
+}
@@ -0,0 +1,42 @@
+#ifndef FRUSTUMCULLING_H
+#define FRUSTUMCULLING_H
+
+#include <cstdint>
+#include <vector>
+
+#include "AABB.h"
+#include "Camera.h"
+
+namespace vov {
+    // Boxes stored as separate min/max arrays so the culling kernels can load 4 / 8 of them at once
+    struct AABBSoA {
+        std::vector<float> minX{};
+        std::vector<float> minY{};
+        std::vector<float> minZ{};
+        std::vector<float> maxX{};
+        std::vector<float> maxY{};
+        std::vector<float> maxZ{};
+
+        void Clear();
+        void Reserve(size_t count);
+        void Resize(size_t count);
+
+        void Add(const AABB& box);
+        void Set(size_t index, const AABB& box);
+        [[nodiscard]] AABB Get(size_t index) const;
+
+        [[nodiscard]] size_t Size() const { return minX.size(); }
+    };
+
+    // Appends the indices of the visible boxes in [first, first + count) to outIndices, returns how many were added
+    size_t FrustumCullIndices(const Camera::Frustum& frustum, const AABBSoA& boxes, size_t first, size_t count, std::vector<uint32_t>& outIndices);
+
+    inline size_t FrustumCullIndices(const Camera::Frustum& frustum, const AABBSoA& boxes, std::vector<uint32_t>& outIndices) {
+        return FrustumCullIndices(frustum, boxes, 0, boxes.Size(), outIndices);
+    }
+
+    // Plain one box at a time reference, see benchmarks/FrustumCullingBenchmark.cpp
+    size_t FrustumCullIndicesScalar(const Camera::Frustum& frustum, const AABBSoA& boxes, size_t first, size_t count, std::vector<uint32_t>& outIndices);
+}
+
+#endif //FRUSTUMCULLING_H
@@ -4,7 +4,9 @@
 
 #include <vector>
 
-#include "Rendering/Passes/LinePass.h"
+#include <glm/glm.hpp>
+
+#include "Core/Device.h"
 
 namespace vov {
     class LineManager final: public Singleton<LineManager> {
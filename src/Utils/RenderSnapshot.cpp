@@ -0,0 +1,83 @@
+#include "RenderSnapshot.h"
+
+#include <algorithm>
+
+#include "Core/JobSystem.h"
+#include "Scene/Mesh.h"
+#include "Scene/Scene.h"
+
+namespace {
+    // previous is null or has a matrix for every mesh, then the result is blended from it
+    void CaptureWorldMatrices(vov::Scene& scene, std::vector<glm::mat4>& worldMatrices, const std::vector<glm::mat4>* previous, float alpha) {
+        worldMatrices.resize(scene.GetMeshCount());
+        for (const auto& gameObject : scene.getGameObjects()) {
+            if (!gameObject->model) {
+                continue;
+            }
+
+            // Meshes only read their parent's cached world values, resolve those here so the jobs never write shared state
+            gameObject->transform.GetWorldMatrix();
+
+            const auto& meshes = gameObject->model->getMeshes();
+            vov::JobSystem::GetInstance().ParallelFor("Capture world matrices", meshes.size(), 256, [&] (size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    const uint32_t index = meshes[i]->GetSceneIndex();
+                    const glm::mat4& current = meshes[i]->getTransform().GetWorldMatrix();
+                    // Component wise, fine for the small rotations between two steps
+                    worldMatrices[index] = previous != nullptr ? (*previous)[index] + (current - (*previous)[index]) * alpha : current;
+                }
+            });
+        }
+    }
+}
+
+void vov::SimulationState::Capture(Scene& currentScene, const Camera& currentCamera) {
+    scene = &currentScene;
+    meshVersion = currentScene.GetMeshVersion();
+    camera = currentCamera;
+    CaptureWorldMatrices(currentScene, worldMatrices, nullptr, 1.f);
+}
+
+void vov::RenderSnapshot::Capture(Scene& currentScene, const Camera& currentCamera, const std::vector<Mesh*>& culledMeshes, const SimulationState* previous, float alpha) {
+    scene = &currentScene;
+    camera = currentCamera;
+    directionalLight = currentScene.GetDirectionalLight();
+    visibleMeshes = culledMeshes;
+
+    const SceneBVH& bvh = currentScene.GetBVH();
+
+    // Lighting cuts off at the range, a light whose sphere reaches no visible mesh can't touch a single pixel
+    std::vector<bool> visible(currentScene.GetMeshCount(), false);
+    for (const Mesh* mesh : culledMeshes) {
+        visible[mesh->GetSceneIndex()] = true;
+    }
+
+    pointLights.clear();
+    std::vector<Mesh*> lit{};
+    for (const auto& light : currentScene.getPointLights()) {
+        const PointLight::PointLightData data = light->getPointLightData();
+        lit.clear();
+        bvh.QuerySphere(data.position, data.range, lit);
+        if (std::ranges::any_of(lit, [&] (const Mesh* mesh) { return visible[mesh->GetSceneIndex()]; })) {
+            pointLights.push_back(data);
+        }
+    }
+
+    // World box around the light's ortho volume, anything outside gets clipped from the shadow map anyway
+    const glm::mat4 invLightSpace = glm::inverse(directionalLight.GetProjectionMatrix() * directionalLight.GetViewMatrix());
+    AABB lightBox{glm::vec3(FLT_MAX), glm::vec3(-FLT_MAX)};
+    for (int i = 0; i < 8; ++i) {
+        const glm::vec4 corner = invLightSpace * glm::vec4(i & 1 ? 1.f : -1.f, i & 2 ? 1.f : -1.f, i & 4 ? 1.f : 0.f, 1.f);
+        lightBox.min = glm::min(lightBox.min, glm::vec3(corner) / corner.w);
+        lightBox.max = glm::max(lightBox.max, glm::vec3(corner) / corner.w);
+    }
+    shadowCasters.clear();
+    bvh.QueryBox(lightBox, shadowCasters);
+
+    // A rebuild renumbers the meshes, the old matrices don't line up anymore
+    const bool blend = previous != nullptr && alpha < 1.f && previous->scene == &currentScene &&
+                       previous->meshVersion == currentScene.GetMeshVersion() && previous->worldMatrices.size() == currentScene.GetMeshCount();
+    CaptureWorldMatrices(currentScene, worldMatrices, blend ? &previous->worldMatrices : nullptr, alpha);
+
+    lines = LineManager::GetInstance().GetLines();
+}
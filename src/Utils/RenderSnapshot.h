@@ -0,0 +1,56 @@
+#ifndef RENDERSNAPSHOT_H
+#define RENDERSNAPSHOT_H
+
+#include <optional>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Camera.h"
+#include "FrameContext.h"
+#include "LineManager.h"
+#include "Scene/Lights/DirectionalLight.h"
+#include "Scene/Lights/PointLight.h"
+
+namespace vov {
+    class Mesh;
+    class Scene;
+
+    // What the fixed update moves, kept from right before the last step so rendering can blend towards the current state
+    struct SimulationState {
+        const Scene* scene{nullptr};        // null until the first step, nothing to blend from
+        uint32_t meshVersion{0};
+        Camera camera{glm::vec3{0.f}, glm::vec3{0.f, 1.f, 0.f}};
+        std::vector<glm::mat4> worldMatrices{};    // by Mesh::GetSceneIndex
+
+        void Capture(Scene& currentScene, const Camera& currentCamera);
+    };
+
+    // Everything the render thread reads that the simulation keeps changing, copied out once per frame.
+    // The scene itself is only used for what stays put while it is loaded, the meshes and their GPU resources.
+    struct RenderSnapshot {
+        Scene* scene{nullptr};
+        Camera camera{glm::vec3{0.f}, glm::vec3{0.f, 1.f, 0.f}};
+        DirectionalLight directionalLight{};
+        std::vector<PointLight::PointLightData> pointLights{};
+
+        std::vector<Mesh*> visibleMeshes{};
+        std::vector<Mesh*> shadowCasters{};       // inside the directional light's shadow volume
+        std::vector<glm::mat4> worldMatrices{};    // by Mesh::GetSceneIndex
+        std::vector<LineManager::Line> lines{};
+
+        DebugView debugView{DebugView::NONE};
+        float frameTime{0.f};
+        bool renderImgui{true};
+        bool capture{false};
+        bool dumpRenderGraph{false};   // captures/render_graph.dot once this frame is compiled
+        // Mouse position over the window size. The geometry pass writes mesh IDs this frame and the one under it is read back
+        std::optional<glm::vec2> pickPosition{};
+
+        // Light matrices have to be up to date, the world matrices are resolved here on the job system.
+        // With a previous state of the same meshes they are blended from it by alpha, the camera is taken as is
+        void Capture(Scene& currentScene, const Camera& currentCamera, const std::vector<Mesh*>& culledMeshes, const SimulationState* previous = nullptr, float alpha = 1.f);
+    };
+}
+
+#endif //RENDERSNAPSHOT_H
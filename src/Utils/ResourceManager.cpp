@@ -2,7 +2,9 @@
 
 #include <filesystem>
 #include <iostream>
+#include <unordered_set>
 
+#include "Core/JobSystem.h"
 #include "Utils/Timer.h"
 
 namespace vov {
@@ -21,6 +23,31 @@ namespace vov {
         return m_images[filename].get();
     }
 
+    void ResourceManager::PreloadImages(Device& deviceRef, const std::vector<ImageRequest>& requests, VkImageUsageFlags usage, VmaMemoryUsage memoryUsage) {
+        std::vector<const ImageRequest*> missing{};
+        std::unordered_set<std::string> seen{};
+        for (const ImageRequest& request : requests) {
+            if (!m_images.contains(request.filename) && seen.insert(request.filename).second) {
+                missing.push_back(&request);
+            }
+        }
+
+        std::vector<Image::FileData> files(missing.size());
+        JobSystem::GetInstance().ParallelFor("Decode images", missing.size(), 1, [&] (size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                files[i] = Image::LoadFile(missing[i]->filename);
+            }
+        });
+
+        // Uploads go through the device's single time commands, those stay on this thread
+        for (size_t i = 0; i < missing.size(); ++i) {
+            const ImageRequest& request = *missing[i];
+            std::cout << "Image not yet loaded, Loading: " << request.filename << std::endl;
+            m_images[request.filename] = std::make_unique<Image>(deviceRef, request.filename, files[i], request.format, usage, memoryUsage);
+            files[i] = {};
+        }
+    }
+
     void ResourceManager::Clear() {
         m_images.clear();
         m_dummyImage.reset();
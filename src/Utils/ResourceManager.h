@@ -2,7 +2,9 @@
 #define RESOURCEMANAGER_H
 
 #include <memory>
+#include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "Singleton.h"
 #include "Resources/Buffer.h"
@@ -10,8 +12,14 @@
 namespace vov {
     class ResourceManager final: public Singleton<ResourceManager> {
     public:
+        struct ImageRequest {
+            std::string filename;
+            VkFormat format;
+        };
 
         Image* LoadImage(Device& deviceRef, const std::string& filename, VkFormat format, VkImageUsageFlags usage, VmaMemoryUsage memoryUsage);
+        // Decodes every image that isn't loaded yet on the job system and uploads them after, LoadImage then finds them
+        void PreloadImages(Device& deviceRef, const std::vector<ImageRequest>& requests, VkImageUsageFlags usage, VmaMemoryUsage memoryUsage);
         void Clear();
         void UnloadImage(Image* image);
 
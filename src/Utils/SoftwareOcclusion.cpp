@@ -0,0 +1,276 @@
+#include "SoftwareOcclusion.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#include "Core/JobSystem.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define VOV_OCCLUSION_SSE
+    #include <immintrin.h>
+#endif
+
+namespace {
+    constexpr float MIN_CLIP_W = 1e-5f;
+}
+
+void vov::SoftwareOcclusion::Clear() {
+    m_stats = {};
+    std::ranges::fill(m_depth, 1.f);
+    std::ranges::fill(m_tileMaxDepth, 1.f);
+    m_occluderTriangles.clear();
+}
+
+void vov::SoftwareOcclusion::AddOccluder(const glm::mat4& modelViewProjection, const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices) {
+    SetupTriangles(modelViewProjection, positions, indices, m_occluderTriangles.emplace_back());
+}
+
+void vov::SoftwareOcclusion::Rasterize() {
+    // Every band owns its rows of the depth buffer, so threads never write the same pixel
+    JobSystem::GetInstance().ParallelFor("Rasterize occluders", HEIGHT / BAND_HEIGHT, 1, [&] (size_t begin, size_t end) {
+        for (size_t band = begin; band < end; ++band) {
+            RasterizeBand(static_cast<uint32_t>(band));
+        }
+    });
+
+    for (const auto& triangles : m_occluderTriangles) {
+        m_stats.occluderTriangles += static_cast<uint32_t>(triangles.size());
+    }
+
+    for (uint32_t tileY = 0; tileY < TILES_Y; ++tileY) {
+        for (uint32_t tileX = 0; tileX < TILES_X; ++tileX) {
+            float maxDepth = 0.f;
+            for (uint32_t y = tileY * TILE_SIZE; y < (tileY + 1) * TILE_SIZE; ++y) {
+                const float* row = &m_depth[y * WIDTH + tileX * TILE_SIZE];
+                for (uint32_t x = 0; x < TILE_SIZE; ++x) {
+                    maxDepth = std::max(maxDepth, row[x]);
+                }
+            }
+            m_tileMaxDepth[tileY * TILES_X + tileX] = maxDepth;
+        }
+    }
+}
+
+void vov::SoftwareOcclusion::TestBounds(const glm::mat4& viewProjection, const std::vector<AABB>& bounds, const std::vector<uint8_t>& occluders, std::vector<uint8_t>& outVisible) {
+    outVisible.assign(bounds.size(), 1);
+    JobSystem::GetInstance().ParallelFor("Test occludees", bounds.size(), 64, [&] (size_t begin, size_t end) {
+        for (size_t index = begin; index < end; ++index) {
+            if (!occluders[index]) {
+                outVisible[index] = IsVisible(viewProjection, bounds[index]) ? 1 : 0;
+            }
+        }
+    });
+
+    m_stats.tested = static_cast<uint32_t>(bounds.size() - std::ranges::count(occluders, uint8_t{1}));
+    m_stats.culled = static_cast<uint32_t>(std::ranges::count(outVisible, uint8_t{0}));
+}
+
+bool vov::SoftwareOcclusion::IsVisible(const glm::mat4& viewProjection, const AABB& worldBounds) const {
+    glm::vec2 screenMin{FLT_MAX};
+    glm::vec2 screenMax{-FLT_MAX};
+    float minDepth = FLT_MAX;
+
+    for (int corner = 0; corner < 8; ++corner) {
+        const glm::vec3 position{
+            corner & 1 ? worldBounds.max.x : worldBounds.min.x,
+            corner & 2 ? worldBounds.max.y : worldBounds.min.y,
+            corner & 4 ? worldBounds.max.z : worldBounds.min.z
+        };
+        const glm::vec4 clip = viewProjection * glm::vec4(position, 1.f);
+
+        // Crosses the near plane, the camera is (almost) inside it
+        if (clip.w < MIN_CLIP_W || clip.z < 0.f) {
+            return true;
+        }
+
+        const glm::vec3 ndc = glm::vec3(clip) / clip.w;
+        const glm::vec2 screen{(ndc.x * 0.5f + 0.5f) * WIDTH, (0.5f - ndc.y * 0.5f) * HEIGHT};
+        screenMin = glm::min(screenMin, screen);
+        screenMax = glm::max(screenMax, screen);
+        minDepth = std::min(minDepth, ndc.z);
+    }
+
+    // Every pixel the rect touches counts, not just the ones whose center is inside
+    const int minX = std::max(static_cast<int>(std::floor(screenMin.x)), 0);
+    const int minY = std::max(static_cast<int>(std::floor(screenMin.y)), 0);
+    const int maxX = std::min(static_cast<int>(std::floor(screenMax.x)), static_cast<int>(WIDTH) - 1);
+    const int maxY = std::min(static_cast<int>(std::floor(screenMax.y)), static_cast<int>(HEIGHT) - 1);
+    if (minX > maxX || minY > maxY) {
+        // Frustum culling said it's on screen, don't second guess that over rounding
+        return true;
+    }
+
+#ifdef VOV_OCCLUSION_SSE
+    const __m128 minDepth4 = _mm_set1_ps(minDepth);
+    const __m128i laneOffsets = _mm_setr_epi32(0, 1, 2, 3);
+#endif
+
+    for (int tileY = minY / static_cast<int>(TILE_SIZE); tileY <= maxY / static_cast<int>(TILE_SIZE); ++tileY) {
+        for (int tileX = minX / static_cast<int>(TILE_SIZE); tileX <= maxX / static_cast<int>(TILE_SIZE); ++tileX) {
+            // Everything in this tile is closer than the box
+            if (m_tileMaxDepth[tileY * TILES_X + tileX] < minDepth) {
+                continue;
+            }
+
+            const int x0 = std::max(minX, tileX * static_cast<int>(TILE_SIZE));
+            const int x1 = std::min(maxX, (tileX + 1) * static_cast<int>(TILE_SIZE) - 1);
+            const int y0 = std::max(minY, tileY * static_cast<int>(TILE_SIZE));
+            const int y1 = std::min(maxY, (tileY + 1) * static_cast<int>(TILE_SIZE) - 1);
+
+            for (int y = y0; y <= y1; ++y) {
+                const float* row = &m_depth[y * WIDTH];
+#ifdef VOV_OCCLUSION_SSE
+                const __m128i first = _mm_set1_epi32(x0 - 1);
+                const __m128i last = _mm_set1_epi32(x1 + 1);
+                for (int x = x0 & ~3; x <= x1; x += 4) {
+                    const __m128i lanes = _mm_add_epi32(_mm_set1_epi32(x), laneOffsets);
+                    const __m128i inRect = _mm_and_si128(_mm_cmpgt_epi32(lanes, first), _mm_cmplt_epi32(lanes, last));
+                    const __m128 farther = _mm_cmpge_ps(_mm_loadu_ps(row + x), minDepth4);
+                    if (_mm_movemask_ps(_mm_and_ps(farther, _mm_castsi128_ps(inRect))) != 0) {
+                        return true;
+                    }
+                }
+#else
+                for (int x = x0; x <= x1; ++x) {
+                    if (row[x] >= minDepth) {
+                        return true;
+                    }
+                }
+#endif
+            }
+        }
+    }
+
+    return false;
+}
+
+void vov::SoftwareOcclusion::SetupTriangles(const glm::mat4& modelViewProjection, const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices, std::vector<ScreenTriangle>& outTriangles) {
+    outTriangles.clear();
+    outTriangles.reserve(indices.size() / 3);
+
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        glm::vec3 screen[3];
+        bool clipped = false;
+
+        for (int corner = 0; corner < 3; ++corner) {
+            const glm::vec4 clip = modelViewProjection * glm::vec4(positions[indices[i + corner]], 1.f);
+            // No near plane clipping, leaving the triangle out only costs occlusion, never correctness
+            if (clip.w < MIN_CLIP_W || clip.z < 0.f) {
+                clipped = true;
+                break;
+            }
+
+            const glm::vec3 ndc = glm::vec3(clip) / clip.w;
+            screen[corner] = {(ndc.x * 0.5f + 0.5f) * WIDTH, (0.5f - ndc.y * 0.5f) * HEIGHT, ndc.z};
+        }
+        if (clipped) {
+            continue;
+        }
+
+        float area = (screen[1].x - screen[0].x) * (screen[2].y - screen[0].y) - (screen[1].y - screen[0].y) * (screen[2].x - screen[0].x);
+        // Occluders are drawn double sided, flip the winding instead of culling back faces
+        if (area < 0.f) {
+            std::swap(screen[1], screen[2]);
+            area = -area;
+        }
+        if (area < 1e-6f) {
+            continue;
+        }
+
+        ScreenTriangle triangle{};
+        // Pixel centers sit at +0.5, only pixels whose center can be inside are visited
+        triangle.minX = std::max(static_cast<int>(std::ceil(std::min({screen[0].x, screen[1].x, screen[2].x}) - 0.5f)), 0);
+        triangle.maxX = std::min(static_cast<int>(std::floor(std::max({screen[0].x, screen[1].x, screen[2].x}) - 0.5f)), static_cast<int>(WIDTH) - 1);
+        triangle.minY = std::max(static_cast<int>(std::ceil(std::min({screen[0].y, screen[1].y, screen[2].y}) - 0.5f)), 0);
+        triangle.maxY = std::min(static_cast<int>(std::floor(std::max({screen[0].y, screen[1].y, screen[2].y}) - 0.5f)), static_cast<int>(HEIGHT) - 1);
+        if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY) {
+            continue;
+        }
+
+        // Edge i is the one opposite of vertex i, so its value divided by the area is that vertex's barycentric
+        const float invArea = 1.f / area;
+        triangle.depthA = triangle.depthB = triangle.depthC = 0.f;
+        for (int edge = 0; edge < 3; ++edge) {
+            const glm::vec3& a = screen[(edge + 1) % 3];
+            const glm::vec3& b = screen[(edge + 2) % 3];
+            triangle.edgeA[edge] = a.y - b.y;
+            triangle.edgeB[edge] = b.x - a.x;
+            triangle.edgeC[edge] = a.x * b.y - a.y * b.x;
+
+            triangle.depthA += triangle.edgeA[edge] * invArea * screen[edge].z;
+            triangle.depthB += triangle.edgeB[edge] * invArea * screen[edge].z;
+            triangle.depthC += triangle.edgeC[edge] * invArea * screen[edge].z;
+        }
+
+        outTriangles.push_back(triangle);
+    }
+}
+
+void vov::SoftwareOcclusion::RasterizeBand(uint32_t band) {
+    const int bandMinY = static_cast<int>(band * BAND_HEIGHT);
+    const int bandMaxY = bandMinY + static_cast<int>(BAND_HEIGHT) - 1;
+
+    for (const auto& triangles : m_occluderTriangles) {
+        for (const ScreenTriangle& triangle : triangles) {
+            if (triangle.maxY < bandMinY || triangle.minY > bandMaxY) {
+                continue;
+            }
+            RasterizeTriangle(triangle, std::max(triangle.minY, bandMinY), std::min(triangle.maxY, bandMaxY));
+        }
+    }
+}
+
+void vov::SoftwareOcclusion::RasterizeTriangle(const ScreenTriangle& triangle, int minY, int maxY) {
+#ifdef VOV_OCCLUSION_SSE
+    const __m128 laneX = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+    const __m128 zero = _mm_setzero_ps();
+
+    const __m128 edgeA0 = _mm_set1_ps(triangle.edgeA[0]);
+    const __m128 edgeA1 = _mm_set1_ps(triangle.edgeA[1]);
+    const __m128 edgeA2 = _mm_set1_ps(triangle.edgeA[2]);
+    const __m128 depthA = _mm_set1_ps(triangle.depthA);
+
+    for (int y = minY; y <= maxY; ++y) {
+        const float pixelY = static_cast<float>(y) + 0.5f;
+        const __m128 rowEdge0 = _mm_set1_ps(triangle.edgeB[0] * pixelY + triangle.edgeC[0]);
+        const __m128 rowEdge1 = _mm_set1_ps(triangle.edgeB[1] * pixelY + triangle.edgeC[1]);
+        const __m128 rowEdge2 = _mm_set1_ps(triangle.edgeB[2] * pixelY + triangle.edgeC[2]);
+        const __m128 rowDepth = _mm_set1_ps(triangle.depthB * pixelY + triangle.depthC);
+
+        float* row = &m_depth[y * WIDTH];
+        // WIDTH is a multiple of 4, so the aligned group never runs past the row
+        for (int x = triangle.minX & ~3; x <= triangle.maxX; x += 4) {
+            const __m128 pixelX = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), laneX);
+
+            const __m128 edge0 = _mm_add_ps(_mm_mul_ps(edgeA0, pixelX), rowEdge0);
+            const __m128 edge1 = _mm_add_ps(_mm_mul_ps(edgeA1, pixelX), rowEdge1);
+            const __m128 edge2 = _mm_add_ps(_mm_mul_ps(edgeA2, pixelX), rowEdge2);
+            const __m128 inside = _mm_and_ps(_mm_cmpge_ps(edge0, zero), _mm_and_ps(_mm_cmpge_ps(edge1, zero), _mm_cmpge_ps(edge2, zero)));
+            if (_mm_movemask_ps(inside) == 0) {
+                continue;
+            }
+
+            const __m128 depth = _mm_add_ps(_mm_mul_ps(depthA, pixelX), rowDepth);
+            const __m128 current = _mm_loadu_ps(row + x);
+            const __m128 closest = _mm_min_ps(current, depth);
+            _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, closest), _mm_andnot_ps(inside, current)));
+        }
+    }
+#else
+    for (int y = minY; y <= maxY; ++y) {
+        const float pixelY = static_cast<float>(y) + 0.5f;
+        float* row = &m_depth[y * WIDTH];
+        for (int x = triangle.minX; x <= triangle.maxX; ++x) {
+            const float pixelX = static_cast<float>(x) + 0.5f;
+            bool inside = true;
+            for (int edge = 0; edge < 3; ++edge) {
+                inside &= triangle.edgeA[edge] * pixelX + triangle.edgeB[edge] * pixelY + triangle.edgeC[edge] >= 0.f;
+            }
+            if (inside) {
+                row[x] = std::min(row[x], triangle.depthA * pixelX + triangle.depthB * pixelY + triangle.depthC);
+            }
+        }
+    }
+#endif
+}
@@ -0,0 +1,100 @@
+#ifndef SOFTWAREOCCLUSION_H
+#define SOFTWAREOCCLUSION_H
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "AABB.h"
+
+namespace vov {
+    class Mesh;
+
+    // CPU occlusion culling: the biggest meshes on screen get rasterized into a small depth buffer,
+    // the bounding boxes of everything else are tested against it before any draw is recorded.
+    // Doesn't touch Vulkan at all so it can run headless.
+    class SoftwareOcclusion {
+    public:
+        static constexpr uint32_t WIDTH = 256;
+        static constexpr uint32_t HEIGHT = 128;
+
+        struct Settings {
+            uint32_t maxOccluders = 48;
+            uint32_t maxOccluderTriangles = 96 * 1024;       // over all occluders together
+            uint32_t maxTrianglesPerOccluder = 16 * 1024;    // dense meshes cost more than they hide
+            float minOccluderSize = 0.1f;                    // size / distance, about the angle it covers in radians
+        };
+
+        struct Stats {
+            uint32_t occluders{};
+            uint32_t occluderTriangles{};
+            uint32_t tested{};
+            uint32_t culled{};
+            float rasterizeMs{};
+            float testMs{};
+        };
+
+        // Meshes should already be frustum culled. Picks occluders from them, rasterizes those and removes
+        // every mesh whose box is hidden, the order of the remaining meshes is kept.
+        void Cull(const glm::mat4& viewProjection, const glm::vec3& cameraPosition, std::vector<Mesh*>& meshes);
+
+        // Building blocks of Cull, usable on their own: Clear, AddOccluder for every occluder, Rasterize, then IsVisible or TestBounds
+        void Clear();
+        // 3 indices per triangle
+        void AddOccluder(const glm::mat4& modelViewProjection, const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices);
+        void Rasterize();
+        [[nodiscard]] bool IsVisible(const glm::mat4& viewProjection, const AABB& worldBounds) const;
+        // IsVisible for every box not flagged in occluders, those stay visible untested. Fills the tested and culled stats
+        void TestBounds(const glm::mat4& viewProjection, const std::vector<AABB>& bounds, const std::vector<uint8_t>& occluders, std::vector<uint8_t>& outVisible);
+
+        [[nodiscard]] Settings& GetSettings() { return m_settings; }
+        [[nodiscard]] const Stats& GetStats() const { return m_stats; }
+        [[nodiscard]] const std::vector<float>& GetDepthBuffer() const { return m_depth; }
+
+        [[nodiscard]] bool IsEnabled() const { return m_enabled; }
+        void SetEnabled(bool enabled) { m_enabled = enabled; }
+
+    private:
+        static constexpr uint32_t TILE_SIZE = 8;
+        static constexpr uint32_t TILES_X = WIDTH / TILE_SIZE;
+        static constexpr uint32_t TILES_Y = HEIGHT / TILE_SIZE;
+        static constexpr uint32_t BAND_HEIGHT = 16;
+
+        struct Occluder {
+            Mesh* mesh;
+            glm::mat4 world;
+        };
+
+        // Screen space triangle, depth stored as a plane so the raster loop only has to add
+        struct ScreenTriangle {
+            float edgeA[3];
+            float edgeB[3];
+            float edgeC[3];
+            float depthA, depthB, depthC;
+            int minX, maxX, minY, maxY;
+        };
+
+        static void SetupTriangles(const glm::mat4& modelViewProjection, const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices, std::vector<ScreenTriangle>& outTriangles);
+        void RasterizeBand(uint32_t band);
+        void RasterizeTriangle(const ScreenTriangle& triangle, int minY, int maxY);
+        void SelectOccluders(const glm::vec3& cameraPosition, const std::vector<Mesh*>& meshes);
+
+        Settings m_settings{};
+        Stats m_stats{};
+        bool m_enabled{true};
+
+        std::vector<float> m_depth = std::vector<float>(WIDTH * HEIGHT, 1.f);
+        std::vector<float> m_tileMaxDepth = std::vector<float>(TILES_X * TILES_Y, 1.f);
+
+        std::vector<Occluder> m_occluders{};
+        std::vector<std::vector<ScreenTriangle>> m_occluderTriangles{};
+
+        // Per mesh passed to Cull
+        std::vector<AABB> m_meshBounds{};
+        std::vector<uint8_t> m_isOccluder{};
+        std::vector<uint8_t> m_visibility{};
+    };
+}
+
+#endif //SOFTWAREOCCLUSION_H
@@ -0,0 +1,108 @@
+// The part of SoftwareOcclusion that reads meshes, the rest builds without any of the Vulkan side
+#include "SoftwareOcclusion.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include "Core/JobSystem.h"
+#include "Scene/Mesh.h"
+
+namespace {
+    float MillisecondsSince(std::chrono::high_resolution_clock::time_point start) {
+        return std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    }
+}
+
+void vov::SoftwareOcclusion::Cull(const glm::mat4& viewProjection, const glm::vec3& cameraPosition, std::vector<Mesh*>& meshes) {
+    m_stats = {};
+    if (!m_enabled || meshes.empty()) {
+        return;
+    }
+
+    const auto rasterizeStart = std::chrono::high_resolution_clock::now();
+
+    Clear();
+    SelectOccluders(cameraPosition, meshes);
+
+    m_occluderTriangles.resize(m_occluders.size());
+    JobSystem::GetInstance().ParallelFor("Setup occluders", m_occluders.size(), 1, [&] (size_t begin, size_t end) {
+        for (size_t index = begin; index < end; ++index) {
+            const Occluder& occluder = m_occluders[index];
+            const MeshBVH& bvh = occluder.mesh->GetBVH();
+            SetupTriangles(viewProjection * occluder.world, bvh.GetPositions(), bvh.GetIndices(), m_occluderTriangles[index]);
+        }
+    });
+    Rasterize();
+
+    m_stats.occluders = static_cast<uint32_t>(m_occluders.size());
+    m_stats.rasterizeMs = MillisecondsSince(rasterizeStart);
+
+    const auto testStart = std::chrono::high_resolution_clock::now();
+
+    TestBounds(viewProjection, m_meshBounds, m_isOccluder, m_visibility);
+
+    size_t writeIndex = 0;
+    for (size_t i = 0; i < meshes.size(); ++i) {
+        if (m_visibility[i]) {
+            meshes[writeIndex++] = meshes[i];
+        }
+    }
+
+    m_stats.testMs = MillisecondsSince(testStart);
+
+    meshes.resize(writeIndex);
+}
+
+void vov::SoftwareOcclusion::SelectOccluders(const glm::vec3& cameraPosition, const std::vector<Mesh*>& meshes) {
+    struct Candidate {
+        uint32_t meshIndex;
+        float score;
+    };
+
+    m_occluders.clear();
+    m_meshBounds.resize(meshes.size());
+    m_isOccluder.assign(meshes.size(), 0);
+
+    // World matrices are lazily updated, so they are all fetched here before anything runs in parallel
+    std::vector<Candidate> candidates{};
+    for (uint32_t i = 0; i < meshes.size(); ++i) {
+        const glm::mat4& world = meshes[i]->getTransform().GetWorldMatrix();
+        m_meshBounds[i] = TransformAABB(meshes[i]->GetBoundingBox(), world);
+
+        const uint32_t triangleCount = meshes[i]->GetBVH().GetTriangleCount();
+        if (triangleCount == 0 || triangleCount > m_settings.maxTrianglesPerOccluder) {
+            continue;
+        }
+
+        // Volume alone would throw away walls and floors, the biggest face of the box is a better measure of what it can hide
+        const glm::vec3 extent = m_meshBounds[i].max - m_meshBounds[i].min;
+        const float size = std::sqrt(std::max({extent.x * extent.y, extent.y * extent.z, extent.x * extent.z}));
+        const glm::vec3 closest = glm::clamp(cameraPosition, m_meshBounds[i].min, m_meshBounds[i].max);
+        const float distance = std::max(glm::length(closest - cameraPosition), 0.01f);
+
+        const float score = size / distance;
+        if (score >= m_settings.minOccluderSize) {
+            candidates.push_back({i, score});
+        }
+    }
+
+    std::ranges::sort(candidates, std::ranges::greater{}, &Candidate::score);
+
+    uint32_t triangleBudget = m_settings.maxOccluderTriangles;
+    for (const Candidate& candidate : candidates) {
+        if (m_occluders.size() >= m_settings.maxOccluders) {
+            break;
+        }
+
+        Mesh* mesh = meshes[candidate.meshIndex];
+        const uint32_t triangleCount = mesh->GetBVH().GetTriangleCount();
+        if (triangleCount > triangleBudget) {
+            continue;
+        }
+
+        triangleBudget -= triangleCount;
+        m_occluders.push_back({mesh, mesh->getTransform().GetWorldMatrix()});
+        m_isOccluder[candidate.meshIndex] = 1;
+    }
+}
@@ -4,26 +4,38 @@
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 #define GLM_FORCE_ALIGNED_GENTYPES
 #include <chrono>
+#include <cstring>
 #include <glm/glm.hpp>
 
+#include <filesystem>
+#include <fstream>
 #include <functional>
 #include <iostream>
 #include <thread>
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtx/string_cast.hpp>
 
+#include <ImGuizmo.h>
+
 #include "Descriptors/DescriptorWriter.h"
 #include "GLFW/glfw3.h"
+#include "Rendering/PipelineBatch.h"
+#include "Rendering/ShaderReloader.h"
 #include "Rendering/RenderSystems/ImguiRenderSystem.h"
 #include "Rendering/RenderSystems/LineRenderSystem.h"
+#include "Resources/MaterialTable.h"
 #include "Scene/Lights/DirectionalLight.h"
 #include "Utils/BezierCurves.h"
 #include "Utils/Camera.h"
 #include "Utils/DeltaTime.h"
 #include "Utils/FrameContext.h"
 #include "Utils/LineManager.h"
+#include "Utils/Timer.h"
 
 VApp::VApp() {
+    // Meshes register their textures while loading, so this has to exist before any scene
+    vov::MaterialTable::GetInstance().Init(m_device);
+
     m_sigmaVanniScene = std::make_unique<vov::Scene>("SigmaVanniScene");
     m_sponzaScene = std::make_unique<vov::Scene>("SponzaScene");
     m_vikingRoomScene = std::make_unique<vov::Scene>("VikingRoomScene");
@@ -49,44 +61,74 @@ VApp::VApp() {
 
     m_hdrEnvironment = std::make_unique<vov::HDRI>(m_device);
     m_hdrEnvironment->LoadHDR("resources/circus_arena_4k.hdr");
+
+    // Nearly all of it is pipeline creation, compare a run without cache/pipeline_cache.bin against one with it
+    vov::Timer pipelineTimer{std::string{"Pass and pipeline creation, "} + (m_device.IsPipelineCacheWarm() ? "warm" : "cold") + " cache"};
     m_hdrEnvironment->CreateCubeMap();
     m_hdrEnvironment->CreateDiffuseIrradianceMap();
 
+    // The environment above draws with its pipelines right away, the passes only need theirs by the first frame
+    vov::PipelineBatch::GetInstance().Begin();
+
+    m_transformBuffer = std::make_unique<vov::TransformBuffer>(m_device, vov::Swapchain::MAX_FRAMES_IN_FLIGHT);
+    m_secondaryRecorder = std::make_unique<vov::SecondaryRecorder>(m_device, vov::Swapchain::MAX_FRAMES_IN_FLIGHT);
+
     m_depthPrePass = std::make_unique<vov::DepthPrePass>(
         m_device
     );
-    m_depthPrePass->Init(VK_FORMAT_D32_SFLOAT, vov::Swapchain::MAX_FRAMES_IN_FLIGHT);
+    m_depthPrePass->Init(VK_FORMAT_D32_SFLOAT, vov::Swapchain::MAX_FRAMES_IN_FLIGHT, *m_transformBuffer);
+
+    m_hiZPass = std::make_unique<vov::HiZPass>(
+        m_device, vov::Swapchain::MAX_FRAMES_IN_FLIGHT, m_renderer.getSwapchain().GetSwapChainExtent()
+    );
+    m_gpuCullPass = std::make_unique<vov::GpuCullPass>(m_device, vov::Swapchain::MAX_FRAMES_IN_FLIGHT);
+
+    m_sceneGeometry = std::make_unique<vov::SceneGeometry>(m_device);
+    m_indirectCullPass = std::make_unique<vov::IndirectCullPass>(m_device, vov::Swapchain::MAX_FRAMES_IN_FLIGHT, *m_transformBuffer);
 
     m_shadowPass = std::make_unique<vov::ShadowPass>(
         m_device,
         vov::Swapchain::MAX_FRAMES_IN_FLIGHT,
         VK_FORMAT_D32_SFLOAT,
-        m_renderer.getSwapchain().GetSwapChainExtent()
+        m_renderer.getSwapchain().GetSwapChainExtent(),
+        *m_transformBuffer
     );
 
+    m_renderTargets = std::make_unique<vov::RenderTargetPool>(m_device, m_renderer.getSwapchain().GetSwapChainExtent());
+    m_renderGraph = std::make_unique<vov::RenderGraph>(*m_renderTargets);
+
     vov::GeometryPass::CreateInfo createInfo = {
-        vov::Swapchain::MAX_FRAMES_IN_FLIGHT, m_currentScene, m_window.getExtent(), VK_FORMAT_D32_SFLOAT
+        vov::Swapchain::MAX_FRAMES_IN_FLIGHT, m_currentScene, m_renderGraph.get(), VK_FORMAT_D32_SFLOAT, m_transformBuffer.get()
     };
 
     m_geoPass = std::make_unique<vov::GeometryPass>(m_device, createInfo);
 
     //TODO: figure out format here;
-    m_lightingPass = std::make_unique<vov::LightingPass>(m_device, vov::Swapchain::MAX_FRAMES_IN_FLIGHT, VK_FORMAT_R16G16B16A16_SFLOAT, m_renderer.getSwapchain().GetSwapChainExtent(), m_hdrEnvironment.get());
+    m_lightingPass = std::make_unique<vov::LightingPass>(m_device, vov::Swapchain::MAX_FRAMES_IN_FLIGHT, VK_FORMAT_R16G16B16A16_SFLOAT, *m_renderGraph, m_hdrEnvironment.get());
 
     m_blitPass = std::make_unique<vov::BlitPass>(
-        m_device, vov::Swapchain::MAX_FRAMES_IN_FLIGHT, *m_lightingPass, m_renderer.getSwapchain()
+        m_device, vov::Swapchain::MAX_FRAMES_IN_FLIGHT, m_renderer.getSwapchain()
     );
 
     m_linePass = std::make_unique<vov::LinePass>(
-        m_device, vov::Swapchain::MAX_FRAMES_IN_FLIGHT, m_renderer.getSwapchain().GetSwapChainExtent()
+        m_device, vov::Swapchain::MAX_FRAMES_IN_FLIGHT, *m_renderGraph
     );
 
+    m_readback = std::make_unique<vov::ReadbackRing>(m_device, vov::Swapchain::MAX_FRAMES_IN_FLIGHT);
+
     m_imguiRenderSystem = std::make_unique<vov::ImguiRenderSystem>(
         m_device,
         VK_FORMAT_B8G8R8A8_SRGB, //TODO: this should really be a global
         static_cast<int>(m_window.getWidth()),
         static_cast<int>(m_window.getHeight())
     );
+    vov::PipelineBatch::GetInstance().End();
+    pipelineTimer.stop();
+
+#ifdef VOVY_SHADER_SOURCE_DIR
+    // Recompiled SPIR-V goes where the pipelines load it from, a restart keeps the edits
+    vov::ShaderReloader::GetInstance().Start(VOVY_SHADER_SOURCE_DIR, "shaders");
+#endif
 
     m_camera.setAspectRatio(m_renderer.GetAspectRatio());
 
@@ -95,14 +137,29 @@ VApp::VApp() {
     m_camera.GetShutterSpeed() = 1.f / 60.f;
 
     m_appGui = std::make_unique<AppGui>(m_imguiRenderSystem.get(), m_currentScene, &m_camera);
+
+    m_framePipeline = std::make_unique<vov::FramePipeline>([this] (vov::RenderSnapshot& snapshot) {
+        RenderFrame(snapshot);
+    });
 }
 
-VApp::~VApp() = default;
+VApp::~VApp() {
+    vov::ShaderReloader::GetInstance().Stop();
+}
 
 void VApp::run() {
+    auto& deltaTime = vov::DeltaTime::GetInstance();
     while (!m_window.ShouldClose()) {
-        vov::DeltaTime::GetInstance().Update();
-        const double currentFps = 1.0 / vov::DeltaTime::GetInstance().GetDeltaTime();
+        if (m_framePacer.IsLowLatency()) {
+            // Nothing queued up behind this frame, the input it reads is shown as soon as the GPU can get to it
+            m_framePipeline->WaitIdle();
+            m_renderer.WaitForGpu();
+            m_framePacer.FrameCompleted();
+        }
+        m_framePacer.BeginFrame();
+
+        deltaTime.Update();
+        const double currentFps = 1.0 / deltaTime.GetDeltaTime();
         m_fpsAccumulated += currentFps;
         m_fpsFrameCount++;
 
@@ -113,21 +170,39 @@ void VApp::run() {
         }
 
         m_window.PollInput();
-        m_imguiRenderSystem->beginFrame();
 
-        this->imGui();
-        if (!m_currentScene->getGameObjects().empty() && m_selectedTransform) {
-            m_imguiRenderSystem->drawGizmos(&m_camera, m_selectedTransform, "Maintransform");
+        if (m_window.isKeyPressed(GLFW_KEY_GRAVE_ACCENT)) {
+            if (m_window.isCursorLocked()) {
+                m_window.UnlockCursor();
+            } else {
+                m_window.LockCursor();
+            }
         }
 
-        glm::vec3 worldDir = m_currentScene->GetDirectionalLight().GetDirection() * -1.0f;
-        auto viewRot = glm::mat3(m_camera.GetViewMatrix());
-        glm::vec3 camRelativeDir = viewRot * worldDir;
+        if (m_window.isKeyPressed(GLFW_KEY_F1)) {
+            m_renderImgui = !m_renderImgui;
+        }
 
-        m_imguiRenderSystem->drawDirection(&m_camera, camRelativeDir, "DirectionalLight");
-        glm::vec3 updatedWorldDir = glm::transpose(viewRot) * camRelativeDir;
-        updatedWorldDir = glm::normalize(updatedWorldDir);
-        m_currentScene->GetDirectionalLight().SetDirection(updatedWorldDir * -1.0f);
+        // Simulate and cull this frame while the render thread is still recording the last one.
+        // The simulation only advances in fixed steps, it plays out the same at any frame rate
+        const uint32_t steps = deltaTime.ConsumeFixedSteps();
+        for (uint32_t step = 0; step < steps; ++step) {
+            if (step + 1 == steps) {
+                m_previousState.Capture(*m_currentScene, m_camera);
+            }
+            FixedUpdate(static_cast<float>(deltaTime.GetFixedDeltaTime()));
+        }
+        m_currentScene->UpdateBVH();
+
+        // Drawn up to a step behind, blended between the last two steps
+        const float alpha = deltaTime.GetInterpolationAlpha();
+        m_renderCamera = m_previousState.scene != nullptr ? vov::Camera::Interpolate(m_previousState.camera, m_camera, alpha) : m_camera;
+
+        m_currentScene->GetDirectionalLight().CalculateSceneBoundsMatricies(m_currentScene);
+
+        m_visibleMeshes.clear();
+        m_currentScene->GetBVH().QueryFrustum(m_renderCamera.GetFrustum(), m_visibleMeshes);
+        m_occlusion.Cull(m_renderCamera.GetProjectionMatrix() * m_renderCamera.GetViewMatrix(), m_renderCamera.GetPosition(), m_visibleMeshes);
 
         if (m_currentDebugViewMode != vov::DebugView::FULLSCREEN_SHADOW && m_RenderBoundingBoxes) {
             m_currentScene->getGameObjects()[0]->model->RenderBox();
@@ -135,105 +210,403 @@ void VApp::run() {
 
         // vov::LineManager::GetInstance().DrawWireSphere(glm::vec3(0, 10, 0), 5, 32);
 
-        m_imguiRenderSystem->endFrame();
+        vov::RenderSnapshot& snapshot = m_framePipeline->GetSnapshot();
+        snapshot.Capture(*m_currentScene, m_renderCamera, m_visibleMeshes, &m_previousState, alpha);
+        snapshot.debugView = m_currentDebugViewMode;
+        snapshot.frameTime = static_cast<float>(deltaTime.GetDeltaTime());
+        snapshot.renderImgui = m_renderImgui;
+        snapshot.capture = m_window.isKeyPressed(GLFW_KEY_F12);
+        snapshot.dumpRenderGraph = m_window.isKeyPressed(GLFW_KEY_F10);
+        snapshot.pickPosition.reset();
+        vov::LineManager::GetInstance().clear();
 
-        if (m_window.isKeyPressed(GLFW_KEY_GRAVE_ACCENT)) {
-            if (m_window.isCursorLocked()) {
-                m_window.UnlockCursor();
-            } else {
-                m_window.LockCursor();
-            }
+        // From here to Submit nothing renders, the GUI can touch the passes and ImGui's draw data stays put until the next frame
+        m_framePipeline->WaitIdle();
+        m_framePacer.RecordGpuTime(m_renderer.GetGpuTime());
+
+        // Shaders edited since the last frame, the rebuilt pipelines all go in together
+        vov::ShaderReloader::GetInstance().ApplyPending([this] { vkDeviceWaitIdle(m_device.device()); });
+
+        if (m_pendingAspectRatio) {
+            m_camera.setAspectRatio(*m_pendingAspectRatio);
+            m_renderCamera.setAspectRatio(*m_pendingAspectRatio);
+            m_pendingAspectRatio.reset();
         }
 
-        if (m_window.isKeyPressed(GLFW_KEY_F1)) {
-            m_renderImgui = !m_renderImgui;
+        ApplyGpuPick();
+        if (!m_window.isCursorLocked() && m_window.isMouseButtonPressed(GLFW_MOUSE_BUTTON_LEFT) &&
+            !ImGui::GetIO().WantCaptureMouse && !ImGuizmo::IsOver() && !ImGuizmo::IsUsing()) {
+            PickObject(snapshot);
         }
 
+        m_imguiRenderSystem->beginFrame();
 
-        m_camera.Update(static_cast<float>(vov::DeltaTime::GetInstance().GetDeltaTime()));
-        m_currentScene->GetDirectionalLight().CalculateSceneBoundsMatricies(m_currentScene);
+        this->imGui();
+        if (!m_currentScene->getGameObjects().empty() && m_selectedTransform) {
+            m_imguiRenderSystem->drawGizmos(&m_renderCamera, m_selectedTransform, "Maintransform");
+        }
 
-        if (const auto commandBuffer = m_renderer.BeginFrame()) {
-            const int frameIndex = m_renderer.GetFrameIndex();
-            vov::FrameContext frameContext{
-                frameIndex,
-                static_cast<float>(vov::DeltaTime::GetInstance().GetDeltaTime()),
-                commandBuffer,
-                m_camera,
-                *m_currentScene,
-                m_currentDebugViewMode
-            };
+        glm::vec3 worldDir = m_currentScene->GetDirectionalLight().GetDirection() * -1.0f;
+        auto viewRot = glm::mat3(m_renderCamera.GetViewMatrix());
+        glm::vec3 camRelativeDir = viewRot * worldDir;
 
-            auto& depthImage = m_renderer.GetCurrentDepthImage();
-            m_depthPrePass->Record(frameContext, depthImage);
+        m_imguiRenderSystem->drawDirection(&m_renderCamera, camRelativeDir, "DirectionalLight");
+        glm::vec3 updatedWorldDir = glm::transpose(viewRot) * camRelativeDir;
+        updatedWorldDir = glm::normalize(updatedWorldDir);
+        m_currentScene->GetDirectionalLight().SetDirection(updatedWorldDir * -1.0f);
 
-            m_shadowPass->Record(frameContext);
+        m_imguiRenderSystem->endFrame();
 
-            m_geoPass->Record(frameContext, depthImage);
+        m_renderer.SetVSync(m_framePacer.GetMode() == vov::FramePacer::Mode::PRESENT);
 
-            depthImage.TransitionImageLayout(
-                commandBuffer,
-                VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL,
-                VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
-                VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT
-            );
+        m_framePipeline->Submit();
+    }
+    m_framePipeline->WaitIdle();
+    vkDeviceWaitIdle(m_device.device());
+    m_readback->DeliverAll();
 
+    for (auto& write : m_pendingCaptureWrites) {
+        write.wait();
+    }
+}
 
-            m_linePass->Record(frameContext, commandBuffer, frameIndex, depthImage);
+void VApp::FixedUpdate(float fixedDeltaTime) {
+    m_camera.Update(fixedDeltaTime);
+}
 
-            depthImage.TransitionImageLayout(commandBuffer, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+void VApp::RenderFrame(vov::RenderSnapshot& snapshot) {
+    vov::Scene& scene = *snapshot.scene;
 
+    const bool gpuDriven = m_indirectCullPass->IsEnabled();
+    if (gpuDriven && !m_sceneGeometry->IsBuiltFor(scene)) {
+        m_sceneGeometry->Build(scene);
+    }
+
+    if (const auto commandBuffer = m_renderer.BeginFrame()) {
+        const int frameIndex = m_renderer.GetFrameIndex();
+        m_readback->BeginFrame(frameIndex);
+        m_transformBuffer->Update(frameIndex, snapshot.worldMatrices);
+        m_secondaryRecorder->BeginFrame(frameIndex);
+
+        vov::FrameContext frameContext{
+            frameIndex,
+            snapshot.frameTime,
+            commandBuffer,
+            snapshot.camera,
+            scene,
+            snapshot.visibleMeshes,
+            snapshot.shadowCasters,
+            snapshot.worldMatrices,
+            snapshot.directionalLight,
+            snapshot.pointLights,
+            snapshot.lines,
+            snapshot.debugView,
+            m_secondaryRecorder.get()
+        };
+
+        using Usage = vov::RenderGraph::Usage;
+        using PassBuilder = vov::RenderGraph::PassBuilder;
+
+        auto& depthImage = m_renderer.GetCurrentDepthImage();
+        vov::RenderGraph& graph = *m_renderGraph;
+        graph.Reset();
+
+        const auto depth = graph.ImportImage("Depth", depthImage);
+        const auto shadowMap = graph.ImportImage("Shadow Map", m_shadowPass->GetDepthImage(frameIndex));
+        const auto swapchain = graph.ImportImage("Swapchain", m_renderer.GetCurrentImage());
+
+        // Draw buffers have to exist before they can be imported, growing them is all Prepare does on the GPU side
+        const bool gpuCulled = !gpuDriven && m_gpuCullPass->IsEnabled();
+        vov::IndirectDrawList cameraList{};
+        vov::IndirectDrawList shadowList{};
+        vov::IndirectDraws geometryDraws{};
+        vov::RenderGraph::Resource cameraDraws{};
+        vov::RenderGraph::Resource shadowDraws{};
+        vov::RenderGraph::Resource drawCounts{};
+        vov::RenderGraph::Resource cullDraws{};
+
+        if (gpuDriven) {
+            m_indirectCullPass->Prepare(*m_sceneGeometry, frameIndex);
+            cameraList = m_indirectCullPass->GetDrawList(frameIndex, vov::IndirectCullPass::CAMERA_LIST);
+            shadowList = m_indirectCullPass->GetDrawList(frameIndex, vov::IndirectCullPass::SHADOW_LIST);
+            cameraDraws = graph.ImportBuffer("Camera Draws", cameraList.commands);
+            shadowDraws = graph.ImportBuffer("Shadow Draws", shadowList.commands);
+            drawCounts = graph.ImportBuffer("Draw Counts", cameraList.count);
+
+            // Geometry still draws the CPU culled list, it picks a pipeline permutation per mesh from its material flags
+            // and the indirect list is one stream for all of them, it would need a list per permutation
+            graph.AddPass("Indirect Cull", [&] (PassBuilder& pass) {
+                pass.Write(cameraDraws, Usage::COMPUTE_WRITE);
+                pass.Write(shadowDraws, Usage::COMPUTE_WRITE);
+                pass.Write(drawCounts, Usage::TRANSFER_DST);
+                pass.Write(drawCounts, Usage::COMPUTE_WRITE);
+            }, [&] (VkCommandBuffer) {
+                m_indirectCullPass->Record(frameContext, *m_sceneGeometry);
+            });
+
+            graph.AddPass("Depth Pre Pass", [&] (PassBuilder& pass) {
+                pass.Write(depth, Usage::DEPTH_ATTACHMENT);
+                pass.Read(cameraDraws, Usage::INDIRECT);
+                pass.Read(drawCounts, Usage::INDIRECT);
+            }, [&] (VkCommandBuffer) {
+                m_depthPrePass->RecordIndirect(frameContext, depthImage, *m_sceneGeometry, cameraList);
+            });
+        } else if (gpuCulled) {
+            m_gpuCullPass->Prepare(frameContext);
+            geometryDraws = m_gpuCullPass->GetFinalDraws(frameIndex);
+            cullDraws = graph.ImportBuffer("GPU Cull Draws", geometryDraws.buffer);
+
+            // Last frame's survivors first, their depth decides which of the rest are still worth drawing
+            graph.AddPass("GPU Cull Phase One", [&] (PassBuilder& pass) {
+                pass.Write(cullDraws, Usage::COMPUTE_WRITE);
+            }, [&] (VkCommandBuffer) {
+                m_gpuCullPass->RecordPhaseOne(frameContext, *m_hiZPass);
+            });
+
+            graph.AddPass("Depth Pre Pass", [&] (PassBuilder& pass) {
+                pass.Write(depth, Usage::DEPTH_ATTACHMENT);
+                pass.Read(cullDraws, Usage::INDIRECT);
+            }, [&] (VkCommandBuffer) {
+                m_depthPrePass->Record(frameContext, depthImage, m_gpuCullPass->GetPhaseOneDraws(frameIndex));
+            });
+
+            // The pyramid and the cull history stay outside the graph, the next frame's phase one reads them
+            graph.AddPass("HiZ Build", [&] (PassBuilder& pass) {
+                pass.Read(depth, Usage::COMPUTE_SAMPLED);
+                pass.SideEffect();
+            }, [&] (VkCommandBuffer) {
+                m_hiZPass->Record(frameContext, depthImage);
+            });
+
+            graph.AddPass("GPU Cull Phase Two", [&] (PassBuilder& pass) {
+                pass.Write(cullDraws, Usage::COMPUTE_WRITE);
+                pass.SideEffect();
+            }, [&] (VkCommandBuffer) {
+                m_gpuCullPass->RecordPhaseTwo(frameContext, *m_hiZPass);
+            });
+
+            graph.AddPass("Depth Pre Pass Phase Two", [&] (PassBuilder& pass) {
+                pass.Write(depth, Usage::DEPTH_ATTACHMENT);
+                pass.Read(cullDraws, Usage::INDIRECT);
+            }, [&] (VkCommandBuffer) {
+                m_depthPrePass->Record(frameContext, depthImage, m_gpuCullPass->GetPhaseTwoDraws(frameIndex), false);
+            });
+        } else {
+            graph.AddPass("Depth Pre Pass", [&] (PassBuilder& pass) {
+                pass.Write(depth, Usage::DEPTH_ATTACHMENT);
+            }, [&] (VkCommandBuffer) {
+                m_depthPrePass->Record(frameContext, depthImage);
+            });
+        }
+
+        graph.AddPass("Shadow", [&] (PassBuilder& pass) {
+            pass.Write(shadowMap, Usage::DEPTH_ATTACHMENT);
+            if (gpuDriven) {
+                pass.Read(shadowDraws, Usage::INDIRECT);
+                pass.Read(drawCounts, Usage::INDIRECT);
+            }
+        }, [&] (VkCommandBuffer) {
+            if (gpuDriven) {
+                m_shadowPass->RecordIndirect(frameContext, *m_sceneGeometry, shadowList);
+            } else {
+                m_shadowPass->Record(frameContext);
+            }
+        });
+
+        m_geoPass->SetSelectionEnabled(snapshot.pickPosition.has_value());
+        graph.AddPass("Geometry", [&] (PassBuilder& pass) {
+            m_geoPass->Declare(pass);
+            pass.Write(depth, Usage::DEPTH_ATTACHMENT);
+            if (gpuCulled) {
+                pass.Read(cullDraws, Usage::INDIRECT);
+            }
+        }, [&] (VkCommandBuffer recordBuffer) {
+            m_geoPass->Record(frameContext, depthImage, geometryDraws, m_depthPrePass->GetDrawnMask());
+
+            if (snapshot.pickPosition) {
+                const VkExtent2D extent = m_geoPass->GetAlbedo().GetExtent();
+                const glm::ivec2 pixel = *snapshot.pickPosition * glm::vec2{extent.width, extent.height};
+                m_geoPass->ReadSelectionPixel(*m_readback, recordBuffer, frameIndex, pixel, [this] (const vov::ReadbackRing::Result& result) {
+                    uint32_t id;
+                    std::memcpy(&id, result.data, sizeof(id));
+                    m_gpuPickId = id;
+                });
+            }
+        });
+
+        // Nothing reads the lines on frames without any, the pass and its target are dropped
+        const bool hasLines = !snapshot.lines.empty();
+        vov::RenderGraph::Resource lines{};
+        graph.AddPass("Lines", [&] (PassBuilder& pass) {
+            lines = m_linePass->Declare(pass);
+            pass.Read(depth, Usage::DEPTH_READ);
+        }, [&] (VkCommandBuffer recordBuffer) {
+            m_linePass->Record(frameContext, recordBuffer, frameIndex, depthImage);
+        });
+
+        vov::RenderGraph::Resource lighting{};
+        graph.AddPass("Lighting", [&] (PassBuilder& pass) {
+            lighting = m_lightingPass->Declare(pass);
+            m_geoPass->DeclareSampling(pass);
+            pass.Read(depth, Usage::FRAGMENT_SAMPLED);
+            pass.Read(shadowMap, Usage::FRAGMENT_SAMPLED);
+        }, [&] (VkCommandBuffer recordBuffer) {
             m_lightingPass->UpdateDescriptors(
                 frameIndex,
-                m_geoPass->GetAlbedo(frameIndex),
-                m_geoPass->GetNormal(frameIndex),
-                m_geoPass->GetSpecualar(frameIndex),
-                m_geoPass->GetWorldPos(frameIndex),
+                m_geoPass->GetAlbedo(),
+                m_geoPass->GetNormal(),
+                m_geoPass->GetSpecualar(),
                 depthImage,
                 m_shadowPass->GetDepthImage(frameIndex)
             );
 
-            m_lightingPass->Record(frameContext, commandBuffer, frameIndex, *m_geoPass, *m_hdrEnvironment, *m_shadowPass, *m_currentScene);
-
-            m_blitPass->UpdateDescriptor(frameIndex, m_lightingPass->GetImage(frameIndex), m_linePass->GetImage(frameIndex));
+            m_lightingPass->Record(frameContext, recordBuffer, frameIndex, *m_geoPass, *m_hdrEnvironment, *m_shadowPass, scene);
+        });
 
-            depthImage.TransitionImageLayout(commandBuffer, VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL);
-
-            //Swapchain render pass
-            m_renderer.beginSwapChainRenderPass(commandBuffer); {
-                m_blitPass->Record(frameContext, commandBuffer, frameIndex, m_renderer.getSwapchain());
-                if (m_renderImgui) {
-                    m_imguiRenderSystem->renderImgui(commandBuffer);
+        //Swapchain render pass
+        graph.AddPass("Composite", [&] (PassBuilder& pass) {
+            pass.Read(lighting, Usage::FRAGMENT_SAMPLED);
+            if (hasLines) {
+                pass.Read(lines, Usage::FRAGMENT_SAMPLED);
+            }
+            pass.Write(swapchain, Usage::COLOR_ATTACHMENT);
+            pass.Write(depth, Usage::DEPTH_ATTACHMENT);
+        }, [&] (VkCommandBuffer recordBuffer) {
+            m_blitPass->UpdateDescriptor(frameIndex, m_lightingPass->GetImage(), hasLines ? &m_linePass->GetImage() : nullptr);
+
+            m_renderer.beginSwapChainRenderPass(recordBuffer); {
+                m_blitPass->Record(frameContext, recordBuffer, frameIndex, m_renderer.getSwapchain());
+                if (snapshot.renderImgui) {
+                    m_imguiRenderSystem->renderImgui(recordBuffer);
                 }
             }
-            m_renderer.endSwapChainRenderPass(commandBuffer);
-
-            m_renderer.endFrame();
+            m_renderer.endSwapChainRenderPass(recordBuffer);
+        });
+
+        if (snapshot.capture && m_renderer.getSwapchain().CanCapture()) {
+            graph.AddPass("Capture", [&] (PassBuilder& pass) {
+                pass.Read(swapchain, Usage::TRANSFER_SRC);
+                pass.SideEffect();
+            }, [&] (VkCommandBuffer recordBuffer) {
+                CaptureFrame(recordBuffer, frameIndex);
+            });
         }
 
-        vov::LineManager::GetInstance().clear();
-        // FPS limiter
-        const auto sleepTime = vov::DeltaTime::GetInstance().SleepDuration();
-        if (sleepTime > std::chrono::nanoseconds(0)) {
-            std::this_thread::sleep_for(sleepTime);
+        graph.Export(swapchain, Usage::PRESENT);
+        graph.Compile();
+        graph.Execute(commandBuffer);
+
+        if (snapshot.dumpRenderGraph) {
+            DumpRenderGraph();
         }
+
+        m_readback->EndFrame(commandBuffer, frameIndex);
+        m_renderer.endFrame();
     }
-    vkDeviceWaitIdle(m_device.device());
 }
 
 void VApp::imGui() {
-    m_appGui->Render(m_avgFps, WIDTH, HEIGHT, m_selectedTransform, m_currentDebugViewMode,m_scenes);
+    const AppGui::QueueStats queueStats = {
+        {"Depth pre pass", m_depthPrePass->GetQueueStats()},
+        {"Shadow", m_shadowPass->GetQueueStats()},
+        {"Geometry", m_geoPass->GetQueueStats()}
+    };
+    m_appGui->Render(m_avgFps, WIDTH, HEIGHT, m_selectedTransform, m_gpuPicking, m_currentDebugViewMode,m_scenes, m_occlusion, *m_gpuCullPass, *m_indirectCullPass, queueStats, *m_depthPrePass, *m_secondaryRecorder, *m_framePipeline, m_framePacer);
 }
 
 void VApp::ResizeScreen(const VkExtent2D newSize) {
+    m_renderTargets->Resize(newSize);
     m_depthPrePass->Resize(newSize);
+    m_hiZPass->Resize(newSize);
     m_shadowPass->Resize(newSize);
-    m_geoPass->Resize(newSize);
-    m_lightingPass->Resize(newSize);
-    m_blitPass->Resize(newSize, *m_lightingPass);
-    m_linePass->Resize(newSize);
 
-    m_camera.setAspectRatio(static_cast<float>(newSize.width) / static_cast<float>(newSize.height));
+    m_pendingAspectRatio = static_cast<float>(newSize.width) / static_cast<float>(newSize.height);
+}
+
+void VApp::PickObject(vov::RenderSnapshot& snapshot) {
+    int width, height;
+    glfwGetWindowSize(vov::Window::gWindow, &width, &height);
+    if (width == 0 || height == 0) {
+        return;
+    }
+
+    // Lands a couple of frames later, once the frame that wrote the IDs has finished on the GPU
+    if (m_gpuPicking) {
+        snapshot.pickPosition = m_window.getMousePosition() / glm::vec2{static_cast<float>(width), static_cast<float>(height)};
+        m_gpuPickScene = m_currentScene;
+        m_gpuPickMeshVersion = m_currentScene->GetMeshVersion();
+        return;
+    }
+
+    glm::vec3 origin;
+    glm::vec3 direction;
+    m_renderCamera.ScreenPointToRay(m_window.getMousePosition(), {static_cast<float>(width), static_cast<float>(height)}, origin, direction);
+
+    vov::SceneBVH::RayHit hit{};
+    const vov::SceneBVH& bvh = m_currentScene->GetBVH();
+    if (bvh.Raycast(origin, direction, hit)) {
+        m_selectedTransform = &hit.mesh->getTransform();
+    } else if (bvh.RaycastBounds(origin, direction, hit) && hit.mesh->GetBVH().IsEmpty()) {
+        // Meshes without triangles to trace, non indexed ones, can only be picked by their bounds
+        m_selectedTransform = &hit.mesh->getTransform();
+    } else {
+        m_selectedTransform = nullptr;
+    }
+}
+
+void VApp::ApplyGpuPick() {
+    if (!m_gpuPickId) {
+        return;
+    }
+
+    const uint32_t id = *m_gpuPickId;
+    m_gpuPickId.reset();
+    if (m_gpuPickScene != m_currentScene || m_gpuPickMeshVersion != m_currentScene->GetMeshVersion()) {
+        return;
+    }
+
+    // 0 is the clear value, nothing was drawn there
+    if (id == 0 || id > m_currentScene->GetMeshCount()) {
+        m_selectedTransform = nullptr;
+    } else {
+        m_selectedTransform = &m_currentScene->GetMesh(id - 1)->getTransform();
+    }
+}
+
+void VApp::CaptureFrame(VkCommandBuffer commandBuffer, uint32_t frameIndex) {
+    auto& image = m_renderer.GetCurrentImage();
+
+    const uint32_t captureIndex = m_captureCount++;
+    m_readback->ReadImage(commandBuffer, frameIndex, image, {0, 0}, image.GetExtent(), [this, captureIndex] (const vov::ReadbackRing::Result& result) {
+        const bool isBgr = result.format == VK_FORMAT_B8G8R8A8_SRGB || result.format == VK_FORMAT_B8G8R8A8_UNORM;
+
+        // Only the copy happens here, the ring buffer gets reused right after the callback
+        std::vector<uint8_t> pixels(static_cast<const uint8_t*>(result.data), static_cast<const uint8_t*>(result.data) + result.size);
+
+        std::erase_if(m_pendingCaptureWrites, [] (const std::future<void>& write) {
+            return write.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+        });
+
+        m_pendingCaptureWrites.push_back(std::async(std::launch::async, [pixels = std::move(pixels), extent = result.extent, isBgr, captureIndex] {
+            std::filesystem::create_directories("captures");
+            std::ofstream file("captures/frame_" + std::to_string(captureIndex) + ".ppm", std::ios::binary);
+            file << "P6\n" << extent.width << " " << extent.height << "\n255\n";
+
+            std::vector<uint8_t> rgb(static_cast<size_t>(extent.width) * extent.height * 3);
+            for (size_t i = 0; i < static_cast<size_t>(extent.width) * extent.height; ++i) {
+                rgb[i * 3 + 0] = pixels[i * 4 + (isBgr ? 2 : 0)];
+                rgb[i * 3 + 1] = pixels[i * 4 + 1];
+                rgb[i * 3 + 2] = pixels[i * 4 + (isBgr ? 0 : 2)];
+            }
+            file.write(reinterpret_cast<const char*>(rgb.data()), static_cast<std::streamsize>(rgb.size()));
+        }));
+    });
+}
+
+void VApp::DumpRenderGraph() const {
+    std::filesystem::create_directories("captures");
+    std::ofstream file("captures/render_graph.dot");
+    file << m_renderGraph->ToGraphviz();
 }
 
 void VApp::loadGameObjects() {
@@ -1,24 +1,38 @@
 #ifndef VAPP_H
 #define VAPP_H
 
+#include <future>
 #include <memory>
+#include <optional>
 
 #include "Core/Device.h"
+#include "Core/FramePacer.h"
+#include "Core/FramePipeline.h"
 #include "Core/Window.h"
 #include "Descriptors/DescriptorPool.h"
 #include "Rendering/Pipeline.h"
+#include "Rendering/RenderGraph.h"
 #include "Rendering/Renderer.h"
+#include "Rendering/SecondaryRecorder.h"
 #include "Rendering/Passes/BlitPass.h"
 #include "Rendering/Passes/DepthPrePass.h"
 #include "Rendering/Passes/GeometryPass.h"
+#include "Rendering/Passes/GpuCullPass.h"
+#include "Rendering/Passes/HiZPass.h"
+#include "Rendering/Passes/IndirectCullPass.h"
 #include "Rendering/Passes/LightingPass.h"
 #include "Rendering/Passes/LinePass.h"
 #include "Rendering/Passes/ShadowPass.h"
 #include "Rendering/RenderSystems/ImguiRenderSystem.h"
 #include "Resources/HDRI.h"
+#include "Resources/ReadbackRing.h"
+#include "Resources/RenderTargetPool.h"
+#include "Resources/SceneGeometry.h"
+#include "Resources/TransformBuffer.h"
 #include "Scene/GameObject.h"
 #include "Scene/Scene.h"
 #include "Utils/AppGui.h"
+#include "Utils/SoftwareOcclusion.h"
 
 class VApp {
 public:
@@ -40,6 +54,16 @@ public:
 
 private:
     void loadGameObjects();
+    // Raycasts the BVH right away, or with GPU picking asks the next frame for the mesh ID under the cursor
+    void PickObject(vov::RenderSnapshot& snapshot);
+    // Idle window only, selects what the last GPU pick read back
+    void ApplyGpuPick();
+    // Everything that moves over time, always called with the fixed delta time
+    void FixedUpdate(float fixedDeltaTime);
+    // Render thread only, everything it reads of the simulation comes from the snapshot
+    void RenderFrame(vov::RenderSnapshot& snapshot);
+    void CaptureFrame(VkCommandBuffer commandBuffer, uint32_t frameIndex);
+    void DumpRenderGraph() const;
 
     double m_fpsAccumulated = 0.0;
     int m_fpsFrameCount = 0;
@@ -49,7 +73,15 @@ private:
     vov::Device m_device{m_window};
     vov::Renderer m_renderer{m_window, m_device};
 
+    vov::FramePacer m_framePacer{};
+
     vov::Camera m_camera{{-2.0f, 1.0f, 0}, {0.0f, 1.0f, 0.0f}};
+    // Resizes happen on the render thread, the camera only picks them up while it is idle
+    std::optional<float> m_pendingAspectRatio{};
+    // Right before the last fixed step, rendering blends from it towards the current state
+    vov::SimulationState m_previousState{};
+    // What this frame is drawn with, up to a step behind m_camera. Picking and gizmos have to match what is on screen
+    vov::Camera m_renderCamera{m_camera};
 
     std::unique_ptr<vov::Scene> m_sponzaScene{};
     std::unique_ptr<vov::Scene> m_sigmaVanniScene{};
@@ -63,6 +95,11 @@ private:
     std::vector<vov::Scene*> m_scenes{};
 
     vov::Transform* m_selectedTransform = nullptr;
+    bool m_gpuPicking{false};
+    // Written by the readback on the render thread, only read in the idle window. Dropped if the scene changed since
+    std::optional<uint32_t> m_gpuPickId{};
+    const vov::Scene* m_gpuPickScene{nullptr};
+    uint32_t m_gpuPickMeshVersion{0};
     // vov::Transform* m_bezierFollowerTransform = nullptr;
     // float m_bezierProgress = 0.0f;
     // float m_bezierSpeed = 0.5f; // Speed at which the transform moves along the curve
@@ -70,9 +107,21 @@ private:
 
     vov::Scene* m_currentScene{nullptr};
 
+    std::vector<vov::Mesh*> m_visibleMeshes{};
+    vov::SoftwareOcclusion m_occlusion{};
+
     std::unique_ptr<vov::ImguiRenderSystem> m_imguiRenderSystem{};
 
+    std::unique_ptr<vov::TransformBuffer> m_transformBuffer{};
+    std::unique_ptr<vov::SecondaryRecorder> m_secondaryRecorder{};
+    std::unique_ptr<vov::RenderTargetPool> m_renderTargets{};
+    std::unique_ptr<vov::RenderGraph> m_renderGraph{};
+
     std::unique_ptr<vov::DepthPrePass> m_depthPrePass{};
+    std::unique_ptr<vov::HiZPass> m_hiZPass{};
+    std::unique_ptr<vov::GpuCullPass> m_gpuCullPass{};
+    std::unique_ptr<vov::SceneGeometry> m_sceneGeometry{};
+    std::unique_ptr<vov::IndirectCullPass> m_indirectCullPass{};
     std::unique_ptr<vov::ShadowPass> m_shadowPass{};
     std::unique_ptr<vov::GeometryPass> m_geoPass{};
     std::unique_ptr<vov::LightingPass> m_lightingPass{};
@@ -80,12 +129,19 @@ private:
 
     std::unique_ptr<vov::LinePass> m_linePass{};
 
+    std::unique_ptr<vov::ReadbackRing> m_readback{};
+    std::vector<std::future<void>> m_pendingCaptureWrites{};
+    uint32_t m_captureCount{0};
+
     vov::DebugView m_currentDebugViewMode{vov::DebugView::NONE};
     bool m_showLineTools{false};
     bool m_renderImgui{ true };
     bool m_RenderBoundingBoxes{ false };
 
     std::unique_ptr<AppGui> m_appGui{};
+
+    // Last so its thread is joined before anything it renders with goes away
+    std::unique_ptr<vov::FramePipeline> m_framePipeline{};
 };
 
 #endif //VAPP_H
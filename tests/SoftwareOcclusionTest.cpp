@@ -0,0 +1,62 @@
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "Utils/SoftwareOcclusion.h"
+
+namespace {
+    int g_failures = 0;
+
+    void Check(bool condition, const char* what) {
+        if (!condition) {
+            std::cerr << "FAILED: " << what << "\n";
+            ++g_failures;
+        }
+    }
+
+    vov::AABB Box(const glm::vec3& center, float halfSize) {
+        return {center - glm::vec3{halfSize}, center + glm::vec3{halfSize}};
+    }
+}
+
+// A 4x4 quad at z = 0 seen from z = 5, aspect matches the 256x128 depth buffer
+int main() {
+    const glm::mat4 view = glm::lookAt(glm::vec3{0.f, 0.f, 5.f}, glm::vec3{0.f}, glm::vec3{0.f, 1.f, 0.f});
+    const glm::mat4 proj = glm::perspectiveRH_ZO(glm::radians(90.f), 2.f, 0.1f, 100.f);
+    const glm::mat4 viewProjection = proj * view;
+
+    const std::vector<glm::vec3> quad = {{-2.f, -2.f, 0.f}, {2.f, -2.f, 0.f}, {2.f, 2.f, 0.f}, {-2.f, 2.f, 0.f}};
+    const std::vector<uint32_t> indices = {0, 1, 2, 0, 2, 3};
+
+    vov::SoftwareOcclusion occlusion{};
+    occlusion.Clear();
+    occlusion.AddOccluder(viewProjection, quad, indices);
+    occlusion.Rasterize();
+
+    const vov::AABB behind = Box({0.f, 0.f, -5.f}, 0.5f);
+    const vov::AABB beside = Box({6.f, 0.f, 0.f}, 0.5f);
+    const vov::AABB inFront = Box({0.f, 0.f, 2.f}, 0.5f);
+    const vov::AABB occluder = {{-2.f, -2.f, 0.f}, {2.f, 2.f, 0.f}};
+
+    Check(occlusion.GetStats().occluderTriangles == 2, "both quad triangles rasterized");
+    Check(!occlusion.IsVisible(viewProjection, behind), "box behind the quad is hidden");
+    Check(occlusion.IsVisible(viewProjection, beside), "box beside the quad is visible");
+    Check(occlusion.IsVisible(viewProjection, inFront), "box in front of the quad is visible");
+
+    std::vector<uint8_t> visible{};
+    occlusion.TestBounds(viewProjection, {behind, beside, inFront, occluder}, {0, 0, 0, 1}, visible);
+    Check(visible == std::vector<uint8_t>{0, 1, 1, 1}, "TestBounds keeps all but the box behind");
+    Check(occlusion.GetStats().tested == 3, "occluders are not counted as tested");
+    Check(occlusion.GetStats().culled == 1, "one box culled");
+
+    occlusion.Clear();
+    occlusion.Rasterize();
+    Check(occlusion.IsVisible(viewProjection, behind), "nothing hides the box once cleared");
+
+    if (g_failures == 0) {
+        std::cout << "SoftwareOcclusionTest passed\n";
+    }
+    return g_failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}